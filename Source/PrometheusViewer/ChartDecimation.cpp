@@ -0,0 +1,93 @@
+#include "ChartDecimation.h"
+#include "ChartSeriesBuffer.h"
+
+void FChartDecimation::MinMax(const FChartSeriesBuffer& Series, int32 StartIndex, int32 EndIndex, double BaseTime, int32 NumBuckets, TArray<FVector2D>& OutPoints)
+{
+	OutPoints.Reset();
+
+	StartIndex = FMath::Max(StartIndex, 0);
+	EndIndex = FMath::Min(EndIndex, Series.Num());
+	const int32 Num = EndIndex - StartIndex;
+	if (Num <= 0)
+	{
+		return;
+	}
+
+	const double FirstTime = Series.GetTime(StartIndex);
+	const double TimeSpan = Series.GetTime(EndIndex - 1) - FirstTime;
+
+	if (NumBuckets <= 0 || Num <= NumBuckets * 2 || TimeSpan <= 0.0)
+	{
+		OutPoints.Reserve(Num);
+		for (int32 i = StartIndex; i < EndIndex; ++i)
+		{
+			OutPoints.Emplace(Series.GetTime(i) - BaseTime, Series.GetValue(i));
+		}
+		return;
+	}
+
+	OutPoints.Reserve(NumBuckets * 2 + 2);
+
+	auto Emit = [&Series, &OutPoints, BaseTime](int32 Index)
+	{
+		OutPoints.Emplace(Series.GetTime(Index) - BaseTime, Series.GetValue(Index));
+	};
+
+	const double BucketsPerSecond = NumBuckets / TimeSpan;
+	int32 LastEmitted = StartIndex;
+	Emit(StartIndex);
+
+	int32 i = StartIndex + 1;
+	while (i < EndIndex)
+	{
+		const int32 Bucket = FMath::Min(static_cast<int32>((Series.GetTime(i) - FirstTime) * BucketsPerSecond), NumBuckets - 1);
+
+		int32 MinIndex = i;
+		int32 MaxIndex = i;
+		float MinValue = Series.GetValue(i);
+		float MaxValue = MinValue;
+
+		int32 j = i + 1;
+		for (; j < EndIndex; ++j)
+		{
+			const int32 NextBucket = FMath::Min(static_cast<int32>((Series.GetTime(j) - FirstTime) * BucketsPerSecond), NumBuckets - 1);
+			if (NextBucket != Bucket)
+			{
+				break;
+			}
+
+			const float Value = Series.GetValue(j);
+			if (Value < MinValue)
+			{
+				MinValue = Value;
+				MinIndex = j;
+			}
+			if (Value > MaxValue)
+			{
+				MaxValue = Value;
+				MaxIndex = j;
+			}
+		}
+
+		// 依時間順序輸出，避免線條來回折返
+		const int32 FirstIndex = FMath::Min(MinIndex, MaxIndex);
+		const int32 SecondIndex = FMath::Max(MinIndex, MaxIndex);
+		if (FirstIndex > LastEmitted)
+		{
+			Emit(FirstIndex);
+			LastEmitted = FirstIndex;
+		}
+		if (SecondIndex > LastEmitted)
+		{
+			Emit(SecondIndex);
+			LastEmitted = SecondIndex;
+		}
+
+		i = j;
+	}
+
+	if (LastEmitted != EndIndex - 1)
+	{
+		Emit(EndIndex - 1);
+	}
+}
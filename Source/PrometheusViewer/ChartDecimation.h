@@ -0,0 +1,18 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FChartSeriesBuffer;
+
+/**
+ * 繪圖前的降採樣。依水平像素把 series 切成 bucket，每個 bucket 只留最小值與最大值
+ * (依時間順序)，每像素約 2 個點，尖峰不會被抹掉。
+ */
+struct PROMETHEUSVIEWER_API FChartDecimation
+{
+	/**
+	 * 輸出 [StartIndex, EndIndex) 的 (相對於 BaseTime 的時間, 值)。點數不超過 NumBuckets * 2 時原樣輸出。
+	 * 第一個與最後一個點一定保留，線條的兩端不會內縮。
+	 */
+	static void MinMax(const FChartSeriesBuffer& Series, int32 StartIndex, int32 EndIndex, double BaseTime, int32 NumBuckets, TArray<FVector2D>& OutPoints);
+};
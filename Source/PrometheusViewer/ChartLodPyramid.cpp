@@ -0,0 +1,164 @@
+#include "ChartLodPyramid.h"
+#include "Algo/BinarySearch.h"
+
+namespace ChartLodPyramid
+{
+	// 負的時間也要往下取整，bucket 邊界才會一致
+	static int64 FloorDivide(int64 Value, int64 Divisor)
+	{
+		const int64 Quotient = Value / Divisor;
+		return (Value % Divisor != 0 && (Value < 0) != (Divisor < 0)) ? Quotient - 1 : Quotient;
+	}
+
+	static void ResetBucket(FChartLodBucket& Bucket, float Value, uint32 OffsetMs, uint8 SourceLevel)
+	{
+		Bucket.Min = Value;
+		Bucket.Max = Value;
+		Bucket.Mean = Value;
+		Bucket.Count = 1;
+		Bucket.MinOffsetMs = OffsetMs;
+		Bucket.MaxOffsetMs = OffsetMs;
+		Bucket.SourceLevel = SourceLevel;
+	}
+}
+
+void FChartLodPyramid::SetBaseStep(int64 InBaseStepMs)
+{
+	InBaseStepMs = FMath::Max<int64>(InBaseStepMs, 1);
+	if (InBaseStepMs != BaseStepMs)
+	{
+		BaseStepMs = InBaseStepMs;
+		Reset();
+	}
+}
+
+int64 FChartLodPyramid::GetBucketWidthMs(int64 BaseStepMs, int32 Level)
+{
+	int64 Width = FMath::Max<int64>(BaseStepMs, 1);
+	for (int32 i = 0; i < Level; ++i)
+	{
+		Width *= LevelFactor;
+	}
+	return Width;
+}
+
+int32 FChartLodPyramid::ChooseLevel(int64 BaseStepMs, int64 MinBucketMs)
+{
+	for (int32 Level = 0; Level < NumLevels; ++Level)
+	{
+		if (GetBucketWidthMs(BaseStepMs, Level) >= MinBucketMs)
+		{
+			return Level;
+		}
+	}
+	return NumLevels - 1;
+}
+
+void FChartLodPyramid::Add(int64 TimeMs, float Value, int32 SourceLevel)
+{
+	SourceLevel = FMath::Clamp(SourceLevel, 0, NumLevels - 1);
+	for (int32 Level = FMath::Max(SourceLevel, 1); Level < NumLevels; ++Level)
+	{
+		AddToLevel(Level, TimeMs, Value, static_cast<uint8>(SourceLevel));
+	}
+}
+
+void FChartLodPyramid::AddToLevel(int32 Level, int64 TimeMs, float Value, uint8 SourceLevel)
+{
+	using namespace ChartLodPyramid;
+
+	const int64 Width = GetBucketWidthMs(Level);
+	const int64 Index = FloorDivide(TimeMs, Width);
+	const uint32 OffsetMs = static_cast<uint32>(TimeMs - Index * Width);
+
+	TArray<FChartLodBucket>& Buckets = Levels[Level - 1];
+
+	// 即時資料一定落在最後一個 bucket 或之後，只有補抓的歷史需要二分搜尋
+	int32 Position = Buckets.Num();
+	if (Buckets.Num() > 0 && Buckets.Last().Index >= Index)
+	{
+		Position = Buckets.Last().Index == Index ? Buckets.Num() - 1 : Algo::LowerBoundBy(Buckets, Index, &FChartLodBucket::Index);
+	}
+
+	if (!Buckets.IsValidIndex(Position) || Buckets[Position].Index != Index)
+	{
+		FChartLodBucket NewBucket;
+		NewBucket.Index = Index;
+		ResetBucket(NewBucket, Value, OffsetMs, SourceLevel);
+		Buckets.Insert(NewBucket, Position);
+		return;
+	}
+
+	FChartLodBucket& Bucket = Buckets[Position];
+	if (SourceLevel > Bucket.SourceLevel)
+	{
+		// 已經有更細的資料
+		return;
+	}
+	if (SourceLevel < Bucket.SourceLevel)
+	{
+		ResetBucket(Bucket, Value, OffsetMs, SourceLevel);
+		return;
+	}
+
+	++Bucket.Count;
+	Bucket.Mean += (Value - Bucket.Mean) / Bucket.Count;
+	if (Value < Bucket.Min)
+	{
+		Bucket.Min = Value;
+		Bucket.MinOffsetMs = OffsetMs;
+	}
+	if (Value > Bucket.Max)
+	{
+		Bucket.Max = Value;
+		Bucket.MaxOffsetMs = OffsetMs;
+	}
+}
+
+void FChartLodPyramid::ForEachBucket(int32 Level, int64 StartMs, int64 EndMs, TFunctionRef<void(const FChartLodBucket& Bucket)> Visitor) const
+{
+	using namespace ChartLodPyramid;
+
+	const TArray<FChartLodBucket>& Buckets = GetLevel(Level);
+	const int64 Width = GetBucketWidthMs(Level);
+	const int64 LastIndex = FloorDivide(EndMs, Width);
+
+	for (int32 i = Algo::LowerBoundBy(Buckets, FloorDivide(StartMs, Width), &FChartLodBucket::Index); i < Buckets.Num() && Buckets[i].Index <= LastIndex; ++i)
+	{
+		Visitor(Buckets[i]);
+	}
+}
+
+void FChartLodPyramid::EvictBefore(int64 CutoffMs)
+{
+	for (int32 Level = 1; Level < NumLevels; ++Level)
+	{
+		TArray<FChartLodBucket>& Buckets = Levels[Level - 1];
+		const int64 Width = GetBucketWidthMs(Level);
+
+		int32 NumExpired = 0;
+		while (NumExpired < Buckets.Num() && (Buckets[NumExpired].Index + 1) * Width <= CutoffMs)
+		{
+			++NumExpired;
+		}
+		Buckets.RemoveAt(0, NumExpired, EAllowShrinking::No);
+	}
+}
+
+void FChartLodPyramid::Reset()
+{
+	for (TArray<FChartLodBucket>& Buckets : Levels)
+	{
+		Buckets.Reset();
+	}
+}
+
+SIZE_T FChartLodPyramid::GetAllocatedSize() const
+{
+	SIZE_T Size = 0;
+	for (const TArray<FChartLodBucket>& Buckets : Levels)
+	{
+		Size += Buckets.GetAllocatedSize();
+	}
+	return Size;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+// 某一層的一個時間 bucket，Min/Max 的位置用來依時間順序輸出
+struct FChartLodBucket
+{
+	int64 Index = 0;
+	float Min = 0.0f;
+	float Max = 0.0f;
+	float Mean = 0.0f;
+	int32 Count = 0;
+	uint32 MinOffsetMs = 0;
+	uint32 MaxOffsetMs = 0;
+
+	// 資料來源的層級，較細的資料進來時會取代較粗的
+	uint8 SourceLevel = 0;
+};
+
+/**
+ * 單一 series 的多解析度 min/max/avg 彙總。Level 0 是原始 step (資料本身，不在這裡保存)，
+ * Level N 的 bucket 寬度是 BaseStep * 4^N。任何時間範圍都可以挑一層，
+ * 讓畫面上的 bucket 數不超過像素寬度。
+ */
+class PROMETHEUSVIEWER_API FChartLodPyramid
+{
+public:
+	static constexpr int32 NumLevels = 6;
+	static constexpr int32 LevelFactor = 4;
+
+	void SetBaseStep(int64 InBaseStepMs);
+	int64 GetBaseStepMs() const { return BaseStepMs; }
+
+	int64 GetBucketWidthMs(int32 Level) const { return GetBucketWidthMs(BaseStepMs, Level); }
+	static int64 GetBucketWidthMs(int64 BaseStepMs, int32 Level);
+
+	// bucket 寬度 >= MinBucketMs 的最細層級，都太細時回傳最粗的一層
+	static int32 ChooseLevel(int64 BaseStepMs, int64 MinBucketMs);
+
+	// SourceLevel 是這個 sample 的解析度 (抓回來的 step 對應的層級)，只會寫入 >= SourceLevel 的層
+	void Add(int64 TimeMs, float Value, int32 SourceLevel = 0);
+
+	void EvictBefore(int64 CutoffMs);
+	void Reset();
+
+	// Level >= 1
+	const TArray<FChartLodBucket>& GetLevel(int32 Level) const { return Levels[Level - 1]; }
+
+	// 依時間順序走訪與 [StartMs, EndMs] 重疊的 bucket
+	void ForEachBucket(int32 Level, int64 StartMs, int64 EndMs, TFunctionRef<void(const FChartLodBucket& Bucket)> Visitor) const;
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	void AddToLevel(int32 Level, int64 TimeMs, float Value, uint8 SourceLevel);
+
+	int64 BaseStepMs = 5000;
+	TArray<FChartLodBucket> Levels[NumLevels - 1];
+};
@@ -0,0 +1,283 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PrometheusSeries.h"
+#include "CompactTimeSeries.h"
+#include "ChartLodPyramid.h"
+
+/**
+ * 單一 series 的固定容量環狀 buffer (timestamp / value 分欄存放)。
+ * Push 與移除最舊的點都是 O(1)，滿了會自動覆蓋最舊的 sample。
+ * Index 0 是最舊的點，讀取時不需要複製。
+ * 每個 sample 同時寫入壓縮的 History，被覆蓋或移出視窗之後仍可查詢。
+ */
+struct FChartSeriesBuffer
+{
+	FPrometheusLabelSetHandle LabelSet;
+
+	// 比環狀 buffer 更長的歷史 (毫秒 timestamp + XOR 壓縮)，由擁有者決定保留多久
+	FCompactTimeSeries History;
+
+	// History 的 min/max/avg 彙總 (4x, 16x, ...)，縮小檢視時從這裡畫
+	FChartLodPyramid Lod;
+
+	// 第一個即時 (Push) 的 sample，之後的範圍不需要補抓
+	int64 LiveStartMs = MAX_int64;
+
+	explicit FChartSeriesBuffer(int32 InCapacity = 300)
+	{
+		SetCapacity(InCapacity);
+	}
+
+	int32 Num() const { return Count; }
+	int32 Capacity() const { return Times.Num(); }
+	bool IsEmpty() const { return Count == 0; }
+
+	FORCEINLINE double GetTime(int32 Index) const
+	{
+		checkSlow(Index >= 0 && Index < Count);
+		return Times[ToPhysical(Index)];
+	}
+
+	FORCEINLINE float GetValue(int32 Index) const
+	{
+		checkSlow(Index >= 0 && Index < Count);
+		return Values[ToPhysical(Index)];
+	}
+
+	double FirstTime() const { return GetTime(0); }
+	double LastTime() const { return GetTime(Count - 1); }
+
+	// 時間欄是遞增的，二分搜尋第一個 >= Time 的 index (全部都較小時回傳 Num())
+	int32 LowerBound(double Time) const
+	{
+		int32 Low = 0;
+		int32 High = Count;
+		while (Low < High)
+		{
+			const int32 Mid = Low + (High - Low) / 2;
+			if (GetTime(Mid) < Time)
+			{
+				Low = Mid + 1;
+			}
+			else
+			{
+				High = Mid;
+			}
+		}
+		return Low;
+	}
+
+	// 時間上最接近 Time 的點，空的 buffer 回傳 INDEX_NONE
+	int32 FindNearest(double Time) const
+	{
+		if (Count == 0)
+		{
+			return INDEX_NONE;
+		}
+
+		const int32 Index = LowerBound(Time);
+		if (Index == 0)
+		{
+			return 0;
+		}
+		if (Index == Count)
+		{
+			return Count - 1;
+		}
+		return Time - GetTime(Index - 1) <= GetTime(Index) - Time ? Index - 1 : Index;
+	}
+
+	void Push(double Time, float Value)
+	{
+		PushLive(Time, Value);
+
+		const int64 TimeMs = FCompactTimeSeries::ToMilliseconds(Time);
+		if (History.Append(TimeMs, Value))
+		{
+			Lod.Add(TimeMs, Value);
+			LiveStartMs = FMath::Min(LiveStartMs, TimeMs);
+		}
+	}
+
+	/**
+	 * 完整結果取代即時視窗: 環狀 buffer 重新填入，History 只補進還沒有的 sample，
+	 * 縮放/平移抓回的歷史與 LOD 都保留。
+	 */
+	void ReplaceLive(const FPrometheusSeries& Source)
+	{
+		ResetLive();
+
+		const int64 HistoryLastMs = History.IsEmpty() ? MIN_int64 : History.LastTimeMs();
+		TArray<int64> OlderTimesMs;
+		TArray<double> OlderValues;
+		for (int32 i = 0; i < Source.Num(); ++i)
+		{
+			PushLive(Source.Timestamps[i], Source.Values[i]);
+
+			const int64 TimeMs = FCompactTimeSeries::ToMilliseconds(Source.Timestamps[i]);
+			if (TimeMs > HistoryLastMs)
+			{
+				if (History.Append(TimeMs, Source.Values[i]))
+				{
+					Lod.Add(TimeMs, Source.Values[i]);
+				}
+			}
+			else
+			{
+				// 例如落後之後重抓的整個視窗，History 已有的範圍會略過
+				OlderTimesMs.Add(TimeMs);
+				OlderValues.Add(Source.Values[i]);
+			}
+		}
+
+		if (OlderTimesMs.Num() > 0)
+		{
+			History.InsertSorted(OlderTimesMs, OlderValues, [this](int64 TimeMs, double Value)
+			{
+				Lod.Add(TimeMs, static_cast<float>(Value));
+			});
+		}
+		if (Source.Num() > 0)
+		{
+			LiveStartMs = FMath::Min(LiveStartMs, FCompactTimeSeries::ToMilliseconds(Source.Timestamps[0]));
+		}
+	}
+
+	// 改變 LOD 的 bucket 寬度並從 History 重建；較粗的補抓區塊不在 History 裡，之後重新抓
+	void SetBaseStep(int64 BaseStepMs)
+	{
+		if (FMath::Max<int64>(BaseStepMs, 1) == Lod.GetBaseStepMs())
+		{
+			return;
+		}
+
+		Lod.SetBaseStep(BaseStepMs);
+		History.ForEachInRange(MIN_int64, MAX_int64, [this](int64 TimeMs, double Value)
+		{
+			Lod.Add(TimeMs, static_cast<float>(Value));
+		});
+	}
+
+	// 捲動到較舊的時間時抓回的資料: 原始 step (Level 0) 補進 History，較粗的 step 只寫入對應層級以上的 Lod
+	void MergeHistory(const FPrometheusSeries& Source, int32 SourceLevel)
+	{
+		if (SourceLevel > 0)
+		{
+			for (int32 i = 0; i < Source.Num(); ++i)
+			{
+				Lod.Add(FCompactTimeSeries::ToMilliseconds(Source.Timestamps[i]), Source.Values[i], SourceLevel);
+			}
+			return;
+		}
+
+		TArray<int64> TimesMs;
+		TArray<double> SampleValues;
+		TimesMs.Reserve(Source.Num());
+		SampleValues.Reserve(Source.Num());
+		for (int32 i = 0; i < Source.Num(); ++i)
+		{
+			TimesMs.Add(FCompactTimeSeries::ToMilliseconds(Source.Timestamps[i]));
+			SampleValues.Add(Source.Values[i]);
+		}
+
+		History.InsertSorted(TimesMs, SampleValues, [this](int64 TimeMs, double Value)
+		{
+			Lod.Add(TimeMs, static_cast<float>(Value));
+		});
+	}
+
+	void PopFront(int32 NumToRemove)
+	{
+		NumToRemove = FMath::Min(NumToRemove, Count);
+		Head = (Head + NumToRemove) % Times.Num();
+		Count -= NumToRemove;
+	}
+
+	// 移除早於 Cutoff 的點
+	void EvictOlderThan(double Cutoff)
+	{
+		int32 NumExpired = 0;
+		while (NumExpired < Count && GetTime(NumExpired) < Cutoff)
+		{
+			++NumExpired;
+		}
+		PopFront(NumExpired);
+	}
+
+	// 只清空環狀 buffer，History 與 LOD 保留
+	void ResetLive()
+	{
+		Head = 0;
+		Count = 0;
+	}
+
+	void Reset()
+	{
+		ResetLive();
+		History.Reset();
+		Lod.Reset();
+		LiveStartMs = MAX_int64;
+	}
+
+	// 改變容量時保留最新的點
+	void SetCapacity(int32 NewCapacity)
+	{
+		NewCapacity = FMath::Max(NewCapacity, 2);
+		if (NewCapacity == Times.Num())
+		{
+			return;
+		}
+
+		const int32 NumToKeep = FMath::Min(Count, NewCapacity);
+		TArray<double> NewTimes;
+		TArray<float> NewValues;
+		NewTimes.SetNumUninitialized(NewCapacity);
+		NewValues.SetNumUninitialized(NewCapacity);
+		for (int32 i = 0; i < NumToKeep; ++i)
+		{
+			NewTimes[i] = GetTime(Count - NumToKeep + i);
+			NewValues[i] = GetValue(Count - NumToKeep + i);
+		}
+
+		Times = MoveTemp(NewTimes);
+		Values = MoveTemp(NewValues);
+		Head = 0;
+		Count = NumToKeep;
+	}
+
+private:
+	// 只寫入環狀 buffer
+	void PushLive(double Time, float Value)
+	{
+		int32 Tail = Head + Count;
+		if (Tail >= Times.Num())
+		{
+			Tail -= Times.Num();
+		}
+
+		Times[Tail] = Time;
+		Values[Tail] = Value;
+
+		if (Count < Times.Num())
+		{
+			++Count;
+		}
+		else
+		{
+			// 已滿: 覆蓋最舊的點
+			Head = Head + 1 == Times.Num() ? 0 : Head + 1;
+		}
+	}
+
+	FORCEINLINE int32 ToPhysical(int32 Index) const
+	{
+		const int32 Physical = Head + Index;
+		return Physical >= Times.Num() ? Physical - Times.Num() : Physical;
+	}
+
+	TArray<double> Times;
+	TArray<float> Values;
+	int32 Head = 0;
+	int32 Count = 0;
+};
@@ -0,0 +1,454 @@
+#include "CompactTimeSeries.h"
+#include "Algo/BinarySearch.h"
+
+namespace CompactTimeSeries
+{
+	// 從低位元開始依序寫入的 bit stream
+	struct FBitWriter
+	{
+		TArray<uint64>& Words;
+		int64 NumBits = 0;
+
+		explicit FBitWriter(TArray<uint64>& InWords) : Words(InWords) {}
+
+		void Write(uint64 Value, int32 Count)
+		{
+			if (Count <= 0)
+			{
+				return;
+			}
+			if (Count < 64)
+			{
+				Value &= (uint64(1) << Count) - 1;
+			}
+
+			const int32 Offset = static_cast<int32>(NumBits & 63);
+			if (Offset == 0)
+			{
+				Words.Add(0);
+			}
+			Words.Last() |= Value << Offset;
+			if (Offset + Count > 64)
+			{
+				Words.Add(Value >> (64 - Offset));
+			}
+			NumBits += Count;
+		}
+	};
+
+	struct FBitReader
+	{
+		const TArray<uint64>& Words;
+		int64 Position = 0;
+
+		explicit FBitReader(const TArray<uint64>& InWords) : Words(InWords) {}
+
+		uint64 Read(int32 Count)
+		{
+			if (Count <= 0)
+			{
+				return 0;
+			}
+
+			const int32 Index = static_cast<int32>(Position >> 6);
+			const int32 Offset = static_cast<int32>(Position & 63);
+			uint64 Result = Words[Index] >> Offset;
+			if (Offset + Count > 64)
+			{
+				Result |= Words[Index + 1] << (64 - Offset);
+			}
+			if (Count < 64)
+			{
+				Result &= (uint64(1) << Count) - 1;
+			}
+			Position += Count;
+			return Result;
+		}
+
+		bool ReadBit() { return Read(1) != 0; }
+	};
+
+	static uint64 ToBits(double Value)
+	{
+		uint64 Bits;
+		FMemory::Memcpy(&Bits, &Value, sizeof(Bits));
+		return Bits;
+	}
+
+	static double FromBits(uint64 Bits)
+	{
+		double Value;
+		FMemory::Memcpy(&Value, &Bits, sizeof(Value));
+		return Value;
+	}
+
+	// 有號數轉成小的無號數 (0, -1, 1, -2, ... -> 0, 1, 2, 3, ...)
+	static uint64 ZigZagEncode(int64 Value) { return (static_cast<uint64>(Value) << 1) ^ static_cast<uint64>(Value >> 63); }
+	static int64 ZigZagDecode(uint64 Value) { return static_cast<int64>(Value >> 1) ^ -static_cast<int64>(Value & 1); }
+
+	// delta-of-delta 的長度分級: 前綴 0 / 10 / 110 / 1110 / 1111
+	static void WriteDeltaOfDelta(FBitWriter& Writer, int64 DeltaOfDelta)
+	{
+		if (DeltaOfDelta == 0)
+		{
+			Writer.Write(0b0, 1);
+			return;
+		}
+
+		const uint64 Encoded = ZigZagEncode(DeltaOfDelta);
+		if (Encoded < (uint64(1) << 7))
+		{
+			Writer.Write(0b01, 2);
+			Writer.Write(Encoded, 7);
+		}
+		else if (Encoded < (uint64(1) << 9))
+		{
+			Writer.Write(0b011, 3);
+			Writer.Write(Encoded, 9);
+		}
+		else if (Encoded < (uint64(1) << 12))
+		{
+			Writer.Write(0b0111, 4);
+			Writer.Write(Encoded, 12);
+		}
+		else
+		{
+			Writer.Write(0b1111, 4);
+			Writer.Write(Encoded, 64);
+		}
+	}
+
+	static int64 ReadDeltaOfDelta(FBitReader& Reader)
+	{
+		if (!Reader.ReadBit())
+		{
+			return 0;
+		}
+		if (!Reader.ReadBit())
+		{
+			return ZigZagDecode(Reader.Read(7));
+		}
+		if (!Reader.ReadBit())
+		{
+			return ZigZagDecode(Reader.Read(9));
+		}
+		if (!Reader.ReadBit())
+		{
+			return ZigZagDecode(Reader.Read(12));
+		}
+		return ZigZagDecode(Reader.Read(64));
+	}
+
+	// Gorilla XOR: 0 = 相同值，10 = 沿用上一次的有效位元區間，11 = 新區間 (5 bit leading + 6 bit 長度)
+	struct FXorEncoder
+	{
+		uint64 PrevBits = 0;
+		int32 PrevLeading = -1;
+		int32 PrevTrailing = 0;
+
+		void Write(FBitWriter& Writer, uint64 Bits)
+		{
+			const uint64 Xor = Bits ^ PrevBits;
+			PrevBits = Bits;
+
+			if (Xor == 0)
+			{
+				Writer.Write(0b0, 1);
+				return;
+			}
+
+			const int32 Leading = FMath::Min(static_cast<int32>(FMath::CountLeadingZeros64(Xor)), 31);
+			const int32 Trailing = static_cast<int32>(FMath::CountTrailingZeros64(Xor));
+
+			if (PrevLeading >= 0 && Leading >= PrevLeading && Trailing >= PrevTrailing)
+			{
+				Writer.Write(0b01, 2);
+				Writer.Write(Xor >> PrevTrailing, 64 - PrevLeading - PrevTrailing);
+				return;
+			}
+
+			const int32 Meaningful = 64 - Leading - Trailing;
+			Writer.Write(0b11, 2);
+			Writer.Write(Leading, 5);
+			Writer.Write(Meaningful - 1, 6);
+			Writer.Write(Xor >> Trailing, Meaningful);
+
+			PrevLeading = Leading;
+			PrevTrailing = Trailing;
+		}
+	};
+
+	struct FXorDecoder
+	{
+		uint64 PrevBits = 0;
+		int32 PrevLeading = 0;
+		int32 PrevTrailing = 0;
+
+		uint64 Read(FBitReader& Reader)
+		{
+			if (!Reader.ReadBit())
+			{
+				return PrevBits;
+			}
+
+			if (Reader.ReadBit())
+			{
+				PrevLeading = static_cast<int32>(Reader.Read(5));
+				const int32 Meaningful = static_cast<int32>(Reader.Read(6)) + 1;
+				PrevTrailing = 64 - PrevLeading - Meaningful;
+			}
+
+			const uint64 Xor = Reader.Read(64 - PrevLeading - PrevTrailing) << PrevTrailing;
+			PrevBits ^= Xor;
+			return PrevBits;
+		}
+	};
+}
+
+bool FCompactTimeSeries::Append(int64 TimeMs, double Value)
+{
+	if (!IsEmpty() && TimeMs <= LastTimeMs())
+	{
+		return false;
+	}
+
+	TailTimes.Add(TimeMs);
+	TailValues.Add(Value);
+
+	if (TailTimes.Num() >= BlockSize)
+	{
+		SealTail();
+	}
+	return true;
+}
+
+int64 FCompactTimeSeries::FirstTimeMs() const
+{
+	check(!IsEmpty());
+	return Blocks.Num() > 0 ? Blocks[0].FirstTimeMs : TailTimes[0];
+}
+
+int64 FCompactTimeSeries::LastTimeMs() const
+{
+	check(!IsEmpty());
+	return TailTimes.Num() > 0 ? TailTimes.Last() : Blocks.Last().LastTimeMs;
+}
+
+void FCompactTimeSeries::SealTail()
+{
+	if (TailTimes.Num() == 0)
+	{
+		return;
+	}
+
+	EncodeBlock(TailTimes, TailValues, Blocks.AddDefaulted_GetRef());
+	NumSealed += TailTimes.Num();
+
+	TailTimes.Reset();
+	TailValues.Reset();
+}
+
+void FCompactTimeSeries::InsertSorted(TArrayView<const int64> TimesMs, TArrayView<const double> InValues, TFunctionRef<void(int64 TimeMs, double Value)> OnInserted)
+{
+	check(TimesMs.Num() == InValues.Num());
+
+	int32 i = 0;
+	while (i < TimesMs.Num())
+	{
+		const int64 Time = TimesMs[i];
+
+		// 比現有資料都新: 照一般的 Append 走
+		if (IsEmpty() || Time > LastTimeMs())
+		{
+			if (Append(Time, InValues[i]))
+			{
+				OnInserted(Time, InValues[i]);
+			}
+			++i;
+			continue;
+		}
+
+		// 第一個還沒結束的 block，Time 落在它裡面就略過
+		const int32 BlockIndex = Algo::LowerBoundBy(Blocks, Time, &FBlock::LastTimeMs);
+		if (Blocks.IsValidIndex(BlockIndex) && Blocks[BlockIndex].FirstTimeMs <= Time)
+		{
+			++i;
+			continue;
+		}
+
+		// 空隙的上界是下一個 block 或 tail 的起點
+		const int64 GapEnd = Blocks.IsValidIndex(BlockIndex) ? Blocks[BlockIndex].FirstTimeMs : TailTimes[0];
+		if (Time >= GapEnd)
+		{
+			++i;
+			continue;
+		}
+
+		int32 RunEnd = i + 1;
+		while (RunEnd < TimesMs.Num() && RunEnd - i < BlockSize && TimesMs[RunEnd] < GapEnd)
+		{
+			++RunEnd;
+		}
+
+		FBlock NewBlock;
+		EncodeBlock(TimesMs.Slice(i, RunEnd - i), InValues.Slice(i, RunEnd - i), NewBlock);
+		Blocks.Insert(MoveTemp(NewBlock), BlockIndex);
+		NumSealed += RunEnd - i;
+
+		for (; i < RunEnd; ++i)
+		{
+			OnInserted(TimesMs[i], InValues[i]);
+		}
+	}
+}
+
+void FCompactTimeSeries::EncodeBlock(TArrayView<const int64> TimesMs, TArrayView<const double> InValues, FBlock& Block)
+{
+	using namespace CompactTimeSeries;
+
+	const int32 Count = TimesMs.Num();
+	check(Count > 0 && Count == InValues.Num());
+
+	Block.FirstTimeMs = TimesMs[0];
+	Block.LastTimeMs = TimesMs[Count - 1];
+	Block.Count = Count;
+	Block.Bits.Reset();
+
+	// 全部間隔相同時只存 step，不寫 timestamp
+	const int64 Step = Count > 1 ? TimesMs[1] - TimesMs[0] : 0;
+	bool bRegular = Count > 1;
+	for (int32 i = 2; i < Count && bRegular; ++i)
+	{
+		bRegular = TimesMs[i] - TimesMs[i - 1] == Step;
+	}
+	Block.StepMs = bRegular ? Step : 0;
+
+	FBitWriter Writer(Block.Bits);
+	FXorEncoder ValueEncoder;
+
+	int64 PrevDelta = 0;
+	Block.MinValue = InValues[0];
+	Block.MaxValue = InValues[0];
+	Writer.Write(ToBits(InValues[0]), 64);
+	ValueEncoder.PrevBits = ToBits(InValues[0]);
+
+	for (int32 i = 1; i < Count; ++i)
+	{
+		if (!bRegular)
+		{
+			const int64 Delta = TimesMs[i] - TimesMs[i - 1];
+			WriteDeltaOfDelta(Writer, Delta - PrevDelta);
+			PrevDelta = Delta;
+		}
+
+		ValueEncoder.Write(Writer, ToBits(InValues[i]));
+		Block.MinValue = FMath::Min(Block.MinValue, InValues[i]);
+		Block.MaxValue = FMath::Max(Block.MaxValue, InValues[i]);
+	}
+
+	Block.Bits.Shrink();
+}
+
+void FCompactTimeSeries::DecodeBlock(const FBlock& Block, TFunctionRef<void(int64 TimeMs, double Value)> Visitor)
+{
+	using namespace CompactTimeSeries;
+
+	FBitReader Reader(Block.Bits);
+	FXorDecoder ValueDecoder;
+
+	int64 Time = Block.FirstTimeMs;
+	int64 Delta = 0;
+	ValueDecoder.PrevBits = Reader.Read(64);
+	Visitor(Time, FromBits(ValueDecoder.PrevBits));
+
+	for (int32 i = 1; i < Block.Count; ++i)
+	{
+		if (Block.StepMs > 0)
+		{
+			Time += Block.StepMs;
+		}
+		else
+		{
+			Delta += ReadDeltaOfDelta(Reader);
+			Time += Delta;
+		}
+
+		Visitor(Time, FromBits(ValueDecoder.Read(Reader)));
+	}
+}
+
+void FCompactTimeSeries::ForEachInRange(int64 StartMs, int64 EndMs, TFunctionRef<void(int64 TimeMs, double Value)> Visitor) const
+{
+	for (const FBlock& Block : Blocks)
+	{
+		if (Block.LastTimeMs < StartMs)
+		{
+			continue;
+		}
+		if (Block.FirstTimeMs > EndMs)
+		{
+			return;
+		}
+
+		DecodeBlock(Block, [StartMs, EndMs, &Visitor](int64 TimeMs, double Value)
+		{
+			if (TimeMs >= StartMs && TimeMs <= EndMs)
+			{
+				Visitor(TimeMs, Value);
+			}
+		});
+	}
+
+	for (int32 i = 0; i < TailTimes.Num(); ++i)
+	{
+		if (TailTimes[i] > EndMs)
+		{
+			return;
+		}
+		if (TailTimes[i] >= StartMs)
+		{
+			Visitor(TailTimes[i], TailValues[i]);
+		}
+	}
+}
+
+void FCompactTimeSeries::EvictBefore(int64 CutoffMs)
+{
+	int32 NumExpired = 0;
+	while (NumExpired < Blocks.Num() && Blocks[NumExpired].LastTimeMs < CutoffMs)
+	{
+		NumSealed -= Blocks[NumExpired].Count;
+		++NumExpired;
+	}
+	Blocks.RemoveAt(0, NumExpired, EAllowShrinking::No);
+
+	// 還沒封存的 tail 直接逐點移除
+	if (Blocks.Num() == 0)
+	{
+		int32 NumTailExpired = 0;
+		while (NumTailExpired < TailTimes.Num() && TailTimes[NumTailExpired] < CutoffMs)
+		{
+			++NumTailExpired;
+		}
+		TailTimes.RemoveAt(0, NumTailExpired, EAllowShrinking::No);
+		TailValues.RemoveAt(0, NumTailExpired, EAllowShrinking::No);
+	}
+}
+
+void FCompactTimeSeries::Reset()
+{
+	Blocks.Reset();
+	NumSealed = 0;
+	TailTimes.Reset();
+	TailValues.Reset();
+}
+
+SIZE_T FCompactTimeSeries::GetAllocatedSize() const
+{
+	SIZE_T Size = Blocks.GetAllocatedSize() + TailTimes.GetAllocatedSize() + TailValues.GetAllocatedSize();
+	for (const FBlock& Block : Blocks)
+	{
+		Size += Block.Bits.GetAllocatedSize();
+	}
+	return Size;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * 長時間歷史用的壓縮 time series，timestamp 以 int64 毫秒保存 (完全精確)。
+ * 最新的 sample 放在未壓縮的 tail，累積 BlockSize 個之後封存成壓縮 block:
+ * 固定間隔的 block 只存起點與 step，不固定的用 delta-of-delta 編碼 timestamp，
+ * 值則用 Gorilla 的 XOR 編碼。
+ */
+class PROMETHEUSVIEWER_API FCompactTimeSeries
+{
+public:
+	static constexpr int32 BlockSize = 120;
+
+	// 封存後的 block，Min/Max 讓查詢不必解碼就能略過或估算範圍
+	struct FBlock
+	{
+		int64 FirstTimeMs = 0;
+		int64 LastTimeMs = 0;
+		// 0 表示間隔不固定，timestamp 編碼在 Bits 裡
+		int64 StepMs = 0;
+		int32 Count = 0;
+		double MinValue = 0.0;
+		double MaxValue = 0.0;
+		TArray<uint64> Bits;
+	};
+
+	static int64 ToMilliseconds(double Seconds) { return FMath::RoundToInt64(Seconds * 1000.0); }
+
+	// 時間必須遞增，不大於最後一個 sample 的點會被丟棄；回傳是否有加入
+	bool Append(int64 TimeMs, double Value);
+
+	/**
+	 * 補入較舊的資料 (例如捲動到歷史時抓回的區塊)，TimesMs 必須遞增。
+	 * 落在既有 block 或 tail 範圍內的 sample 會略過，其餘編成新的 block 插入對應位置；
+	 * 實際加入的 sample 依序交給 OnInserted。
+	 */
+	void InsertSorted(TArrayView<const int64> TimesMs, TArrayView<const double> InValues, TFunctionRef<void(int64 TimeMs, double Value)> OnInserted);
+
+	int32 Num() const { return NumSealed + TailTimes.Num(); }
+	bool IsEmpty() const { return Num() == 0; }
+
+	int64 FirstTimeMs() const;
+	int64 LastTimeMs() const;
+
+	// 以 block 為單位移除早於 CutoffMs 的資料 (跨越 Cutoff 的 block 會保留)
+	void EvictBefore(int64 CutoffMs);
+
+	void Reset();
+
+	// 依時間順序走訪 [StartMs, EndMs] 內的 sample，只解碼範圍重疊的 block
+	void ForEachInRange(int64 StartMs, int64 EndMs, TFunctionRef<void(int64 TimeMs, double Value)> Visitor) const;
+
+	const TArray<FBlock>& GetBlocks() const { return Blocks; }
+
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	void SealTail();
+
+	static void EncodeBlock(TArrayView<const int64> TimesMs, TArrayView<const double> InValues, FBlock& OutBlock);
+
+	static void DecodeBlock(const FBlock& Block, TFunctionRef<void(int64 TimeMs, double Value)> Visitor);
+
+	TArray<FBlock> Blocks;
+	int32 NumSealed = 0;
+
+	TArray<int64> TailTimes;
+	TArray<double> TailValues;
+};
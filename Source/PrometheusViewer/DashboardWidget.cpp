@@ -1,7 +1,8 @@
 #include "DashboardWidget.h"
 #include "Components/Button.h"
-#include "Components/ScrollBox.h"
+#include "Components/ListView.h"
 #include "MonitoringItemWidget.h"
+#include "MonitoringItemData.h"
 #include "PrometheusManager.h"
 #include "EngineUtils.h"
 #include "Components/TextBlock.h"
@@ -10,10 +11,6 @@ void UDashboardWidget::NativeConstruct()
 {
     Super::NativeConstruct();
 
-    /*UTextBlock* TestText = NewObject<UTextBlock>(this);
-    TestText->SetText(FText::FromString(TEXT("測試內容是否顯示")));
-    MonitorListBox->AddChild(TestText);*/
-
     if (AddMonitorButton)
     {
         AddMonitorButton->OnClicked.AddDynamic(this, &UDashboardWidget::OnAddMonitorClicked);
@@ -25,11 +22,6 @@ void UDashboardWidget::NativeConstruct()
         break;
     }
 
-    if (ManagerRef)
-    {
-        ManagerRef->OnQueryResponse.RemoveDynamic(this, &UDashboardWidget::OnQueryResponseReceived);
-        ManagerRef->OnQueryResponse.AddDynamic(this, &UDashboardWidget::OnQueryResponseReceived);
-    }
     UE_LOG(LogTemp, Warning, TEXT("ManagerRef valid: %s"), ManagerRef ? TEXT("Yes") : TEXT("No"));
 }
 
@@ -37,55 +29,66 @@ void UDashboardWidget::OnAddMonitorClicked()
 {
     UE_LOG(LogTemp, Warning, TEXT("Button clicked"));
 
-    if (MonitoringItemWidgetClass)
+    if (!MonitorListView || !MonitorListView->GetEntryWidgetClass())
     {
-        UMonitoringItemWidget* NewItem = CreateWidget<UMonitoringItemWidget>(GetWorld(), MonitoringItemWidgetClass);
+        UE_LOG(LogTemp, Error, TEXT("MonitorListView has no Entry Widget Class! Please assign a MonitoringItemWidget in the editor."));
+        return;
+    }
 
-        if (NewItem)
-        {
-            UE_LOG(LogTemp, Warning, TEXT("MonitoringItemWidget Added to MonitorListBox"));
-            MonitorListBox->AddChild(NewItem);
-            NewItem->InitializeOptions(ManagerRef);
+    // 只建立資料，widget 由列表在項目捲進畫面時建立或回收
+    UMonitoringItemData* NewItem = NewObject<UMonitoringItemData>(this);
+    NewItem->Initialize(ManagerRef);
+    Items.Add(NewItem);
+    MonitorListView->AddItem(NewItem);
 
-            NewItem->OnPromQueryGenerated.RemoveDynamic(this, &UDashboardWidget::HandleDynamicPromQL);
-            NewItem->OnPromQueryGenerated.AddDynamic(this, &UDashboardWidget::HandleDynamicPromQL);
-        }
-        else
-        {
-            UE_LOG(LogTemp, Error, TEXT("CreateWidget returned nullptr"));
-        }
+    UE_LOG(LogTemp, Verbose, TEXT("MonitoringItemData added to MonitorListView (%d items)"), Items.Num());
+}
+
+void UDashboardWidget::RemoveItem(UMonitoringItemData* Item)
+{
+    if (!Item || Items.Remove(Item) == 0)
+    {
+        return;
     }
-    else
+
+    if (MonitorListView)
     {
-        UE_LOG(LogTemp, Error, TEXT("MonitoringItemWidgetClass is null! Please assign it in the editor."));
+        MonitorListView->RemoveItem(Item);
     }
+    Item->Shutdown();
 }
 
-void UDashboardWidget::HandleDynamicPromQL(const FString& PromQL, UMonitoringItemWidget* UIWidget)
+void UDashboardWidget::NativeTick(const FGeometry& MyGeometry, float InDeltaTime)
 {
-    if (ManagerRef && UIWidget)
+    Super::NativeTick(MyGeometry, InDeltaTime);
+
+    if (!bRefreshOffscreenItems)
     {
-        FPrometheusQueryInfo Info;
-        Info.PromQL = PromQL;
-        Info.Description = "Dynamic";
-        Info.UITextRef = UIWidget->GetResultTextBlock();
-        ManagerRef->AddDynamicQuery(Info);
+        return;
+    }
 
-		UIWidget->TriggerQuery(ManagerRef);
+    // 捲出畫面的項目沒有 widget 會 paint，由 dashboard 代為標記；dashboard 本身沒顯示時不會 tick，query 一樣暫停
+    for (UMonitoringItemData* Item : Items)
+    {
+        if (!Item->GetEntryWidget())
+        {
+            Item->MarkVisible();
+        }
     }
 }
 
-void UDashboardWidget::OnQueryResponseReceived(const FString& PromQL, const FString& Result)
+void UDashboardWidget::NativeDestruct()
 {
-    UE_LOG(LogTemp, Warning, TEXT("[OnQueryResponseReceived] PromQL: %s, Result: %s"), *PromQL, *Result);
+    for (UMonitoringItemData* Item : Items)
+    {
+        Item->Shutdown();
+    }
+    Items.Reset();
 
-    // 遍歷 ScrollBox 中的所有子 Widget
-    for (UWidget* Child : MonitorListBox->GetAllChildren())
+    if (MonitorListView)
     {
-        if (UMonitoringItemWidget* Item = Cast<UMonitoringItemWidget>(Child))
-        {
-            Item->OnQueryResponseReceived(PromQL, Result);
-        }
+        MonitorListView->ClearListItems();
     }
 
-}
\ No newline at end of file
+    Super::NativeDestruct();
+}
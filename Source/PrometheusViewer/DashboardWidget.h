@@ -5,8 +5,9 @@
 #include "DashboardWidget.generated.h"
 
 class UButton;
-class UScrollBox;
+class UListView;
 class UMonitoringItemWidget;
+class UMonitoringItemData;
 class UTextBlock;
 
 UCLASS()
@@ -16,24 +17,33 @@ class PROMETHEUSVIEWER_API UDashboardWidget : public UUserWidget
 
 public:
     UPROPERTY(meta = (BindWidget)) class UButton* AddMonitorButton;
-    UPROPERTY(meta = (BindWidget)) class UScrollBox* MonitorListBox;
+
+    // 虛擬化的列表: 只為畫面上看得到的項目建立 widget (Entry Widget Class 設成 UMonitoringItemWidget)，捲動時回收
+    UPROPERTY(meta = (BindWidget)) class UListView* MonitorListView;
 
     UFUNCTION() void OnAddMonitorClicked();
 
+    // 從列表移除一個項目並結束它的訂閱
+    void RemoveItem(UMonitoringItemData* Item);
+
     UPROPERTY(EditAnywhere) TSubclassOf<class APrometheusManager> ManagerClass;
 
+    // 捲出畫面的項目不會 paint，仍照排程更新 query，捲回來時直接畫出最新資料；false 時與其他隱藏的 widget 一樣暫停
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
-    TSubclassOf<UMonitoringItemWidget> MonitoringItemWidgetClass;
+    bool bRefreshOffscreenItems = true;
 
- 
-
-    UFUNCTION()
-    void HandleDynamicPromQL(const FString& PromQL, UMonitoringItemWidget* UIWidget);
+    // 每個監控項目的資料與訂閱，順序與列表相同
+    const TArray<TObjectPtr<UMonitoringItemData>>& GetItems() const { return Items; }
 
     class APrometheusManager* ManagerRef = nullptr;
 
     virtual void NativeConstruct() override;
 
-    UFUNCTION()
-    void OnQueryResponseReceived(const FString& PromQL, const FString& Result);
+protected:
+    virtual void NativeDestruct() override;
+    virtual void NativeTick(const FGeometry& MyGeometry, float InDeltaTime) override;
+
+private:
+    UPROPERTY(Transient)
+    TArray<TObjectPtr<UMonitoringItemData>> Items;
 };
\ No newline at end of file
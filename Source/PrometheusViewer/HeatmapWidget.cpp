@@ -0,0 +1,507 @@
+#include "HeatmapWidget.h"
+#include "Engine/Texture2D.h"
+#include "Rendering/DrawElements.h"
+#include "Styling/CoreStyle.h"
+#include "Algo/BinarySearch.h"
+#include "PrometheusQueryTrace.h"
+
+namespace HeatmapLayout
+{
+    static const float PaddingLeft = 50.0f;
+    static const float PaddingRight = 10.0f;
+    static const float PaddingTop = 10.0f;
+    static const float PaddingBottom = 30.0f;
+
+    // Y 軸標籤的最小間距 (像素)
+    static const float MinLabelSpacing = 14.0f;
+
+    static FSlateFontInfo GetFont()
+    {
+        FSlateFontInfo FontInfo = FCoreStyle::Get().GetFontStyle("NormalFont");
+        FontInfo.Size = 10;
+        return FontInfo;
+    }
+
+    static FString FormatBound(double Bound)
+    {
+        return Bound == TNumericLimits<double>::Max() ? FString(TEXT("+Inf")) : FString::Printf(TEXT("%g"), Bound);
+    }
+}
+
+bool UHeatmapWidget::ParseBucketBound(FPrometheusLabelSetHandle LabelSet, double& OutBound)
+{
+    // label set 已正規化成 name{a="1",le="0.5"}
+    const FString Labels = FPrometheusLabelSetTable::Get().Resolve(LabelSet);
+
+    int32 Start = Labels.Find(TEXT("{le=\""), ESearchCase::CaseSensitive);
+    if (Start == INDEX_NONE)
+    {
+        Start = Labels.Find(TEXT(",le=\""), ESearchCase::CaseSensitive);
+    }
+    if (Start == INDEX_NONE)
+    {
+        return false;
+    }
+
+    const int32 ValueStart = Start + 5;
+    const int32 ValueEnd = Labels.Find(TEXT("\""), ESearchCase::CaseSensitive, ESearchDir::FromStart, ValueStart);
+    if (ValueEnd == INDEX_NONE)
+    {
+        return false;
+    }
+
+    const FString Value = Labels.Mid(ValueStart, ValueEnd - ValueStart);
+    OutBound = Value == TEXT("+Inf") ? TNumericLimits<double>::Max() : FCString::Atod(*Value);
+    return true;
+}
+
+bool UHeatmapWidget::IsHistogramResult(const FPrometheusRangeResult& Result)
+{
+    if (Result.Series.Num() == 0)
+    {
+        return false;
+    }
+
+    for (const FPrometheusSeries& Series : Result.Series)
+    {
+        double Bound;
+        if (!ParseBucketBound(Series.LabelSet, Bound))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void UHeatmapWidget::SetSeriesData(const FPrometheusRangeResult& InResult)
+{
+    Reset();
+    IngestSamples(InResult);
+    FlushToTexture();
+}
+
+void UHeatmapWidget::AppendSeriesData(const FPrometheusRangeResult& NewSamples)
+{
+    IngestSamples(NewSamples);
+    FlushToTexture();
+}
+
+void UHeatmapWidget::SetBaseStep(float InStepSeconds)
+{
+    const float NewStep = FMath::Max(InStepSeconds, 0.001f);
+    if (NewStep != StepSeconds)
+    {
+        // 欄寬改變後原本的欄無法沿用
+        StepSeconds = NewStep;
+        Reset();
+    }
+}
+
+void UHeatmapWidget::SetWindowSeconds(float InWindowSeconds)
+{
+    const float NewWindow = FMath::Max(InWindowSeconds, 1.0f);
+    if (NewWindow != WindowSeconds)
+    {
+        WindowSeconds = NewWindow;
+        Reset();
+    }
+}
+
+void UHeatmapWidget::Reset()
+{
+    NumColumns = FMath::Max(FMath::CeilToInt(WindowSeconds / StepSeconds) + 1, 2);
+
+    BucketBounds.Reset();
+    SeriesToBucket.Reset();
+    LastRawSamples.Reset();
+    CumulativeCells.Reset();
+    SlotColumns.Init(INDEX_NONE, NumColumns);
+    LatestColumn = INDEX_NONE;
+    ColorScaleMax = 1.0f;
+    bColorScaleStale = false;
+    DirtySlots.Init(false, NumColumns);
+    bNeedsFullUpload = true;
+}
+
+int32 UHeatmapWidget::FindOrAddBucket(FPrometheusLabelSetHandle LabelSet)
+{
+    if (const int32* Existing = SeriesToBucket.Find(LabelSet))
+    {
+        return *Existing;
+    }
+
+    double Bound;
+    if (!ParseBucketBound(LabelSet, Bound))
+    {
+        return INDEX_NONE;
+    }
+
+    int32 Bucket = Algo::LowerBound(BucketBounds, Bound);
+    if (!BucketBounds.IsValidIndex(Bucket) || BucketBounds[Bucket] != Bound)
+    {
+        // 新的 le: 插入一列，累計值沿用下面那個 bucket，這一列在已有的欄裡次數為 0
+        const int32 OldNumBuckets = BucketBounds.Num();
+        BucketBounds.Insert(Bound, Bucket);
+
+        TArray<float> OldCells = MoveTemp(CumulativeCells);
+        CumulativeCells.SetNumZeroed(NumColumns * BucketBounds.Num());
+        for (int32 Slot = 0; Slot < NumColumns && OldNumBuckets > 0; ++Slot)
+        {
+            for (int32 b = 0; b < BucketBounds.Num(); ++b)
+            {
+                const int32 OldBucket = b < Bucket ? b : b - 1;
+                CumulativeCells[Slot * BucketBounds.Num() + b] = OldBucket >= 0 ? OldCells[Slot * OldNumBuckets + OldBucket] : 0.0f;
+            }
+        }
+
+        for (TPair<FPrometheusLabelSetHandle, int32>& Pair : SeriesToBucket)
+        {
+            if (Pair.Value >= Bucket)
+            {
+                ++Pair.Value;
+            }
+        }
+
+        // 高度改變，texture 要重建
+        bNeedsFullUpload = true;
+    }
+
+    SeriesToBucket.Add(LabelSet, Bucket);
+    return Bucket;
+}
+
+int32 UHeatmapWidget::GetSlot(int64 Column) const
+{
+    return static_cast<int32>(((Column % NumColumns) + NumColumns) % NumColumns);
+}
+
+void UHeatmapWidget::MarkColumnDirty(int32 Slot)
+{
+    DirtySlots[Slot] = true;
+}
+
+void UHeatmapWidget::AdvanceToColumn(int64 Column)
+{
+    // 超出視窗的欄被新的欄覆蓋，一次跳很遠時最多清空整個環
+    int64 First = LatestColumn == INDEX_NONE ? Column : LatestColumn + 1;
+    First = FMath::Max(First, Column - NumColumns + 1);
+
+    const int32 NumBuckets = BucketBounds.Num();
+    for (int64 c = First; c <= Column; ++c)
+    {
+        const int32 Slot = GetSlot(c);
+        bColorScaleStale |= SlotColumns[Slot] != INDEX_NONE;
+        SlotColumns[Slot] = c;
+        for (int32 b = 0; b < NumBuckets; ++b)
+        {
+            CumulativeCells[Slot * NumBuckets + b] = 0.0f;
+        }
+        MarkColumnDirty(Slot);
+    }
+    LatestColumn = Column;
+}
+
+void UHeatmapWidget::IngestSamples(const FPrometheusRangeResult& Result)
+{
+    // 先登記所有 bucket，寫入時的列位置就不會再變
+    for (const FPrometheusSeries& Series : Result.Series)
+    {
+        FindOrAddBucket(Series.LabelSet);
+    }
+
+    const int32 NumBuckets = BucketBounds.Num();
+    if (NumBuckets == 0)
+    {
+        return;
+    }
+
+    for (const FPrometheusSeries& Series : Result.Series)
+    {
+        const int32* BucketPtr = SeriesToBucket.Find(Series.LabelSet);
+        if (!BucketPtr)
+        {
+            continue;
+        }
+        const int32 Bucket = *BucketPtr;
+
+        FVector2D* LastSample = LastRawSamples.Find(Series.LabelSet);
+        for (int32 i = 0; i < Series.Num(); ++i)
+        {
+            const double Time = Series.Timestamps[i];
+            const double Value = Series.Values[i];
+            if (LastSample && Time <= LastSample->X)
+            {
+                // 避免時間倒退或重複
+                continue;
+            }
+
+            double Amount = Value;
+            if (bCumulativeCounters)
+            {
+                if (!LastSample)
+                {
+                    // 第一筆只當作基準
+                    LastSample = &LastRawSamples.Add(Series.LabelSet, FVector2D(Time, Value));
+                    continue;
+                }
+
+                // counter 重置時整個值都是新的次數
+                Amount = Value >= LastSample->Y ? Value - LastSample->Y : Value;
+            }
+
+            if (LastSample)
+            {
+                *LastSample = FVector2D(Time, Value);
+            }
+            else
+            {
+                LastSample = &LastRawSamples.Add(Series.LabelSet, FVector2D(Time, Value));
+            }
+
+            const int64 Column = FMath::FloorToInt64(Time / StepSeconds);
+            if (LatestColumn == INDEX_NONE || Column > LatestColumn)
+            {
+                AdvanceToColumn(Column);
+            }
+            else if (Column <= LatestColumn - NumColumns)
+            {
+                continue;
+            }
+
+            const int32 Slot = GetSlot(Column);
+            CumulativeCells[Slot * NumBuckets + Bucket] += static_cast<float>(Amount);
+            MarkColumnDirty(Slot);
+        }
+    }
+}
+
+FColor UHeatmapWidget::GetCellColor(float Count) const
+{
+    if (Count <= 0.0f)
+    {
+        return EmptyColor.ToFColor(true);
+    }
+
+    // 次數的分佈通常很偏，用 log 讓少量的格子也看得出來
+    const float Alpha = FMath::Clamp(FMath::Loge(1.0f + Count) / FMath::Loge(1.0f + ColorScaleMax), 0.0f, 1.0f);
+    return FLinearColor::LerpUsingHSV(LowColor, HighColor, Alpha).ToFColor(true);
+}
+
+void UHeatmapWidget::UpdateColumnPixels(int32 Slot)
+{
+    const int32 NumBuckets = BucketBounds.Num();
+    const bool bHasColumn = SlotColumns[Slot] != INDEX_NONE;
+
+    // 第 0 列是最大的 bucket
+    float Below = 0.0f;
+    for (int32 b = 0; b < NumBuckets; ++b)
+    {
+        const float Cumulative = bHasColumn ? CumulativeCells[Slot * NumBuckets + b] : 0.0f;
+        const int32 Row = NumBuckets - 1 - b;
+        Pixels[Row * NumColumns + Slot] = GetCellColor(FMath::Max(Cumulative - Below, 0.0f));
+        Below = FMath::Max(Below, Cumulative);
+    }
+}
+
+float UHeatmapWidget::GetColumnMaxCount(int32 Slot) const
+{
+    const int32 NumBuckets = BucketBounds.Num();
+
+    float MaxCount = 0.0f;
+    float Below = 0.0f;
+    for (int32 b = 0; b < NumBuckets; ++b)
+    {
+        const float Cumulative = CumulativeCells[Slot * NumBuckets + b];
+        MaxCount = FMath::Max(MaxCount, Cumulative - Below);
+        Below = FMath::Max(Below, Cumulative);
+    }
+    return MaxCount;
+}
+
+void UHeatmapWidget::RecreateTexture()
+{
+    const int32 NumBuckets = BucketBounds.Num();
+
+    Texture = UTexture2D::CreateTransient(NumColumns, NumBuckets, PF_B8G8R8A8);
+    if (!Texture)
+    {
+        return;
+    }
+
+    // 每個 texel 就是一格，不做內插；X 方向 wrap 讓環狀的欄可以用 UV 位移接起來
+    Texture->Filter = TF_Nearest;
+    Texture->AddressX = TA_Wrap;
+    Texture->AddressY = TA_Clamp;
+    Texture->SRGB = true;
+    Texture->UpdateResource();
+
+    Pixels.Init(EmptyColor.ToFColor(true), NumColumns * NumBuckets);
+
+    Brush = FSlateBrush();
+    Brush.SetResourceObject(Texture);
+    Brush.DrawAs = ESlateBrushDrawType::Image;
+    Brush.Tiling = ESlateBrushTileType::Horizontal;
+    Brush.ImageSize = FVector2D(NumColumns, NumBuckets);
+}
+
+void UHeatmapWidget::FlushToTexture()
+{
+    const int32 NumBuckets = BucketBounds.Num();
+    if (NumBuckets == 0)
+    {
+        return;
+    }
+
+    // 色階取 2 的次方，整張重新上色只在跨過 2 的次方時發生。平常只看有變動的欄 (只會變大)；
+    // 有欄移出視窗時改從所有仍在視窗內的欄重算，尖峰捲出去之後色階會降回來
+    float MaxCount = 0.0f;
+    if (bColorScaleStale)
+    {
+        for (int32 Slot = 0; Slot < NumColumns; ++Slot)
+        {
+            if (SlotColumns[Slot] != INDEX_NONE)
+            {
+                MaxCount = FMath::Max(MaxCount, GetColumnMaxCount(Slot));
+            }
+        }
+    }
+    else
+    {
+        for (TConstSetBitIterator<> It(DirtySlots); It; ++It)
+        {
+            MaxCount = FMath::Max(MaxCount, GetColumnMaxCount(It.GetIndex()));
+        }
+    }
+
+    const float NewScaleMax = MaxCount > 1.0f ? static_cast<float>(FMath::RoundUpToPowerOfTwo(FMath::CeilToInt(MaxCount))) : 1.0f;
+    if (NewScaleMax > ColorScaleMax || (bColorScaleStale && NewScaleMax != ColorScaleMax))
+    {
+        ColorScaleMax = NewScaleMax;
+        bNeedsFullUpload = true;
+    }
+    bColorScaleStale = false;
+
+    if (!Texture || Texture->GetSizeX() != NumColumns || Texture->GetSizeY() != NumBuckets)
+    {
+        RecreateTexture();
+        bNeedsFullUpload = true;
+    }
+    if (!Texture)
+    {
+        return;
+    }
+
+    TArray<int32> Slots;
+    if (bNeedsFullUpload)
+    {
+        for (int32 Slot = 0; Slot < NumColumns; ++Slot)
+        {
+            Slots.Add(Slot);
+        }
+    }
+    else
+    {
+        for (TConstSetBitIterator<> It(DirtySlots); It; ++It)
+        {
+            Slots.Add(It.GetIndex());
+        }
+    }
+    DirtySlots.Init(false, NumColumns);
+    bNeedsFullUpload = false;
+
+    if (Slots.Num() == 0)
+    {
+        return;
+    }
+
+    // 只把變動的欄打包上傳，render thread 用完後釋放
+    const int32 NumSlots = Slots.Num();
+    FColor* Packed = static_cast<FColor*>(FMemory::Malloc(NumSlots * NumBuckets * sizeof(FColor)));
+    FUpdateTextureRegion2D* Regions = new FUpdateTextureRegion2D[NumSlots];
+    for (int32 i = 0; i < NumSlots; ++i)
+    {
+        const int32 Slot = Slots[i];
+        UpdateColumnPixels(Slot);
+        for (int32 Row = 0; Row < NumBuckets; ++Row)
+        {
+            Packed[Row * NumSlots + i] = Pixels[Row * NumColumns + Slot];
+        }
+        Regions[i] = FUpdateTextureRegion2D(Slot, 0, i, 0, 1, NumBuckets);
+    }
+
+    Texture->UpdateTextureRegions(0, NumSlots, Regions, NumSlots * sizeof(FColor), sizeof(FColor), reinterpret_cast<uint8*>(Packed),
+        [](uint8* SrcData, const FUpdateTextureRegion2D* InRegions)
+        {
+            FMemory::Free(SrcData);
+            delete[] InRegions;
+        });
+
+    Invalidate(EInvalidateWidget::Paint);
+}
+
+int32 UHeatmapWidget::NativePaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry,
+    const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements,
+    int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+{
+    using namespace HeatmapLayout;
+
+    PROMETHEUS_QUERY_TRACE_SCOPE(PendingTraceId, FirstPaint);
+
+    Super::NativePaint(Args, AllottedGeometry, MyCullingRect, OutDrawElements,
+        LayerId, InWidgetStyle, bParentEnabled);
+
+    const int32 NumBuckets = BucketBounds.Num();
+    if (!Texture || NumBuckets == 0 || LatestColumn == INDEX_NONE)
+    {
+        return LayerId;
+    }
+
+    const FVector2D Size = AllottedGeometry.GetLocalSize();
+    const FVector2D PlotOrigin(PaddingLeft, PaddingTop);
+    const FVector2D PlotSize(Size.X - PaddingLeft - PaddingRight, Size.Y - PaddingTop - PaddingBottom);
+    if (PlotSize.X <= 0.0f || PlotSize.Y <= 0.0f)
+    {
+        return LayerId;
+    }
+
+    // 最舊的一欄在最新的下一個 slot，UV 從那裡開始繞一圈
+    const float StartU = static_cast<float>(GetSlot(LatestColumn + 1)) / NumColumns;
+    Brush.ImageSize = PlotSize;
+    Brush.SetUVRegion(FBox2f(FVector2f(StartU, 0.0f), FVector2f(StartU + 1.0f, 1.0f)));
+
+    FSlateDrawElement::MakeBox(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(PlotOrigin, PlotSize),
+        &Brush, ESlateDrawEffect::None, FLinearColor::White);
+
+    LayerId++;
+
+    const FSlateFontInfo FontInfo = GetFont();
+
+    // Y 軸: bucket 的 le，太密時跳著標
+    const float RowHeight = PlotSize.Y / NumBuckets;
+    const int32 LabelEvery = FMath::Max(FMath::CeilToInt(MinLabelSpacing / FMath::Max(RowHeight, 0.01f)), 1);
+    for (int32 b = 0; b < NumBuckets; b += LabelEvery)
+    {
+        const float Y = PlotOrigin.Y + (NumBuckets - 1 - b + 0.5f) * RowHeight;
+        FSlateDrawElement::MakeText(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(FVector2D(0, Y - 6), FVector2D(PaddingLeft - 4, 12)),
+            FormatBound(BucketBounds[b]), FontInfo, ESlateDrawEffect::None, FLinearColor::White);
+    }
+
+    // X 軸: 視窗的起點與終點
+    const FTimespan TimeZoneOffset = FDateTime::Now() - FDateTime::UtcNow();
+    const int64 LastTime = static_cast<int64>(static_cast<double>(LatestColumn + 1) * StepSeconds);
+    const int64 FirstTime = static_cast<int64>(static_cast<double>(LatestColumn + 1 - NumColumns) * StepSeconds);
+    const float AxisY = PlotOrigin.Y + PlotSize.Y + 8.0f;
+    FSlateDrawElement::MakeText(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(FVector2D(PlotOrigin.X, AxisY), FVector2D(60, 12)),
+        (FDateTime::FromUnixTimestamp(FirstTime) + TimeZoneOffset).ToString(TEXT("%H:%M:%S")), FontInfo, ESlateDrawEffect::None, FLinearColor::White);
+    FSlateDrawElement::MakeText(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(FVector2D(PlotOrigin.X + PlotSize.X - 50, AxisY), FVector2D(60, 12)),
+        (FDateTime::FromUnixTimestamp(LastTime) + TimeZoneOffset).ToString(TEXT("%H:%M:%S")), FontInfo, ESlateDrawEffect::None, FLinearColor::White);
+
+    // 新資料第一次出現在畫面上
+    if (PendingTraceId != 0)
+    {
+        FPrometheusQueryTrace::End(PendingTraceId);
+        PendingTraceId = 0;
+    }
+
+    return LayerId + 1;
+}
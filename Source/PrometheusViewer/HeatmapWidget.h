@@ -0,0 +1,118 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "Styling/SlateBrush.h"
+#include "PrometheusSeries.h"
+#include "HeatmapWidget.generated.h"
+
+class UTexture2D;
+
+/**
+ * Prometheus histogram (*_bucket) 的熱圖: X 是時間 (每個 step 一欄)，Y 是 le bucket，顏色是該欄落在 bucket 內的次數。
+ * 格子存在 CPU 端的 pixel buffer，對應一張動態 UTexture2D；欄位以環狀方式寫入，
+ * 每次更新只上傳有變動的欄，繪製時以 UV 位移把最舊的一欄接到左邊，整張熱圖只有一個 draw。
+ */
+UCLASS()
+class PROMETHEUSVIEWER_API UHeatmapWidget : public UUserWidget
+{
+    GENERATED_BODY()
+
+public:
+    // 取代整個熱圖 (每個 le 一個 series)
+    UFUNCTION(BlueprintCallable, Category = "Heatmap")
+    void SetSeriesData(const FPrometheusRangeResult& InResult);
+
+    // 增量更新: 只會重畫新 sample 所在的欄
+    UFUNCTION(BlueprintCallable, Category = "Heatmap")
+    void AppendSeriesData(const FPrometheusRangeResult& NewSamples);
+
+    // 每欄的寬度 (秒)，也就是 range query 的 step；改變時清空熱圖
+    UFUNCTION(BlueprintCallable, Category = "Heatmap")
+    void SetBaseStep(float InStepSeconds);
+
+    // 顯示的時間範圍 (秒)，決定欄數
+    UFUNCTION(BlueprintCallable, Category = "Heatmap")
+    void SetWindowSeconds(float InWindowSeconds);
+
+    // true: 值是 _bucket 的累計 counter，每欄取相鄰 sample 的增量；false: 值已經是 rate/increase
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Heatmap")
+    bool bCumulativeCounters = true;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Heatmap")
+    FLinearColor LowColor = FLinearColor(0.05f, 0.05f, 0.35f, 1.0f);
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Heatmap")
+    FLinearColor HighColor = FLinearColor(1.0f, 0.85f, 0.1f, 1.0f);
+
+    // 沒有任何次數的格子
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Heatmap")
+    FLinearColor EmptyColor = FLinearColor(0.0f, 0.0f, 0.0f, 0.25f);
+
+    // 下一次畫出資料時結束這個 query 的追蹤 (FPrometheusQueryTrace)，0 表示沒有
+    void SetPendingTrace(uint32 CorrelationId) { PendingTraceId = CorrelationId; }
+
+    // PromQL 結果是否像 histogram bucket (每個 series 都有 le label)
+    static bool IsHistogramResult(const FPrometheusRangeResult& Result);
+
+protected:
+    virtual int32 NativePaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry,
+        const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements,
+        int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+
+private:
+    // 從 label set 取出 le，+Inf 為無限大；沒有 le 時回傳 false
+    static bool ParseBucketBound(FPrometheusLabelSetHandle LabelSet, double& OutBound);
+
+    void Reset();
+    void IngestSamples(const FPrometheusRangeResult& Result);
+    int32 FindOrAddBucket(FPrometheusLabelSetHandle LabelSet);
+
+    // 欄編號 (時間 / step) 對應到環狀 buffer 的位置
+    int32 GetSlot(int64 Column) const;
+    void AdvanceToColumn(int64 Column);
+    void MarkColumnDirty(int32 Slot);
+
+    // 重新計算 dirty 欄的顏色並上傳；bucket 數或色階改變時整張重建
+    void FlushToTexture();
+    void RecreateTexture();
+    void UpdateColumnPixels(int32 Slot);
+    float GetColumnMaxCount(int32 Slot) const;
+    FColor GetCellColor(float Count) const;
+
+    float StepSeconds = 5.0f;
+    float WindowSeconds = 300.0f;
+    int32 NumColumns = 61;
+
+    // bucket 依 le 由小到大；同一個 le 的多個 series (例如多個 instance) 加總
+    TArray<double> BucketBounds;
+    TMap<FPrometheusLabelSetHandle, int32> SeriesToBucket;
+
+    // 每個 series 上一筆累計值與時間，用來算增量
+    TMap<FPrometheusLabelSetHandle, FVector2D> LastRawSamples;
+
+    // [Slot * NumBuckets + Bucket] 該欄各 bucket 的累計 (le 以下) 次數
+    TArray<float> CumulativeCells;
+    TArray<int64> SlotColumns;
+    int64 LatestColumn = INDEX_NONE;
+
+    // 色階上限取 2 的次方，改變時才需要整張重新上色
+    float ColorScaleMax = 1.0f;
+
+    // 有欄被移出視窗，色階要從目前的欄重新計算 (可能變小)
+    bool bColorScaleStale = false;
+
+    TBitArray<> DirtySlots;
+    bool bNeedsFullUpload = true;
+
+    // 列是 bucket (最大的在最上面)，欄是 slot；BGRA
+    TArray<FColor> Pixels;
+
+    UPROPERTY(Transient)
+    TObjectPtr<UTexture2D> Texture;
+
+    // UVRegion 隨最新欄位移，需要在 paint 時更新
+    mutable FSlateBrush Brush;
+
+    mutable uint32 PendingTraceId = 0;
+};
@@ -1,14 +1,25 @@
-
 #include "LineChartWidget.h"
 #include "SlateBasics.h"
 #include "SlateCore.h"
 #include "Rendering/DrawElements.h"
 #include "Math/UnrealMathUtility.h"
+#include "Algo/BinarySearch.h"
+#include "PrometheusViewerStats.h"
+#include "PrometheusQueryTrace.h"
 
 
 void ULineChartWidget::SetChartData(const TArray<FVector2D>& InDataPoints)
 {
-    DataPoints = InDataPoints;
+    DataSeries.Reset();
+    RequestedTiles.Reset();
+
+    FChartSeriesBuffer& Series = AddSeries();
+    for (const FVector2D& Point : InDataPoints)
+    {
+        Series.Push(Point.X, Point.Y);
+    }
+    ++DataGeneration;
+    UpdatePointStats();
 
     // 強制重新繪製
     if (IsInViewport())
@@ -17,87 +28,592 @@ void ULineChartWidget::SetChartData(const TArray<FVector2D>& InDataPoints)
     }
 }
 
-void ULineChartWidget::AddDataPoint(float X, float Y)
+void ULineChartWidget::SetSeriesData(const FPrometheusRangeResult& InResult)
 {
+    // 完整結果 (快取暖啟動、落後後重抓、其他訂閱者的查詢) 只取代即時視窗:
+    // 依 label set 對應到既有的 series，History / LOD 與已抓回的歷史區塊都保留
+    TBitArray<> Replaced(false, DataSeries.Num());
+    for (const FPrometheusSeries& Source : InResult.Series)
+    {
+        int32 SeriesIndex = FindSeriesIndex(Source.LabelSet);
+        if (SeriesIndex == INDEX_NONE)
+        {
+            SeriesIndex = DataSeries.Num();
+            AddSeries().LabelSet = Source.LabelSet;
+            Replaced.Add(false);
+        }
+
+        // 環狀 buffer 只留最新的 MaxPoints 個點，較舊的點仍會進入壓縮歷史
+        DataSeries[SeriesIndex].ReplaceLive(Source);
+        Replaced[SeriesIndex] = true;
+    }
+
+    // 這次結果沒有的 series 不在即時視窗內，只留歷史；沒有歷史的直接移除
+    for (int32 SeriesIndex = DataSeries.Num() - 1; SeriesIndex >= 0; --SeriesIndex)
+    {
+        if (!Replaced[SeriesIndex])
+        {
+            DataSeries[SeriesIndex].ResetLive();
+            if (DataSeries[SeriesIndex].History.IsEmpty())
+            {
+                DataSeries.RemoveAt(SeriesIndex);
+            }
+        }
+    }
+    TrimToWindow();
 
-    if (DataPoints.Num() > 0 && X <= DataPoints.Last().X)
+    // 強制重新繪製
+    if (IsInViewport())
+    {
+        Invalidate(EInvalidateWidget::LayoutAndVolatility);
+    }
+}
+
+void ULineChartWidget::ClearData()
+{
+    DataSeries.Reset();
+    RequestedTiles.Reset();
+    ++DataGeneration;
+    UpdatePointStats();
+
+    Invalidate(EInvalidateWidget::LayoutAndVolatility);
+}
+
+void ULineChartWidget::SetMaxPoints(int32 InMaxPoints)
+{
+    MaxPoints = FMath::Max(InMaxPoints, 2);
+    for (FChartSeriesBuffer& Series : DataSeries)
+    {
+        Series.SetCapacity(MaxPoints);
+    }
+    ++DataGeneration;
+    UpdatePointStats();
+}
+
+void ULineChartWidget::AddDataPoint(double X, float Y)
+{
+    FChartSeriesBuffer& Series = DataSeries.Num() > 0 ? DataSeries[0] : AddSeries();
+
+    if (!Series.IsEmpty() && X <= Series.LastTime())
     {
         // 避免時間倒退，直接丟棄
         return;
     }
-    DataPoints.Add(FVector2D(X, Y));
-
-    // 定義要保留的時間範圍 (例如最近 300 秒)
-    const float WindowSeconds = 300.0f;
+    Series.Push(X, Y);
 
     // 只保留在時間範圍內的點
-    float CurrentTime = X;
-    while (DataPoints.Num() > 0 && DataPoints[0].X < CurrentTime - WindowSeconds)
+    TrimToWindow();
+
+    // 觸發重繪
+    Invalidate(EInvalidateWidget::LayoutAndVolatility);
+}
+
+void ULineChartWidget::AppendDataPoints(const TArray<FVector2D>& NewPoints)
+{
+    FChartSeriesBuffer& Series = DataSeries.Num() > 0 ? DataSeries[0] : AddSeries();
+    for (const FVector2D& Point : NewPoints)
     {
-        DataPoints.RemoveAt(0);
+        if (!Series.IsEmpty() && Point.X <= Series.LastTime())
+        {
+            // 避免時間倒退，直接丟棄
+            continue;
+        }
+        Series.Push(Point.X, Point.Y);
     }
+    TrimToWindow();
 
-    // 觸發重繪
     Invalidate(EInvalidateWidget::LayoutAndVolatility);
 }
 
+void ULineChartWidget::AppendSeriesData(const FPrometheusRangeResult& NewSamples)
+{
+    for (const FPrometheusSeries& Source : NewSamples.Series)
+    {
+        AppendSamples(FindOrAddSeries(Source.LabelSet), Source);
+    }
+    TrimToWindow();
+
+    Invalidate(EInvalidateWidget::LayoutAndVolatility);
+}
+
+void ULineChartWidget::AppendSamples(FChartSeriesBuffer& Target, const FPrometheusSeries& Source)
+{
+    for (int32 i = 0; i < Source.Num(); ++i)
+    {
+        if (!Target.IsEmpty() && Source.Timestamps[i] <= Target.LastTime())
+        {
+            // 避免時間倒退，直接丟棄
+            continue;
+        }
+        Target.Push(Source.Timestamps[i], Source.Values[i]);
+    }
+}
+
+int32 ULineChartWidget::FindSeriesIndex(FPrometheusLabelSetHandle LabelSet) const
+{
+    return DataSeries.IndexOfByPredicate([LabelSet](const FChartSeriesBuffer& Series)
+    {
+        return Series.LabelSet == LabelSet;
+    });
+}
+
+FChartSeriesBuffer& ULineChartWidget::FindOrAddSeries(FPrometheusLabelSetHandle LabelSet)
+{
+    const int32 SeriesIndex = FindSeriesIndex(LabelSet);
+    if (SeriesIndex != INDEX_NONE)
+    {
+        return DataSeries[SeriesIndex];
+    }
+
+    FChartSeriesBuffer& NewSeries = AddSeries();
+    NewSeries.LabelSet = LabelSet;
+    return NewSeries;
+}
+
+FChartSeriesBuffer& ULineChartWidget::AddSeries()
+{
+    FChartSeriesBuffer& Series = DataSeries.Emplace_GetRef(MaxPoints);
+    Series.Lod.SetBaseStep(FCompactTimeSeries::ToMilliseconds(BaseStepSeconds));
+    return Series;
+}
+
+void ULineChartWidget::SetBaseStep(float InStepSeconds)
+{
+    const float NewStepSeconds = FMath::Max(InStepSeconds, 0.001f);
+    if (FCompactTimeSeries::ToMilliseconds(NewStepSeconds) == FCompactTimeSeries::ToMilliseconds(BaseStepSeconds))
+    {
+        return;
+    }
+
+    BaseStepSeconds = NewStepSeconds;
+    for (FChartSeriesBuffer& Series : DataSeries)
+    {
+        // 原本的 bucket 無法沿用，從 History 重建
+        Series.SetBaseStep(FCompactTimeSeries::ToMilliseconds(BaseStepSeconds));
+    }
+
+    // 區塊編號依 bucket 寬度計算，換了 step 要重新判斷缺少哪些區塊
+    RequestedTiles.Reset();
+    ++DataGeneration;
+}
+
+void ULineChartWidget::MergeTileData(const FPrometheusRangeResult& Result, float StepSeconds)
+{
+    const int32 Level = FChartLodPyramid::ChooseLevel(FCompactTimeSeries::ToMilliseconds(BaseStepSeconds), FCompactTimeSeries::ToMilliseconds(StepSeconds));
+    for (const FPrometheusSeries& Source : Result.Series)
+    {
+        FindOrAddSeries(Source.LabelSet).MergeHistory(Source, Level);
+    }
+    ++DataGeneration;
+    UpdatePointStats();
+
+    Invalidate(EInvalidateWidget::Paint);
+}
+
+void ULineChartWidget::TrimToWindow()
+{
+    double LatestTime = 0.0;
+    for (const FChartSeriesBuffer& Series : DataSeries)
+    {
+        if (!Series.IsEmpty())
+        {
+            LatestTime = FMath::Max(LatestTime, Series.LastTime());
+        }
+    }
+
+    // 環狀 buffer 從頭移除過期的點是 O(1)
+    const double Cutoff = LatestTime - WindowSeconds;
+    const int64 HistoryCutoffMs = FCompactTimeSeries::ToMilliseconds(LatestTime - HistorySeconds);
+    for (FChartSeriesBuffer& Series : DataSeries)
+    {
+        Series.EvictOlderThan(Cutoff);
+        if (HistorySeconds > 0.0f)
+        {
+            Series.History.EvictBefore(HistoryCutoffMs);
+            Series.Lod.EvictBefore(HistoryCutoffMs);
+        }
+        else
+        {
+            Series.History.Reset();
+            Series.Lod.Reset();
+        }
+    }
+
+    // 所有新增資料的路徑最後都會經過這裡
+    ++DataGeneration;
+    UpdatePointStats();
+}
+
+void ULineChartWidget::UpdatePointStats()
+{
+    int64 Points = 0;
+    for (const FChartSeriesBuffer& Series : DataSeries)
+    {
+        Points += Series.Num() + Series.History.Num();
+    }
+    FPrometheusViewerStats::Get().AddChartPoints(Points - ReportedPoints);
+    ReportedPoints = Points;
+}
+
+void ULineChartWidget::BeginDestroy()
+{
+    FPrometheusViewerStats::Get().AddChartPoints(-ReportedPoints);
+    ReportedPoints = 0;
+
+    Super::BeginDestroy();
+}
+
+int64 ULineChartWidget::GetHistoryAllocatedSize() const
+{
+    int64 Size = 0;
+    for (const FChartSeriesBuffer& Series : DataSeries)
+    {
+        Size += Series.History.GetAllocatedSize();
+    }
+    return Size;
+}
+
+void ULineChartWidget::UpdateDecimationCache(int32 PlotWidth, double ViewStart, double ViewEnd) const
+{
+    if (DecimatedGeneration == DataGeneration && DecimatedPlotWidth == PlotWidth && DecimatedSeries.Num() == DataSeries.Num())
+    {
+        return;
+    }
+
+    DecimatedSeries.SetNum(DataSeries.Num());
+    for (int32 SeriesIndex = 0; SeriesIndex < DataSeries.Num(); ++SeriesIndex)
+    {
+        BuildViewPoints(DataSeries[SeriesIndex], ViewStart, ViewEnd, PlotWidth, DecimatedSeries[SeriesIndex]);
+    }
+
+    DecimatedGeneration = DataGeneration;
+    DecimatedPlotWidth = PlotWidth;
+}
+
+void ULineChartWidget::BuildViewPoints(const FChartSeriesBuffer& Series, double ViewStart, double ViewEnd, int32 PlotWidth, TArray<FVector2D>& OutPoints) const
+{
+    OutPoints.Reset();
+
+    const int64 StartMs = FCompactTimeSeries::ToMilliseconds(ViewStart);
+    const int64 EndMs = FCompactTimeSeries::ToMilliseconds(ViewEnd);
+    const int32 Level = FChartLodPyramid::ChooseLevel(Series.Lod.GetBaseStepMs(), (EndMs - StartMs) / FMath::Max(PlotWidth, 1));
+
+    if (Level == 0)
+    {
+        if (!Series.IsEmpty() && ViewStart >= Series.FirstTime())
+        {
+            // 即時視窗內: 直接從環狀 buffer 降採樣 (包含剛好在 ViewEnd 的最新點)
+            int32 EndIndex = Series.LowerBound(ViewEnd);
+            if (EndIndex < Series.Num() && Series.GetTime(EndIndex) <= ViewEnd)
+            {
+                ++EndIndex;
+            }
+            FChartDecimation::MinMax(Series, Series.LowerBound(ViewStart), EndIndex, ViewStart, PlotWidth, OutPoints);
+        }
+        else
+        {
+            // 每個像素最多一個原始 step，點數有上限
+            Series.History.ForEachInRange(StartMs, EndMs, [&OutPoints, StartMs](int64 TimeMs, double Value)
+            {
+                OutPoints.Emplace((TimeMs - StartMs) / 1000.0, Value);
+            });
+        }
+        return;
+    }
+
+    // bucket 的 min/max 依時間順序輸出，尖峰不會因為縮小而消失
+    const int64 Width = Series.Lod.GetBucketWidthMs(Level);
+    Series.Lod.ForEachBucket(Level, StartMs, EndMs, [&OutPoints, StartMs, EndMs, Width](const FChartLodBucket& Bucket)
+    {
+        const int64 BucketStartMs = Bucket.Index * Width;
+        const bool bMinFirst = Bucket.MinOffsetMs <= Bucket.MaxOffsetMs;
+        const int64 FirstMs = BucketStartMs + (bMinFirst ? Bucket.MinOffsetMs : Bucket.MaxOffsetMs);
+        const int64 SecondMs = BucketStartMs + (bMinFirst ? Bucket.MaxOffsetMs : Bucket.MinOffsetMs);
+
+        if (FirstMs >= StartMs && FirstMs <= EndMs)
+        {
+            OutPoints.Emplace((FirstMs - StartMs) / 1000.0, bMinFirst ? Bucket.Min : Bucket.Max);
+        }
+        if (SecondMs != FirstMs && SecondMs >= StartMs && SecondMs <= EndMs)
+        {
+            OutPoints.Emplace((SecondMs - StartMs) / 1000.0, bMinFirst ? Bucket.Max : Bucket.Min);
+        }
+    });
+}
+
+FLinearColor ULineChartWidget::GetSeriesColor(int32 SeriesIndex) const
+{
+    if (SeriesColors.Num() > 0)
+    {
+        return SeriesColors[SeriesIndex % SeriesColors.Num()];
+    }
+
+    static const FLinearColor DefaultColors[] =
+    {
+        FLinearColor::Green,
+        FLinearColor(0.2f, 0.6f, 1.0f),
+        FLinearColor(1.0f, 0.5f, 0.1f),
+        FLinearColor(0.9f, 0.3f, 0.9f),
+        FLinearColor(1.0f, 0.9f, 0.2f),
+        FLinearColor(0.3f, 0.9f, 0.9f),
+        FLinearColor(1.0f, 0.3f, 0.3f),
+        FLinearColor(0.7f, 0.7f, 0.7f),
+    };
+    return DefaultColors[SeriesIndex % UE_ARRAY_COUNT(DefaultColors)];
+}
+
 FReply ULineChartWidget::NativeOnMouseMove(const FGeometry& InGeometry, const FPointerEvent& InMouseEvent)
 {
     bMouseHovered = true;
     CachedMousePosition = InGeometry.AbsoluteToLocal(InMouseEvent.GetScreenSpacePosition());
-    Invalidate(EInvalidateWidget::LayoutAndVolatility);
+
+    if (bDragging && RenderCache.PlotSize.X > 0.0f)
+    {
+        // 往右拖曳看較舊的資料
+        double ViewStart, ViewEnd;
+        GetViewRange(ViewStart, ViewEnd);
+        const double Span = ViewEnd - ViewStart;
+        SetView(DragStartViewEnd - (CachedMousePosition.X - DragStartX) / RenderCache.PlotSize.X * Span, Span);
+        return FReply::Handled();
+    }
+
+    // 只需要重畫 overlay，圖表本身的幾何已快取
+    Invalidate(EInvalidateWidget::Paint);
     return FReply::Handled();
 }
 
 void ULineChartWidget::NativeOnMouseLeave(const FPointerEvent& InMouseEvent)
 {
     bMouseHovered = false;
-    Invalidate(EInvalidateWidget::LayoutAndVolatility);
+    Invalidate(EInvalidateWidget::Paint);
 }
 
-int32 ULineChartWidget::NativePaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry,
-    const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements,
-    int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+FReply ULineChartWidget::NativeOnMouseWheel(const FGeometry& InGeometry, const FPointerEvent& InMouseEvent)
 {
-    Super::NativePaint(Args, AllottedGeometry, MyCullingRect, OutDrawElements,
-        LayerId, InWidgetStyle, bParentEnabled);
+    if (!RenderCache.bHasData || RenderCache.PlotSize.X <= 0.0f)
+    {
+        return FReply::Unhandled();
+    }
 
-    if (DataPoints.Num() < 2)
+    double ViewStart, ViewEnd;
+    GetViewRange(ViewStart, ViewEnd);
+
+    // 以滑鼠所在的時間為中心縮放；跟隨最新資料時固定右邊界
+    const FVector2D LocalPosition = InGeometry.AbsoluteToLocal(InMouseEvent.GetScreenSpacePosition());
+    const double Alpha = bFollowLatest ? 1.0 : FMath::Clamp((LocalPosition.X - RenderCache.PlotOrigin.X) / RenderCache.PlotSize.X, 0.0, 1.0);
+    const double AnchorTime = FMath::Lerp(ViewStart, ViewEnd, Alpha);
+
+    const double ZoomFactor = InMouseEvent.GetWheelDelta() > 0.0f ? 0.8 : 1.25;
+    const double NewSpan = ClampViewSpan((ViewEnd - ViewStart) * ZoomFactor);
+    SetView(AnchorTime + (1.0 - Alpha) * NewSpan, NewSpan);
+    return FReply::Handled();
+}
+
+FReply ULineChartWidget::NativeOnMouseButtonDown(const FGeometry& InGeometry, const FPointerEvent& InMouseEvent)
+{
+    if (InMouseEvent.GetEffectingButton() != EKeys::LeftMouseButton || !RenderCache.bHasData)
     {
-        return LayerId;
+        return FReply::Unhandled();
     }
 
-    const FVector2D Size = AllottedGeometry.GetLocalSize();
+    double ViewStart;
+    GetViewRange(ViewStart, DragStartViewEnd);
+    DragStartX = InGeometry.AbsoluteToLocal(InMouseEvent.GetScreenSpacePosition()).X;
+    bDragging = true;
+    return FReply::Handled().CaptureMouse(TakeWidget());
+}
+
+FReply ULineChartWidget::NativeOnMouseButtonUp(const FGeometry& InGeometry, const FPointerEvent& InMouseEvent)
+{
+    if (InMouseEvent.GetEffectingButton() != EKeys::LeftMouseButton || !bDragging)
+    {
+        return FReply::Unhandled();
+    }
+
+    bDragging = false;
+    return FReply::Handled().ReleaseMouseCapture();
+}
 
+FReply ULineChartWidget::NativeOnMouseButtonDoubleClick(const FGeometry& InGeometry, const FPointerEvent& InMouseEvent)
+{
+    ResetView();
+    return FReply::Handled();
+}
+
+double ULineChartWidget::GetLatestTime() const
+{
+    double LatestTime = 0.0;
+    for (const FChartSeriesBuffer& Series : DataSeries)
+    {
+        if (!Series.IsEmpty())
+        {
+            LatestTime = FMath::Max(LatestTime, Series.LastTime());
+        }
+    }
+    return LatestTime;
+}
+
+void ULineChartWidget::GetViewRange(double& OutViewStart, double& OutViewEnd) const
+{
+    OutViewEnd = bFollowLatest ? GetLatestTime() : ViewEndTime;
+    OutViewStart = OutViewEnd - (ViewSpanSeconds > 0.0 ? ViewSpanSeconds : WindowSeconds);
+}
+
+double ULineChartWidget::ClampViewSpan(double InViewSpan) const
+{
+    // 最細約 10 個原始 step，最寬不超過保留的歷史
+    const double MinSpan = BaseStepSeconds * 10.0;
+    const double MaxSpan = FMath::Max<double>(FMath::Max(HistorySeconds, WindowSeconds), MinSpan);
+    return FMath::Clamp(InViewSpan, MinSpan, MaxSpan);
+}
+
+void ULineChartWidget::SetView(double InViewEnd, double InViewSpan)
+{
+    ViewSpanSeconds = ClampViewSpan(InViewSpan);
+
+    // 不能超過最新的資料，也不能拖到保留的歷史之外
+    const double LatestTime = GetLatestTime();
+    const double OldestEnd = LatestTime - ClampViewSpan(TNumericLimits<double>::Max()) + ViewSpanSeconds;
+    InViewEnd = FMath::Max(InViewEnd, OldestEnd);
+
+    bFollowLatest = InViewEnd >= LatestTime;
+    ViewEndTime = bFollowLatest ? LatestTime : InViewEnd;
+
+    // 檢視範圍也是快取的 key，沿用資料的 generation
+    ++DataGeneration;
+    RequestMissingTiles();
+
+    Invalidate(EInvalidateWidget::Paint);
+}
+
+void ULineChartWidget::ResetView()
+{
+    bFollowLatest = true;
+    ViewSpanSeconds = 0.0;
+    ++DataGeneration;
+
+    Invalidate(EInvalidateWidget::Paint);
+}
+
+void ULineChartWidget::RequestMissingTiles()
+{
+    if (!OnTileRequested.IsBound() || DataSeries.Num() == 0)
+    {
+        return;
+    }
+
+    // 即時資料開始之後的部分由一般的查詢負責
+    int64 LiveStartMs = MAX_int64;
+    for (const FChartSeriesBuffer& Series : DataSeries)
+    {
+        LiveStartMs = FMath::Min(LiveStartMs, Series.LiveStartMs);
+    }
+
+    double ViewStart, ViewEnd;
+    GetViewRange(ViewStart, ViewEnd);
+    const int64 StartMs = FCompactTimeSeries::ToMilliseconds(ViewStart);
+    const int64 EndMs = FMath::Min(FCompactTimeSeries::ToMilliseconds(ViewEnd), LiveStartMs);
+    if (StartMs >= EndMs)
+    {
+        return;
+    }
+
+    // 與繪圖相同的層級選擇，抓回來的 step 剛好對應一個 bucket
+    const int32 PlotWidth = FMath::Max(FMath::FloorToInt(RenderCache.PlotSize.X), 1);
+    const int64 BaseStepMs = FCompactTimeSeries::ToMilliseconds(BaseStepSeconds);
+    const int32 Level = FChartLodPyramid::ChooseLevel(BaseStepMs, FCompactTimeSeries::ToMilliseconds(ViewEnd - ViewStart) / PlotWidth);
+    const int64 StepMs = FChartLodPyramid::GetBucketWidthMs(BaseStepMs, Level);
+    const int64 TileSpanMs = StepMs * TileBuckets;
+
+    for (int64 Tile = StartMs / TileSpanMs; Tile * TileSpanMs < EndMs; ++Tile)
+    {
+        const uint64 TileKey = (static_cast<uint64>(Level) << 56) | (static_cast<uint64>(Tile) & ((uint64(1) << 56) - 1));
+        if (RequestedTiles.Contains(TileKey))
+        {
+            continue;
+        }
+        RequestedTiles.Add(TileKey);
+
+        const int64 TileStartMs = Tile * TileSpanMs;
+        OnTileRequested.Broadcast(TileStartMs / 1000.0, (TileStartMs + TileSpanMs - StepMs) / 1000.0, StepMs / 1000.0f);
+    }
+}
+
+namespace LineChartLayout
+{
     // Padding
-    const float PaddingLeft = 50.0f;
-    const float PaddingRight = 10.0f;
-    const float PaddingTop = 10.0f;
-    const float PaddingBottom = 30.0f;
+    static const float PaddingLeft = 50.0f;
+    static const float PaddingRight = 10.0f;
+    static const float PaddingTop = 10.0f;
+    static const float PaddingBottom = 30.0f;
+
+    static const int32 NumXTicks = 5;
+    static const int32 NumYTicks = 5;
+
+    static FSlateFontInfo GetFont()
+    {
+        FSlateFontInfo FontInfo = FCoreStyle::Get().GetFontStyle("NormalFont");
+        FontInfo.Size = 10;
+        return FontInfo;
+    }
+}
+
+void ULineChartWidget::UpdateRenderCache(const FVector2D& Size) const
+{
+    using namespace LineChartLayout;
+
+    if (RenderCache.Generation == DataGeneration && RenderCache.Size == Size)
+    {
+        return;
+    }
+
+    RenderCache.Generation = DataGeneration;
+    RenderCache.Size = Size;
+    RenderCache.bHasData = false;
+    RenderCache.ScreenSeries.Reset();
+    RenderCache.XTickLabels.Reset();
+    RenderCache.YTickLabels.Reset();
+
+    int32 TotalPoints = 0;
+    for (const FChartSeriesBuffer& Series : DataSeries)
+    {
+        TotalPoints += FMath::Max(Series.Num(), Series.History.Num());
+    }
+
+    if (TotalPoints < 2)
+    {
+        return;
+    }
 
     const FVector2D PlotOrigin(PaddingLeft, PaddingTop);
     const FVector2D PlotSize(Size.X - PaddingLeft - PaddingRight, Size.Y - PaddingTop - PaddingBottom);
 
-    // Step 1: 將 X 軸轉換為相對時間（避免 float 精度問題）
-    TArray<FVector2D> RelativeDataPoints = DataPoints;
-    float BaseTime = DataPoints[0].X;
-    for (FVector2D& Point : RelativeDataPoints)
+    // Step 1: 依檢視範圍與繪圖寬度挑選解析度 (每像素約 2 點)，X 軸使用相對於 ViewStart 的時間（避免 float 精度問題）
+    double ViewStart, ViewEnd;
+    GetViewRange(ViewStart, ViewEnd);
+    const double BaseTime = ViewStart;
+    UpdateDecimationCache(FMath::Max(FMath::FloorToInt(PlotSize.X), 1), ViewStart, ViewEnd);
+
+    // Step 2: X 是檢視範圍，Y 是範圍內所有 series 的資料範圍 (min/max 保留了極值)
+    float MinX = 0.0f;
+    float MaxX = static_cast<float>(ViewEnd - ViewStart);
+    float MinY = FLT_MAX;
+    float MaxY = -FLT_MAX;
+
+    for (const TArray<FVector2D>& Points : DecimatedSeries)
     {
-        Point.X -= BaseTime;
+        for (const FVector2D& Point : Points)
+        {
+            MinY = FMath::Min(MinY, static_cast<float>(Point.Y));
+            MaxY = FMath::Max(MaxY, static_cast<float>(Point.Y));
+        }
     }
 
-    // Step 2: 計算資料範圍
-    float MinX = RelativeDataPoints[0].X;
-    float MaxX = RelativeDataPoints[0].X;
-    float MinY = RelativeDataPoints[0].Y;
-    float MaxY = RelativeDataPoints[0].Y;
-
-    for (const FVector2D& Point : RelativeDataPoints)
+    if (MinY > MaxY)
     {
-        MinX = FMath::Min(MinX, Point.X);
-        MaxX = FMath::Max(MaxX, Point.X);
-        MinY = FMath::Min(MinY, Point.Y);
-        MaxY = FMath::Max(MaxY, Point.Y);
+        // 範圍內還沒有資料 (等待補抓)
+        MinY = 0.0f;
+        MaxY = 1.0f;
     }
 
     float RangeX = FMath::Max(MaxX - MinX, 1.0f);
@@ -117,23 +633,19 @@ int32 ULineChartWidget::NativePaint(const FPaintArgs& Args, const FGeometry& All
         MaxY += 0.5f;
     }
 
-    // 畫 XY 軸
-    FVector2D Origin(PaddingLeft, Size.Y - PaddingBottom);
-    FVector2D XAxisEnd(Size.X - PaddingRight, Size.Y - PaddingBottom);
-    FVector2D YAxisEnd(PaddingLeft, PaddingTop);
-
-    FSlateDrawElement::MakeLines(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(),
-        { Origin, XAxisEnd }, ESlateDrawEffect::None, FLinearColor::White, true, 1.0f);
-    FSlateDrawElement::MakeLines(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(),
-        { Origin, YAxisEnd }, ESlateDrawEffect::None, FLinearColor::White, true, 1.0f);
-
-    FSlateFontInfo FontInfo = FCoreStyle::Get().GetFontStyle("NormalFont");
-    FontInfo.Size = 10;
-
-    // 畫 X 軸刻度
-    const int32 NumXTicks = 5;
+    RenderCache.bHasData = true;
+    RenderCache.BaseTime = BaseTime;
+    RenderCache.MinX = MinX;
+    RenderCache.MinY = MinY;
+    RenderCache.RangeX = RangeX;
+    RenderCache.RangeY = RangeY;
+    RenderCache.PlotOrigin = PlotOrigin;
+    RenderCache.PlotSize = PlotSize;
+    RenderCache.TimeZoneOffset = FDateTime::Now() - FDateTime::UtcNow();
+
+    // X 軸刻度
+    const float AxisY = Size.Y - PaddingBottom;
     TSet<FString> SeenLabels;
-
     for (int32 i = 0; i <= NumXTicks; ++i)
     {
         float Alpha = static_cast<float>(i) / NumXTicks;
@@ -142,124 +654,264 @@ int32 ULineChartWidget::NativePaint(const FPaintArgs& Args, const FGeometry& All
 
         // 反推回原始時間
         int64 OriginalUnix = static_cast<int64>(FMath::RoundHalfToZero(RelativeValue + BaseTime));
-        FDateTime UtcDateTime = FDateTime::FromUnixTimestamp(OriginalUnix);
-        FTimespan TimeZoneOffset = FDateTime::Now() - FDateTime::UtcNow();
-        FDateTime LocalDateTime = UtcDateTime + TimeZoneOffset;
+        FDateTime LocalDateTime = FDateTime::FromUnixTimestamp(OriginalUnix) + RenderCache.TimeZoneOffset;
         FString Label = LocalDateTime.ToString(TEXT("%H:%M:%S"));
 
         if (SeenLabels.Contains(Label))
             continue;
         SeenLabels.Add(Label);
 
-        FVector2D Start(X, Origin.Y);
-        FVector2D End(X, Origin.Y + 5.0f);
-        FSlateDrawElement::MakeLines(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(),
-            { Start, End }, ESlateDrawEffect::None, FLinearColor::White, true, 1.0f);
-
-        FVector2D TextPos(X - 20, Origin.Y + 8);
-        FSlateDrawElement::MakeText(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(TextPos, FVector2D(40, 12)),
-            FText::FromString(Label), FontInfo, ESlateDrawEffect::None, FLinearColor::White);
+        RenderCache.XTickLabels.Add({ FVector2D(X, AxisY), FText::FromString(Label) });
     }
 
-    // 畫 Y 軸刻度
-    const int32 NumYTicks = 5;
+    // Y 軸刻度
     for (int32 i = 0; i <= NumYTicks; ++i)
     {
         float Alpha = static_cast<float>(i) / NumYTicks;
         float Y = PlotOrigin.Y + (1 - Alpha) * PlotSize.Y;
         float Value = FMath::Lerp(MinY, MaxY, Alpha);
 
-        FVector2D Start(Origin.X - 5, Y);
-        FVector2D End(Origin.X, Y);
-        FSlateDrawElement::MakeLines(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(),
-            { Start, End }, ESlateDrawEffect::None, FLinearColor::White, true, 1.0f);
-
-        FString Label = FString::Printf(TEXT("%.1f"), Value);
-        FSlateDrawElement::MakeText(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(FVector2D(0, Y - 6), FVector2D(40, 12)),
-            FText::FromString(Label), FontInfo, ESlateDrawEffect::None, FLinearColor::White);
+        RenderCache.YTickLabels.Add({ FVector2D(PaddingLeft, Y), FText::FromString(FString::Printf(TEXT("%.1f"), Value)) });
     }
 
-    LayerId++;
+    // 投影後的折線: 投影、clamp 與重複 X 過濾在同一個迴圈完成
+    const float PlotMinX = PlotOrigin.X;
+    const float PlotMaxX = PlotOrigin.X + PlotSize.X;
+    const float PlotMinY = PlotOrigin.Y;
+    const float PlotMaxY = PlotOrigin.Y + PlotSize.Y;
 
-    // 畫折線
-    for (int32 i = 0; i < RelativeDataPoints.Num() - 1; ++i)
+    RenderCache.ScreenSeries.SetNum(DecimatedSeries.Num());
+    for (int32 SeriesIndex = 0; SeriesIndex < DecimatedSeries.Num(); ++SeriesIndex)
     {
-        const FVector2D& P0 = RelativeDataPoints[i];
-        const FVector2D& P1 = RelativeDataPoints[i + 1];
+        const TArray<FVector2D>& Points = DecimatedSeries[SeriesIndex];
+        TArray<FVector2D>& LinePoints = RenderCache.ScreenSeries[SeriesIndex];
+        LinePoints.Reserve(Points.Num());
 
-        // 檢查是否重複點（避免垂直線）
-        if (FMath::IsNearlyEqual(P0.X, P1.X, KINDA_SMALL_NUMBER))
+        double PrevX = -DBL_MAX;
+        for (const FVector2D& Point : Points)
         {
-            continue;
+            // 檢查是否重複點（避免垂直線）
+            if (FMath::IsNearlyEqual(Point.X, PrevX, KINDA_SMALL_NUMBER))
+            {
+                continue;
+            }
+            PrevX = Point.X;
+
+            FVector2D Canvas;
+            Canvas.X = FMath::Clamp(PlotOrigin.X + ((Point.X - MinX) / RangeX) * PlotSize.X, PlotMinX, PlotMaxX);
+            Canvas.Y = FMath::Clamp(PlotOrigin.Y + (1.0f - (Point.Y - MinY) / RangeY) * PlotSize.Y, PlotMinY, PlotMaxY);
+            LinePoints.Add(Canvas);
         }
+    }
+}
+
+int32 ULineChartWidget::NativePaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry,
+    const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements,
+    int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+{
+    using namespace LineChartLayout;
+
+    SCOPE_CYCLE_COUNTER(STAT_PrometheusViewer_ChartPaint);
+    FPrometheusViewerScopeTimer PaintTimer(FPrometheusViewerStats::Get().ChartPaintTime);
+    PROMETHEUS_QUERY_TRACE_SCOPE(PendingTraceId, FirstPaint);
+
+    Super::NativePaint(Args, AllottedGeometry, MyCullingRect, OutDrawElements,
+        LayerId, InWidgetStyle, bParentEnabled);
+
+    // 只有資料或尺寸改變時才重建投影點與刻度文字
+    UpdateRenderCache(AllottedGeometry.GetLocalSize());
+    if (!RenderCache.bHasData)
+    {
+        return LayerId;
+    }
+
+    const FVector2D& Size = RenderCache.Size;
+    const FPaintGeometry PaintGeometry = AllottedGeometry.ToPaintGeometry();
+
+    // 畫 XY 軸
+    FVector2D Origin(PaddingLeft, Size.Y - PaddingBottom);
+    FVector2D XAxisEnd(Size.X - PaddingRight, Size.Y - PaddingBottom);
+    FVector2D YAxisEnd(PaddingLeft, PaddingTop);
 
-        FVector2D Start;
-        Start.X = PlotOrigin.X + ((P0.X - MinX) / RangeX) * PlotSize.X;
-        Start.Y = PlotOrigin.Y + (1.0f - (P0.Y - MinY) / RangeY) * PlotSize.Y;
+    FSlateDrawElement::MakeLines(OutDrawElements, LayerId, PaintGeometry,
+        { Origin, XAxisEnd }, ESlateDrawEffect::None, FLinearColor::White, true, 1.0f);
+    FSlateDrawElement::MakeLines(OutDrawElements, LayerId, PaintGeometry,
+        { Origin, YAxisEnd }, ESlateDrawEffect::None, FLinearColor::White, true, 1.0f);
 
-        FVector2D End;
-        End.X = PlotOrigin.X + ((P1.X - MinX) / RangeX) * PlotSize.X;
-        End.Y = PlotOrigin.Y + (1.0f - (P1.Y - MinY) / RangeY) * PlotSize.Y;
+    const FSlateFontInfo FontInfo = GetFont();
 
-        Start.X = FMath::Clamp(Start.X, PlotOrigin.X, PlotOrigin.X + PlotSize.X);
-        Start.Y = FMath::Clamp(Start.Y, PlotOrigin.Y, PlotOrigin.Y + PlotSize.Y);
-        End.X = FMath::Clamp(End.X, PlotOrigin.X, PlotOrigin.X + PlotSize.X);
-        End.Y = FMath::Clamp(End.Y, PlotOrigin.Y, PlotOrigin.Y + PlotSize.Y);
+    // 畫 X 軸刻度
+    for (const FChartTickLabel& Tick : RenderCache.XTickLabels)
+    {
+        FVector2D Start(Tick.Position.X, Origin.Y);
+        FVector2D End(Tick.Position.X, Origin.Y + 5.0f);
+        FSlateDrawElement::MakeLines(OutDrawElements, LayerId, PaintGeometry,
+            { Start, End }, ESlateDrawEffect::None, FLinearColor::White, true, 1.0f);
 
-        FSlateDrawElement::MakeLines(OutDrawElements, LayerId,
-            AllottedGeometry.ToPaintGeometry(), { Start, End },
-            ESlateDrawEffect::None, FLinearColor::Green, true, 2.0f);
+        FVector2D TextPos(Tick.Position.X - 20, Origin.Y + 8);
+        FSlateDrawElement::MakeText(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(TextPos, FVector2D(40, 12)),
+            Tick.Text, FontInfo, ESlateDrawEffect::None, FLinearColor::White);
     }
 
-    if (bMouseHovered && RelativeDataPoints.Num() > 0)
+    // 畫 Y 軸刻度
+    for (const FChartTickLabel& Tick : RenderCache.YTickLabels)
     {
-        float MouseX = CachedMousePosition.X;
+        FVector2D Start(Origin.X - 5, Tick.Position.Y);
+        FVector2D End(Origin.X, Tick.Position.Y);
+        FSlateDrawElement::MakeLines(OutDrawElements, LayerId, PaintGeometry,
+            { Start, End }, ESlateDrawEffect::None, FLinearColor::White, true, 1.0f);
 
-        float ClosestDistance = FLT_MAX;
-        FVector2D ClosestPointCanvas = FVector2D::ZeroVector;
-        bool bFoundPoint = false;
-        FString TooltipText;
+        FSlateDrawElement::MakeText(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(FVector2D(0, Tick.Position.Y - 6), FVector2D(40, 12)),
+            Tick.Text, FontInfo, ESlateDrawEffect::None, FLinearColor::White);
+    }
+
+    LayerId++;
 
-        for (const FVector2D& Point : RelativeDataPoints)
+    // 畫折線: 每個 series 一個 draw element
+    for (int32 SeriesIndex = 0; SeriesIndex < RenderCache.ScreenSeries.Num(); ++SeriesIndex)
+    {
+        const TArray<FVector2D>& LinePoints = RenderCache.ScreenSeries[SeriesIndex];
+        if (LinePoints.Num() >= 2)
         {
-            float X = PlotOrigin.X + ((Point.X - MinX) / RangeX) * PlotSize.X;
-            float Y = PlotOrigin.Y + (1.0f - (Point.Y - MinY) / RangeY) * PlotSize.Y;
+            FSlateDrawElement::MakeLines(OutDrawElements, LayerId, PaintGeometry, LinePoints,
+                ESlateDrawEffect::None, GetSeriesColor(SeriesIndex), true, 2.0f);
+        }
+    }
 
-            float Dist = FMath::Abs(MouseX - X);
-            if (Dist < ClosestDistance)
-            {
-                ClosestDistance = Dist;
-                ClosestPointCanvas = FVector2D(X, Y);
-                bFoundPoint = true;
+    // hover 十字線與提示放在上層的 overlay
+    if (bMouseHovered)
+    {
+        PaintHoverOverlay(AllottedGeometry, OutDrawElements, LayerId + 1);
+    }
+
+    // 新資料第一次出現在畫面上
+    if (PendingTraceId != 0)
+    {
+        FPrometheusQueryTrace::End(PendingTraceId);
+        PendingTraceId = 0;
+    }
+
+    return LayerId + 2;
+}
+
+void ULineChartWidget::FindSamplesAtTime(double Time, TArray<FChartHoverSample>& OutSamples) const
+{
+    OutSamples.Reset();
 
-                int64 Timestamp = static_cast<int64>(Point.X + BaseTime);
-                FDateTime LocalTime = FDateTime::FromUnixTimestamp(Timestamp) + (FDateTime::Now() - FDateTime::UtcNow());
+    for (int32 SeriesIndex = 0; SeriesIndex < DataSeries.Num(); ++SeriesIndex)
+    {
+        const FChartSeriesBuffer& Series = DataSeries[SeriesIndex];
+        double SampleTime = 0.0;
+        float SampleValue = 0.0f;
 
-                TooltipText = FString::Printf(TEXT("Time: %s\nValue: %.2f"),
-                    *LocalTime.ToString(TEXT("%H:%M:%S")),
-                    Point.Y);
+        if (!Series.IsEmpty() && Time >= Series.FirstTime())
+        {
+            const int32 SampleIndex = Series.FindNearest(Time);
+            SampleTime = Series.GetTime(SampleIndex);
+            SampleValue = Series.GetValue(SampleIndex);
+        }
+        else if (DecimatedSeries.IsValidIndex(SeriesIndex) && DecimatedSeries[SeriesIndex].Num() > 0)
+        {
+            // 環狀 buffer 之前的歷史: 搜尋目前畫出來的點 (相對於 BaseTime)
+            const TArray<FVector2D>& Points = DecimatedSeries[SeriesIndex];
+            const double RelativeTime = Time - RenderCache.BaseTime;
+            int32 PointIndex = FMath::Min(Algo::LowerBoundBy(Points, RelativeTime, [](const FVector2D& Point) { return Point.X; }), Points.Num() - 1);
+            if (PointIndex > 0 && RelativeTime - Points[PointIndex - 1].X <= Points[PointIndex].X - RelativeTime)
+            {
+                --PointIndex;
             }
+            SampleTime = RenderCache.BaseTime + Points[PointIndex].X;
+            SampleValue = static_cast<float>(Points[PointIndex].Y);
         }
+        else
+        {
+            continue;
+        }
+
+        FChartHoverSample& Sample = OutSamples.AddDefaulted_GetRef();
+        Sample.SeriesIndex = SeriesIndex;
+        Sample.Time = SampleTime;
+        Sample.Value = SampleValue;
 
-        if (bFoundPoint)
+        if (RenderCache.bHasData)
         {
-            // 畫小圓點
-            FSlateDrawElement::MakeBox(OutDrawElements, LayerId,
-                AllottedGeometry.ToPaintGeometry(ClosestPointCanvas - FVector2D(2, 2), FVector2D(4, 4)),
-                FCoreStyle::Get().GetBrush("WhiteBrush"),
-                ESlateDrawEffect::None,
-                FLinearColor::Yellow);
-
-            // 顯示提示文字
-            FVector2D TextPos = ClosestPointCanvas + FVector2D(10, -30);
-            FSlateDrawElement::MakeText(OutDrawElements, LayerId + 1,
-                AllottedGeometry.ToPaintGeometry(TextPos, FVector2D(120, 32)),
-                FText::FromString(TooltipText),
-                FontInfo,
-                ESlateDrawEffect::None,
-                FLinearColor::Yellow);
+            const FVector2D& PlotOrigin = RenderCache.PlotOrigin;
+            const FVector2D& PlotSize = RenderCache.PlotSize;
+            Sample.ScreenPosition.X = PlotOrigin.X + ((Sample.Time - RenderCache.BaseTime - RenderCache.MinX) / RenderCache.RangeX) * PlotSize.X;
+            Sample.ScreenPosition.Y = PlotOrigin.Y + (1.0f - (Sample.Value - RenderCache.MinY) / RenderCache.RangeY) * PlotSize.Y;
         }
     }
+}
 
-    return LayerId + 2;
-}
\ No newline at end of file
+void ULineChartWidget::PaintHoverOverlay(const FGeometry& AllottedGeometry, FSlateWindowElementList& OutDrawElements, int32 LayerId) const
+{
+    const FVector2D& PlotOrigin = RenderCache.PlotOrigin;
+    const FVector2D& PlotSize = RenderCache.PlotSize;
+    const float MouseX = CachedMousePosition.X;
+
+    if (MouseX < PlotOrigin.X || MouseX > PlotOrigin.X + PlotSize.X)
+    {
+        return;
+    }
+
+    // 十字線
+    FSlateDrawElement::MakeLines(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(),
+        { FVector2D(MouseX, PlotOrigin.Y), FVector2D(MouseX, PlotOrigin.Y + PlotSize.Y) },
+        ESlateDrawEffect::None, FLinearColor(1.0f, 1.0f, 1.0f, 0.3f), true, 1.0f);
+
+    // 滑鼠 X 反推回時間，再對每個 series 的時間欄二分搜尋
+    const double MouseTime = RenderCache.BaseTime + RenderCache.MinX + ((MouseX - PlotOrigin.X) / PlotSize.X) * RenderCache.RangeX;
+
+    TArray<FChartHoverSample> Samples;
+    FindSamplesAtTime(MouseTime, Samples);
+    if (Samples.Num() == 0)
+    {
+        return;
+    }
+
+    // 最接近滑鼠 X 的點當作主要的 hit
+    const FChartHoverSample* Closest = &Samples[0];
+    for (const FChartHoverSample& Sample : Samples)
+    {
+        if (FMath::Abs(MouseX - Sample.ScreenPosition.X) < FMath::Abs(MouseX - Closest->ScreenPosition.X))
+        {
+            Closest = &Sample;
+        }
+    }
+
+    // 每個 series 畫小圓點
+    for (const FChartHoverSample& Sample : Samples)
+    {
+        FSlateDrawElement::MakeBox(OutDrawElements, LayerId,
+            AllottedGeometry.ToPaintGeometry(Sample.ScreenPosition - FVector2D(2, 2), FVector2D(4, 4)),
+            FCoreStyle::Get().GetBrush("WhiteBrush"),
+            ESlateDrawEffect::None,
+            &Sample == Closest ? FLinearColor::Yellow : GetSeriesColor(Sample.SeriesIndex));
+    }
+
+    // 只為最後的結果格式化提示文字
+    const FDateTime LocalTime = FDateTime::FromUnixTimestamp(static_cast<int64>(Closest->Time)) + RenderCache.TimeZoneOffset;
+    FString TooltipText = FString::Printf(TEXT("Time: %s"), *LocalTime.ToString(TEXT("%H:%M:%S")));
+    if (DataSeries.Num() > 1)
+    {
+        for (const FChartHoverSample& Sample : Samples)
+        {
+            TooltipText += FString::Printf(TEXT("\n%s: %.2f"),
+                *FPrometheusLabelSetTable::Get().Resolve(DataSeries[Sample.SeriesIndex].LabelSet),
+                Sample.Value);
+        }
+    }
+    else
+    {
+        TooltipText += FString::Printf(TEXT("\nValue: %.2f"), Closest->Value);
+    }
+
+    // 顯示提示文字
+    FVector2D TextPos = Closest->ScreenPosition + FVector2D(10, -30);
+    FSlateDrawElement::MakeText(OutDrawElements, LayerId + 1,
+        AllottedGeometry.ToPaintGeometry(TextPos, FVector2D(120, 16 * (Samples.Num() + 1))),
+        FText::FromString(TooltipText),
+        LineChartLayout::GetFont(),
+        ESlateDrawEffect::None,
+        FLinearColor::Yellow);
+}
@@ -2,24 +2,131 @@
 
 #include "CoreMinimal.h"
 #include "Blueprint/UserWidget.h"
+#include "PrometheusSeries.h"
+#include "ChartSeriesBuffer.h"
+#include "ChartDecimation.h"
 #include "LineChartWidget.generated.h"
 
+// 檢視範圍內缺少的歷史區塊 (Unix 秒)，StepSeconds 對應目前的解析度
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnChartTileRequested, double, StartTime, double, EndTime, float, StepSeconds);
+
+struct FChartTickLabel
+{
+    FVector2D Position;
+    FText Text;
+};
+
+// 滑鼠位置對應到某個 series 的 sample
+struct FChartHoverSample
+{
+    int32 SeriesIndex = INDEX_NONE;
+    double Time = 0.0;
+    float Value = 0.0f;
+    FVector2D ScreenPosition = FVector2D::ZeroVector;
+};
+
+// 依資料 generation 與繪圖尺寸快取的圖表幾何 (retained mode)
+struct FChartRenderCache
+{
+    uint32 Generation = MAX_uint32;
+    FVector2D Size = FVector2D::ZeroVector;
+    bool bHasData = false;
+
+    double BaseTime = 0.0;
+    float MinX = 0.0f;
+    float MinY = 0.0f;
+    float RangeX = 1.0f;
+    float RangeY = 1.0f;
+    FVector2D PlotOrigin = FVector2D::ZeroVector;
+    FVector2D PlotSize = FVector2D::ZeroVector;
+    FTimespan TimeZoneOffset;
+
+    // 每個 series 投影後的螢幕座標
+    TArray<TArray<FVector2D>> ScreenSeries;
+    TArray<FChartTickLabel> XTickLabels;
+    TArray<FChartTickLabel> YTickLabels;
+};
+
 UCLASS()
 class PROMETHEUSVIEWER_API ULineChartWidget : public UUserWidget
 {
     GENERATED_BODY()
 
 public:
-    // 設定圖表資料
+    // 設定圖表資料 (單一 series)
     UFUNCTION(BlueprintCallable, Category = "Chart")
     void SetChartData(const TArray<FVector2D>& InDataPoints);
 
+    // 設定多 series 資料，每個 series 畫一條線；只取代即時視窗，依 label set 保留既有的歷史
+    UFUNCTION(BlueprintCallable, Category = "Chart")
+    void SetSeriesData(const FPrometheusRangeResult& InResult);
+
+    // 清掉所有資料與歷史，換成另一個 query 時呼叫
+    UFUNCTION(BlueprintCallable, Category = "Chart")
+    void ClearData();
+
     UFUNCTION(BlueprintCallable, Category = "LineChart")
-    void AddDataPoint(float X, float Y);
+    void AddDataPoint(double X, float Y);
+
+    // 增量更新: 接在現有資料後面，並移除超出時間視窗的舊點
+    UFUNCTION(BlueprintCallable, Category = "LineChart")
+    void AppendDataPoints(const TArray<FVector2D>& NewPoints);
+
+    // 依 label set 把新 sample 接到對應的 series，沒有的 series 會新增
+    UFUNCTION(BlueprintCallable, Category = "LineChart")
+    void AppendSeriesData(const FPrometheusRangeResult& NewSamples);
+
+    // 各 series 的線條顏色，未設定時使用預設色盤
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chart")
+    TArray<FLinearColor> SeriesColors;
+
+    // 保留的時間範圍 (秒)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chart")
+    float WindowSeconds = 300.0f;
+
+    // 壓縮歷史保留的時間範圍 (秒)，0 表示不保留
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chart", meta = (ClampMin = "0"))
+    float HistorySeconds = 6.0f * 3600.0f;
+
+    // 所有 series 的壓縮歷史佔用的記憶體 (bytes)
+    UFUNCTION(BlueprintCallable, Category = "Chart")
+    int64 GetHistoryAllocatedSize() const;
+
+    // 原始資料的 step (秒)，也就是 LOD 第 0 層的 bucket 寬度；改變時從 History 重建彙總
+    UFUNCTION(BlueprintCallable, Category = "Chart")
+    void SetBaseStep(float InStepSeconds);
+
+    // 滾輪縮放或拖曳到沒有資料的範圍時發出，接收端抓回後呼叫 MergeTileData
+    UPROPERTY(BlueprintAssignable, Category = "Chart")
+    FOnChartTileRequested OnTileRequested;
+
+    // 合併抓回的歷史區塊，只補進 History / LOD，不影響即時的環狀 buffer
+    UFUNCTION(BlueprintCallable, Category = "Chart")
+    void MergeTileData(const FPrometheusRangeResult& Result, float StepSeconds);
+
+    // 回到跟隨最新資料、顯示 WindowSeconds 的預設檢視 (雙擊圖表也會呼叫)
+    UFUNCTION(BlueprintCallable, Category = "Chart")
+    void ResetView();
+
+    UFUNCTION(BlueprintPure, Category = "Chart")
+    bool IsFollowingLatest() const { return bFollowLatest; }
+
+    // 最後一次繪製時的繪圖區寬度 (像素，不含軸的 padding)，還沒畫過時為 0
+    float GetPlotWidth() const { return RenderCache.bHasData ? RenderCache.PlotSize.X : 0.0f; }
+
+    // 下一次畫出資料時結束這個 query 的追蹤 (FPrometheusQueryTrace)，0 表示沒有
+    void SetPendingTrace(uint32 CorrelationId) { PendingTraceId = CorrelationId; }
+
+    // 每個 series 最多保留的點數 (環狀 buffer 容量)
+    UFUNCTION(BlueprintCallable, Category = "Chart")
+    void SetMaxPoints(int32 InMaxPoints);
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chart")
 	int32 UserTimezone;
 
+    // 每個 series 在時間上最接近 Time 的 sample (二分搜尋)，空的 series 會略過
+    void FindSamplesAtTime(double Time, TArray<FChartHoverSample>& OutSamples) const;
+
     FVector2D CachedMousePosition;
     bool bMouseHovered = false;
 protected:
@@ -30,10 +137,72 @@ protected:
     FReply NativeOnMouseMove(const FGeometry& InGeometry, const FPointerEvent& InMouseEvent) override;
 	void NativeOnMouseLeave(const FPointerEvent& InMouseEvent) override;
 
+    // 滾輪縮放、左鍵拖曳平移、雙擊回到即時檢視
+    FReply NativeOnMouseWheel(const FGeometry& InGeometry, const FPointerEvent& InMouseEvent) override;
+    FReply NativeOnMouseButtonDown(const FGeometry& InGeometry, const FPointerEvent& InMouseEvent) override;
+    FReply NativeOnMouseButtonUp(const FGeometry& InGeometry, const FPointerEvent& InMouseEvent) override;
+    FReply NativeOnMouseButtonDoubleClick(const FGeometry& InGeometry, const FPointerEvent& InMouseEvent) override;
+
+    virtual void BeginDestroy() override;
+
 
 private:
-    UPROPERTY()
-    TArray<FVector2D> DataPoints;
+    void TrimToWindow();
+    void AppendSamples(FChartSeriesBuffer& Target, const FPrometheusSeries& Source);
+    int32 FindSeriesIndex(FPrometheusLabelSetHandle LabelSet) const;
+    FChartSeriesBuffer& FindOrAddSeries(FPrometheusLabelSetHandle LabelSet);
+    FChartSeriesBuffer& AddSeries();
+    FLinearColor GetSeriesColor(int32 SeriesIndex) const;
+
+    TArray<FChartSeriesBuffer> DataSeries;
 
+    // 資料每次變動就遞增，用來判斷降採樣快取是否失效
+    uint32 DataGeneration = 0;
+
+    // 把持有的點數 (環狀 buffer + History) 的變化回報給 FPrometheusViewerStats
+    void UpdatePointStats();
+    int64 ReportedPoints = 0;
+
+    mutable uint32 PendingTraceId = 0;
+
+    // 依目前寬度降採樣後的點 (相對於 ViewStart 的時間, 值)，資料、檢視範圍或寬度改變才重算
+    void UpdateDecimationCache(int32 PlotWidth, double ViewStart, double ViewEnd) const;
+
+    // 挑選 bucket 寬度約一個像素的層級: 第 0 層從環狀 buffer 或 History，其餘從 LOD
+    void BuildViewPoints(const FChartSeriesBuffer& Series, double ViewStart, double ViewEnd, int32 PlotWidth, TArray<FVector2D>& OutPoints) const;
+    mutable TArray<TArray<FVector2D>> DecimatedSeries;
+    mutable uint32 DecimatedGeneration = MAX_uint32;
+    mutable int32 DecimatedPlotWidth = INDEX_NONE;
+
+    // 投影點、座標範圍與刻度文字，只在資料或尺寸改變時重建
+    void UpdateRenderCache(const FVector2D& Size) const;
+    mutable FChartRenderCache RenderCache;
+
+    // 滑鼠十字線與提示，每次 hover 只重畫這一層
+    void PaintHoverOverlay(const FGeometry& AllottedGeometry, FSlateWindowElementList& OutDrawElements, int32 LayerId) const;
+
+    UPROPERTY(EditAnywhere, Category = "Chart", meta = (ClampMin = "2"))
     int32 MaxPoints = 300;
+
+    UPROPERTY(EditAnywhere, Category = "Chart", meta = (ClampMin = "0.001"))
+    float BaseStepSeconds = 5.0f;
+
+    // 檢視範圍: 跟隨最新資料時 ViewEndTime 不使用；ViewSpanSeconds 為 0 表示 WindowSeconds
+    double GetLatestTime() const;
+    void GetViewRange(double& OutViewStart, double& OutViewEnd) const;
+    void SetView(double InViewEnd, double InViewSpan);
+    double ClampViewSpan(double InViewSpan) const;
+
+    bool bFollowLatest = true;
+    double ViewEndTime = 0.0;
+    double ViewSpanSeconds = 0.0;
+
+    bool bDragging = false;
+    float DragStartX = 0.0f;
+    double DragStartViewEnd = 0.0;
+
+    // 已經要求過的歷史區塊 (層級 << 56 | 區塊編號)，每個區塊 TileBuckets 個 bucket
+    void RequestMissingTiles();
+    TSet<uint64> RequestedTiles;
+    static constexpr int32 TileBuckets = 256;
 };
\ No newline at end of file
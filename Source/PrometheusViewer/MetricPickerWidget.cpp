@@ -0,0 +1,105 @@
+#include "MetricPickerWidget.h"
+#include "Widgets/Input/SSearchBox.h"
+#include "Widgets/Layout/SBox.h"
+#include "Widgets/SBoxPanel.h"
+#include "Widgets/Text/STextBlock.h"
+
+void UMetricPickerWidget::SetMetricIndex(const TSharedPtr<const FPrometheusMetricIndex>& InIndex)
+{
+    MetricIndex = InIndex;
+    RefreshFilter();
+}
+
+void UMetricPickerWidget::SetSelectedMetric(const FString& Metric)
+{
+    SelectedMetric = Metric;
+    if (!ListView.IsValid())
+    {
+        return;
+    }
+
+    const FMetricItem* Item = FilteredItems.FindByPredicate([&Metric](const FMetricItem& Candidate)
+    {
+        return Candidate.IsValid() && *Candidate == Metric;
+    });
+    if (Item)
+    {
+        ListView->SetSelection(*Item, ESelectInfo::Direct);
+    }
+    else
+    {
+        ListView->ClearSelection();
+    }
+}
+
+TSharedRef<SWidget> UMetricPickerWidget::RebuildWidget()
+{
+    return SNew(SVerticalBox)
+        + SVerticalBox::Slot()
+        .AutoHeight()
+        [
+            SAssignNew(SearchBox, SSearchBox)
+            .HintText(HintText)
+            .OnTextChanged_UObject(this, &UMetricPickerWidget::OnFilterTextChanged)
+        ]
+        + SVerticalBox::Slot()
+        .FillHeight(1.0f)
+        [
+            SAssignNew(ListView, SListView<FMetricItem>)
+            .ListItemsSource(&FilteredItems)
+            .SelectionMode(ESelectionMode::Single)
+            .OnGenerateRow_UObject(this, &UMetricPickerWidget::OnGenerateRow)
+            .OnSelectionChanged_UObject(this, &UMetricPickerWidget::OnListSelectionChanged)
+        ];
+}
+
+void UMetricPickerWidget::ReleaseSlateResources(bool bReleaseChildren)
+{
+    Super::ReleaseSlateResources(bReleaseChildren);
+
+    SearchBox.Reset();
+    ListView.Reset();
+}
+
+void UMetricPickerWidget::OnFilterTextChanged(const FText& InText)
+{
+    FilterText = InText.ToString().TrimStartAndEnd();
+    RefreshFilter();
+}
+
+void UMetricPickerWidget::RefreshFilter()
+{
+    if (MetricIndex.IsValid())
+    {
+        MetricIndex->Search(FilterText, FilteredItems, MaxResults);
+    }
+    else
+    {
+        FilteredItems.Reset();
+    }
+
+    if (ListView.IsValid())
+    {
+        ListView->RequestListRefresh();
+    }
+}
+
+TSharedRef<ITableRow> UMetricPickerWidget::OnGenerateRow(FMetricItem Item, const TSharedRef<STableViewBase>& OwnerTable)
+{
+    return SNew(STableRow<FMetricItem>, OwnerTable)
+        [
+            SNew(STextBlock)
+            .Text(FText::FromString(Item.IsValid() ? *Item : FString()))
+        ];
+}
+
+void UMetricPickerWidget::OnListSelectionChanged(FMetricItem Item, ESelectInfo::Type SelectInfo)
+{
+    if (!Item.IsValid() || SelectInfo == ESelectInfo::Direct)
+    {
+        return;
+    }
+
+    SelectedMetric = *Item;
+    OnMetricPicked.Broadcast(SelectedMetric);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/Widget.h"
+#include "Widgets/Views/SListView.h"
+#include "PrometheusMetricIndex.h"
+#include "MetricPickerWidget.generated.h"
+
+class SSearchBox;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnMetricPicked, const FString&, Metric);
+
+/**
+ * 可輸入過濾的 metric 選單。列表是虛擬化的 SListView，只為畫面上看得到的列建立 widget，
+ * 名稱直接引用 FPrometheusMetricIndex 中的字串，不另外複製。
+ */
+UCLASS()
+class PROMETHEUSVIEWER_API UMetricPickerWidget : public UWidget
+{
+    GENERATED_BODY()
+
+public:
+    void SetMetricIndex(const TSharedPtr<const FPrometheusMetricIndex>& InIndex);
+
+    UFUNCTION(BlueprintCallable, Category = "MetricPicker")
+    FString GetSelectedMetric() const { return SelectedMetric; }
+
+    // 只改變顯示的選擇，不觸發 OnMetricPicked (列表回收的 widget 換成另一個項目時使用)
+    void SetSelectedMetric(const FString& Metric);
+
+    UPROPERTY(BlueprintAssignable, Category = "MetricPicker")
+    FOnMetricPicked OnMetricPicked;
+
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MetricPicker")
+    FText HintText = FText::FromString(TEXT("Search metrics..."));
+
+    // 過濾後最多顯示的筆數，0 表示不限制 (列表本身是虛擬化的)
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MetricPicker", meta = (ClampMin = "0"))
+    int32 MaxResults = 0;
+
+protected:
+    virtual TSharedRef<SWidget> RebuildWidget() override;
+    virtual void ReleaseSlateResources(bool bReleaseChildren) override;
+
+private:
+    using FMetricItem = TSharedPtr<const FString>;
+
+    void RefreshFilter();
+    void OnFilterTextChanged(const FText& InText);
+    TSharedRef<ITableRow> OnGenerateRow(FMetricItem Item, const TSharedRef<STableViewBase>& OwnerTable);
+    void OnListSelectionChanged(FMetricItem Item, ESelectInfo::Type SelectInfo);
+
+    TSharedPtr<const FPrometheusMetricIndex> MetricIndex;
+    TArray<FMetricItem> FilteredItems;
+    FString FilterText;
+    FString SelectedMetric;
+
+    TSharedPtr<SSearchBox> SearchBox;
+    TSharedPtr<SListView<FMetricItem>> ListView;
+};
@@ -0,0 +1,175 @@
+#include "MonitoringItemData.h"
+#include "MonitoringItemWidget.h"
+#include "Algo/BinarySearch.h"
+
+void UMonitoringItemData::Initialize(APrometheusManager* InManager)
+{
+	Manager = InManager;
+}
+
+void UMonitoringItemData::Select(const FString& Metric, const FString& Type)
+{
+	SelectedMetric = Metric;
+	SelectedType = Type;
+
+	APrometheusManager* ManagerPtr = Manager.Get();
+	if (!ManagerPtr || SelectedMetric.IsEmpty() || SelectedType.IsEmpty())
+	{
+		return;
+	}
+
+	SetQuery(ManagerPtr->GetPromQLFromMapping(SelectedMetric, SelectedType));
+
+	ManagerPtr->RegisterQuery(PromQL);
+	ManagerPtr->HandleQuery(PromQL);
+
+	// 送即時視窗的範圍查詢 (step 由 manager 依圖表寬度決定)，縮放/平移之後的歷史由圖表另外要求
+	ManagerPtr->HandleRangeQuery(PromQL, ManagerPtr->RangeWindowSeconds, ManagerPtr->RangeStepSeconds);
+}
+
+void UMonitoringItemData::SetQuery(const FString& InPromQL)
+{
+	APrometheusManager* ManagerPtr = Manager.Get();
+	if (InPromQL != PromQL)
+	{
+		ResetResults();
+	}
+	PromQL = InPromQL;
+
+	if (!ManagerPtr || (Subscription.IsValid() && Subscription.QueryId == PromQL))
+	{
+		return;
+	}
+
+	ManagerPtr->Unsubscribe(Subscription);
+	Subscription = ManagerPtr->Subscribe(PromQL, this,
+		FOnPrometheusInstantResult::CreateUObject(this, &UMonitoringItemData::OnInstantResult),
+		FOnPrometheusRangeResult::CreateUObject(this, &UMonitoringItemData::OnRangeResult),
+		FOnPrometheusRangeTileResult::CreateUObject(this, &UMonitoringItemData::OnTileResult));
+
+	// 接著送出的範圍查詢就能依目前的圖表寬度選 step
+	MarkVisible();
+}
+
+void UMonitoringItemData::Shutdown()
+{
+	if (APrometheusManager* ManagerPtr = Manager.Get())
+	{
+		ManagerPtr->Unsubscribe(Subscription);
+	}
+	Subscription.Reset();
+	EntryWidget.Reset();
+}
+
+void UMonitoringItemData::MarkVisible(float PixelWidth)
+{
+	APrometheusManager* ManagerPtr = Manager.Get();
+	if (ManagerPtr && Subscription.IsValid())
+	{
+		ManagerPtr->MarkSubscriptionVisible(Subscription, PixelWidth);
+	}
+}
+
+void UMonitoringItemData::SetEntryWidget(UMonitoringItemWidget* Widget)
+{
+	EntryWidget = Widget;
+}
+
+void UMonitoringItemData::OnInstantResult(const FString& InPromQL, const FString& Result)
+{
+	if (InPromQL != PromQL)
+	{
+		return;
+	}
+
+	LastValue = Result;
+	if (UMonitoringItemWidget* Widget = EntryWidget.Get())
+	{
+		Widget->OnQueryResponseReceived(InPromQL, Result);
+	}
+}
+
+void UMonitoringItemData::OnRangeResult(const FString& InPromQL, const FPrometheusRangeResult& Result, bool bDelta)
+{
+	if (InPromQL != PromQL)
+	{
+		return;
+	}
+
+	if (bDelta && bHasRangeHistory)
+	{
+		AppendRangeHistory(Result);
+	}
+	else
+	{
+		RangeHistory = Result;
+		bHasRangeHistory = true;
+	}
+
+	// 沒有 widget 時 (捲出畫面) 只更新資料，重新顯示時一次畫出
+	if (UMonitoringItemWidget* Widget = EntryWidget.Get())
+	{
+		Widget->OnRangeResultReceived(InPromQL, Result, bDelta);
+	}
+}
+
+void UMonitoringItemData::OnTileResult(const FPrometheusRangeRequest& TileRequest, const FPrometheusRangeResult& Result)
+{
+	// 縮放/平移的歷史區塊只屬於當時的圖表，不保留
+	if (UMonitoringItemWidget* Widget = EntryWidget.Get())
+	{
+		Widget->OnTileResultReceived(TileRequest, Result);
+	}
+}
+
+void UMonitoringItemData::AppendRangeHistory(const FPrometheusRangeResult& NewSamples)
+{
+	const APrometheusManager* ManagerPtr = Manager.Get();
+	const double WindowSeconds = ManagerPtr ? ManagerPtr->RangeWindowSeconds : 300.0;
+
+	for (const FPrometheusSeries& Source : NewSamples.Series)
+	{
+		FPrometheusSeries* Target = RangeHistory.Series.FindByPredicate([&Source](const FPrometheusSeries& Series)
+		{
+			return Series.LabelSet == Source.LabelSet;
+		});
+		if (!Target)
+		{
+			Target = &RangeHistory.Series.AddDefaulted_GetRef();
+			Target->LabelSet = Source.LabelSet;
+		}
+
+		const double LastTimestamp = Target->Num() > 0 ? Target->Timestamps.Last() : TNumericLimits<double>::Lowest();
+		for (int32 i = 0; i < Source.Num(); ++i)
+		{
+			if (Source.Timestamps[i] > LastTimestamp)
+			{
+				Target->Add(Source.Timestamps[i], Source.Values[i]);
+			}
+		}
+	}
+
+	// 只留顯示視窗內的資料，長時間捲在畫面外也不會一直成長
+	const double Cutoff = RangeHistory.GetLastTimestamp() - WindowSeconds;
+	for (int32 SeriesIndex = RangeHistory.Series.Num() - 1; SeriesIndex >= 0; --SeriesIndex)
+	{
+		FPrometheusSeries& Series = RangeHistory.Series[SeriesIndex];
+		const int32 NumExpired = Algo::LowerBound(Series.Timestamps, Cutoff);
+		if (NumExpired >= Series.Num())
+		{
+			RangeHistory.Series.RemoveAt(SeriesIndex);
+		}
+		else if (NumExpired > 0)
+		{
+			Series.Timestamps.RemoveAt(0, NumExpired, EAllowShrinking::No);
+			Series.Values.RemoveAt(0, NumExpired, EAllowShrinking::No);
+		}
+	}
+}
+
+void UMonitoringItemData::ResetResults()
+{
+	LastValue.Reset();
+	RangeHistory.Series.Reset();
+	bHasRangeHistory = false;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "PrometheusSeries.h"
+#include "PrometheusManager.h"
+#include "MonitoringItemData.generated.h"
+
+class UMonitoringItemWidget;
+
+/**
+ * Dashboard 上一個監控項目的資料: 選擇的 metric / 類型、manager 的訂閱與最近的結果。
+ * 與 widget 分開，列表捲動時 widget 會被回收給其他項目使用，資料與訂閱留在這裡；
+ * 有 widget 顯示這個項目時，結果直接轉送給它。
+ */
+UCLASS()
+class PROMETHEUSVIEWER_API UMonitoringItemData : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	void Initialize(APrometheusManager* InManager);
+
+	APrometheusManager* GetManager() const { return Manager.Get(); }
+
+	// 選擇改變時產生新的 PromQL 並重新訂閱，立即送出即時與範圍查詢；metric 或類型為空時只記錄選擇
+	void Select(const FString& Metric, const FString& Type);
+
+	const FString& GetSelectedMetric() const { return SelectedMetric; }
+	const FString& GetSelectedType() const { return SelectedType; }
+	const FString& GetPromQL() const { return PromQL; }
+
+	// 換成新的 PromQL 時重新訂閱，只會收到這個 query 的結果
+	void SetQuery(const FString& InPromQL);
+
+	// 從 dashboard 移除時呼叫，最後一個訂閱者離開時 manager 會停止這個 query
+	void Shutdown();
+
+	// 讓排程器知道這個項目仍需要更新；PixelWidth 為 0 時 manager 沿用上次的圖表寬度
+	void MarkVisible(float PixelWidth = 0.0f);
+
+	// 最近一次的即時查詢結果，還沒有時為空
+	const FString& GetLastValue() const { return LastValue; }
+
+	// 最近的範圍查詢資料 (原始值，完整結果加上之後的增量，只保留 RangeWindowSeconds)
+	bool HasRangeHistory() const { return bHasRangeHistory; }
+	const FPrometheusRangeResult& GetRangeHistory() const { return RangeHistory; }
+
+	// 目前顯示這個項目的 widget，捲出畫面被回收後為空
+	void SetEntryWidget(UMonitoringItemWidget* Widget);
+	UMonitoringItemWidget* GetEntryWidget() const { return EntryWidget.Get(); }
+
+private:
+	void OnInstantResult(const FString& InPromQL, const FString& Result);
+	void OnRangeResult(const FString& InPromQL, const FPrometheusRangeResult& Result, bool bDelta);
+	void OnTileResult(const FPrometheusRangeRequest& TileRequest, const FPrometheusRangeResult& Result);
+
+	void AppendRangeHistory(const FPrometheusRangeResult& NewSamples);
+	void ResetResults();
+
+	TWeakObjectPtr<APrometheusManager> Manager;
+	FPrometheusSubscriptionHandle Subscription;
+
+	FString SelectedMetric;
+	FString SelectedType;
+	FString PromQL;
+
+	FString LastValue;
+	FPrometheusRangeResult RangeHistory;
+	bool bHasRangeHistory = false;
+
+	TWeakObjectPtr<UMonitoringItemWidget> EntryWidget;
+};
@@ -3,21 +3,25 @@
 
 #include "MonitoringItemWidget.h"
 #include "PrometheusManager.h"
+#include "MonitoringItemData.h"
 #include "Components/ComboBoxString.h"
 #include "Components/TextBlock.h"
 #include "LineChartWidget.h"
+#include "HeatmapWidget.h"
+#include "MetricPickerWidget.h"
+#include "Async/Async.h"
+#include "PrometheusQueryTrace.h"
 
 void UMonitoringItemWidget::InitializeOptions(APrometheusManager* Manager)
 {
     this->ManagerRef = Manager;
     if (!Manager) return;
 
-    if (!Manager->OnMetricsFetched.IsAlreadyBound(this, &UMonitoringItemWidget::OnMetricsReady))
+    if (MetricPicker && !MetricPicker->OnMetricPicked.IsAlreadyBound(this, &UMonitoringItemWidget::OnMetricPicked))
     {
-        Manager->OnMetricsFetched.AddDynamic(this, &UMonitoringItemWidget::OnMetricsReady);
+        MetricPicker->OnMetricPicked.AddDynamic(this, &UMonitoringItemWidget::OnMetricPicked);
     }
-
-    if (!MetricComboBox->OnSelectionChanged.IsBound())
+    if (MetricComboBox && !MetricComboBox->OnSelectionChanged.IsBound())
     {
         MetricComboBox->OnSelectionChanged.AddDynamic(this, &UMonitoringItemWidget::OnMetricChanged);
     }
@@ -32,58 +36,111 @@ void UMonitoringItemWidget::InitializeOptions(APrometheusManager* Manager)
         TypeComboBox->AddOption("Usage%");
     }
 
-    if (!Manager->OnRangeQueryResponse.IsAlreadyBound(this, &UMonitoringItemWidget::OnRangeQueryResponseReceived))
+    if (LineChartResult)
+    {
+        LineChartResult->WindowSeconds = Manager->RangeWindowSeconds;
+        LineChartResult->SetMaxPoints(FMath::CeilToInt(Manager->RangeWindowSeconds / FMath::Max(Manager->RangeStepSeconds, 1.0f)) + 1);
+        LineChartResult->SetBaseStep(Manager->RangeStepSeconds);
+        if (!LineChartResult->OnTileRequested.IsAlreadyBound(this, &UMonitoringItemWidget::OnChartTileRequested))
+        {
+            LineChartResult->OnTileRequested.AddDynamic(this, &UMonitoringItemWidget::OnChartTileRequested);
+        }
+    }
+    if (HeatmapResult)
     {
-        Manager->OnRangeQueryResponse.AddDynamic(this, &UMonitoringItemWidget::OnRangeQueryResponseReceived);
+        HeatmapResult->SetWindowSeconds(Manager->RangeWindowSeconds);
+        HeatmapResult->SetBaseStep(Manager->RangeStepSeconds);
+        SetShowHeatmap(bShowingHeatmap);
     }
 
-    Manager->FetchAvailableMetrics();
+    // 共用 manager 的索引，已經抓過就不再送請求
+    if (Manager->GetMetricIndex().IsValid())
+    {
+        OnMetricIndexReady(Manager->GetMetricIndex());
+    }
+    else
+    {
+        if (!MetricIndexReadyHandle.IsValid())
+        {
+            MetricIndexReadyHandle = Manager->OnMetricIndexReady.AddUObject(this, &UMonitoringItemWidget::OnMetricIndexReady);
+        }
+        Manager->FetchAvailableMetrics();
+    }
 }
 
-void UMonitoringItemWidget::OnMetricsReady(const TArray<FString>& Metrics)
+void UMonitoringItemWidget::OnMetricIndexReady(const TSharedPtr<const FPrometheusMetricIndex>& Index)
 {
-    if (!bMetricsInitialized)
+    // 空的索引 (抓取失敗) 不算初始化完成，保持等待，下次 InitializeOptions 會重抓
+    if (bMetricsInitialized || !Index.IsValid() || Index->Num() == 0)
+    {
+        return;
+    }
+
+    if (MetricPicker)
+    {
+        MetricPicker->SetMetricIndex(Index);
+    }
+    else if (MetricComboBox)
     {
         MetricComboBox->ClearOptions();
-        for (const FString& M : Metrics)
+        for (const TSharedPtr<const FString>& Name : Index->GetNames())
         {
-            MetricComboBox->AddOption(M);
+            MetricComboBox->AddOption(*Name);
         }
-        bMetricsInitialized = true;
+    }
+    bMetricsInitialized = true;
+
+    if (ManagerRef && MetricIndexReadyHandle.IsValid())
+    {
+        ManagerRef->OnMetricIndexReady.Remove(MetricIndexReadyHandle);
+        MetricIndexReadyHandle.Reset();
     }
 }
 
-void UMonitoringItemWidget::OnMetricChanged(FString Selected, ESelectInfo::Type)
+void UMonitoringItemWidget::OnMetricPicked(const FString& Metric)
 {
-    SelectedMetric = Selected;
-    UE_LOG(LogTemp, Warning, TEXT("[ComboBox] Metric changed: %s"), *Selected);
+    OnMetricChanged(Metric, ESelectInfo::OnMouseClick);
+}
 
-    if (!SelectedType.IsEmpty())
+void UMonitoringItemWidget::OnMetricChanged(FString Selected, ESelectInfo::Type)
+{
+    if (bApplyingItemData)
     {
-        const FString FinalPromQL = GeneratePromQL(SelectedMetric, SelectedType);
+        return;
+    }
 
-        if (ManagerRef)
-        {
-            // 送範圍查詢 (例如最近 300 秒，每 15 秒取一點)
-            ManagerRef->HandleRangeQuery(FinalPromQL, 300.f, 5.f);
-        }
+    SelectedMetric = Selected;
+    UE_LOG(LogTemp, Warning, TEXT("[ComboBox] Metric changed: %s"), *Selected);
 
-        OnPromQueryGenerated.Broadcast(FinalPromQL, this);
-    }
+    ApplySelection();
 }
 
 void UMonitoringItemWidget::OnTypeChanged(FString Selected, ESelectInfo::Type)
 {
+    if (bApplyingItemData)
+    {
+        return;
+    }
+
     SelectedType = Selected;
+    ApplySelection();
+}
 
-    if (!SelectedMetric.IsEmpty())
+void UMonitoringItemWidget::ApplySelection()
+{
+    UMonitoringItemData* Data = GetOrCreateItemData();
+    if (!Data)
     {
-        const FString FinalPromQL = GeneratePromQL(SelectedMetric, SelectedType);
-        if (ManagerRef)
-        {
-            ManagerRef->HandleRangeQuery(FinalPromQL, 300.f, 5.f);
-        }
-        OnPromQueryGenerated.Broadcast(FinalPromQL, this);
+        return;
+    }
+
+    // 訂閱、即時與範圍查詢都由資料物件送出，縮放/平移之後的歷史由 OnChartTileRequested 補抓
+    Data->Select(SelectedMetric, SelectedType);
+
+    if (!SelectedMetric.IsEmpty() && !SelectedType.IsEmpty())
+    {
+        LastSentPromQL = Data->GetPromQL();
+        OnPromQueryGenerated.Broadcast(LastSentPromQL, this);
     }
 }
 
@@ -103,17 +160,151 @@ void UMonitoringItemWidget::TriggerQuery(APrometheusManager* Manager)
 {
     if (!Manager) return;
 
-    LastSentPromQL = GeneratePromQL(SelectedMetric, SelectedType);
+    ManagerRef = Manager;
+    UMonitoringItemData* Data = GetOrCreateItemData();
+    Data->SetQuery(GeneratePromQL(SelectedMetric, SelectedType));
+    LastSentPromQL = Data->GetPromQL();
 
-    Manager->OnQueryResponse.AddDynamic(this, &UMonitoringItemWidget::OnQueryResponseReceived);
     Manager->HandleQuery(LastSentPromQL);
     Manager->RegisterQuery(LastSentPromQL);
 }
 
+UMonitoringItemData* UMonitoringItemWidget::GetOrCreateItemData()
+{
+    if (!ItemData && ManagerRef)
+    {
+        ItemData = NewObject<UMonitoringItemData>(this);
+        ItemData->Initialize(ManagerRef);
+        ItemData->SetEntryWidget(this);
+    }
+    return ItemData;
+}
+
+void UMonitoringItemWidget::NativeOnListItemObjectSet(UObject* ListItemObject)
+{
+    IUserObjectListEntry::NativeOnListItemObjectSet(ListItemObject);
+
+    UMonitoringItemData* Data = Cast<UMonitoringItemData>(ListItemObject);
+    if (!Data)
+    {
+        UE_LOG(LogTemp, Error, TEXT("[MonitoringItem] List item is not a UMonitoringItemData"));
+        return;
+    }
+
+    ReleaseItemData();
+    ItemData = Data;
+    Data->SetEntryWidget(this);
+
+    InitializeOptions(Data->GetManager());
+    ApplyItemData();
+}
+
+void UMonitoringItemWidget::NativeOnEntryReleased()
+{
+    IUserObjectListEntry::NativeOnEntryReleased();
+
+    ReleaseItemData();
+}
+
+void UMonitoringItemWidget::ReleaseItemData()
+{
+    if (ItemData && ItemData->GetEntryWidget() == this)
+    {
+        ItemData->SetEntryWidget(nullptr);
+    }
+    ItemData = nullptr;
+
+    // 還在 worker 上的轉換結果屬於上一個項目
+    ++ChartGeneration;
+}
+
+void UMonitoringItemWidget::ApplyItemData()
+{
+    SelectedMetric = ItemData->GetSelectedMetric();
+    SelectedType = ItemData->GetSelectedType();
+    LastSentPromQL = ItemData->GetPromQL();
+
+    {
+        TGuardValue<bool> ApplyingGuard(bApplyingItemData, true);
+        TypeComboBox->SetSelectedOption(SelectedType);
+        if (MetricPicker)
+        {
+            MetricPicker->SetSelectedMetric(SelectedMetric);
+        }
+        else if (MetricComboBox)
+        {
+            MetricComboBox->SetSelectedOption(SelectedMetric);
+        }
+    }
+
+    if (ItemData->GetLastValue().IsEmpty())
+    {
+        if (ResultText)
+        {
+            ResultText->SetText(FText::GetEmpty());
+        }
+    }
+    else
+    {
+        OnQueryResponseReceived(LastSentPromQL, ItemData->GetLastValue());
+    }
+
+    if (!LineChartResult)
+    {
+        return;
+    }
+
+    // 上一個項目的縮放/平移與歷史不沿用
+    LineChartResult->ResetView();
+    LineChartResult->ClearData();
+    ChartDataKey.Reset();
+    if (ItemData->HasRangeHistory())
+    {
+        InitializeChartWithHistory(ItemData->GetRangeHistory());
+    }
+    else
+    {
+        ++ChartGeneration;
+        SetShowHeatmap(false);
+    }
+}
+
+int32 UMonitoringItemWidget::NativePaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry,
+    const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements,
+    int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+{
+    if (ItemData)
+    {
+        // 圖表寬度讓 manager 決定 range query 的 step
+        ItemData->MarkVisible(LineChartResult ? LineChartResult->GetPlotWidth() : 0.0f);
+    }
+
+    return Super::NativePaint(Args, AllottedGeometry, MyCullingRect, OutDrawElements,
+        LayerId, InWidgetStyle, bParentEnabled);
+}
+
+void UMonitoringItemWidget::NativeDestruct()
+{
+    // 自己建立的資料物件跟著 widget 結束；UListView 的項目由 dashboard 管理
+    if (ItemData && ItemData->GetOuter() == this)
+    {
+        ItemData->Shutdown();
+    }
+    ReleaseItemData();
+
+    if (IsValid(ManagerRef))
+    {
+        ManagerRef->OnMetricIndexReady.Remove(MetricIndexReadyHandle);
+        MetricIndexReadyHandle.Reset();
+    }
+
+    Super::NativeDestruct();
+}
+
 void UMonitoringItemWidget::OnQueryResponseReceived(const FString& PromQL, const FString& Result)
 {
-    UE_LOG(LogTemp, Warning, TEXT("Widget OnQueryResponseReceived - MyLast: %s | Incoming: %s"), *LastSentPromQL, *PromQL);
-    UE_LOG(LogTemp, Warning, TEXT("[QueryResult] PromQL: %s => Result: %s"), *PromQL, *Result);
+    UE_LOG(LogTemp, VeryVerbose, TEXT("Widget OnQueryResponseReceived - MyLast: %s | Incoming: %s"), *LastSentPromQL, *PromQL);
+    UE_LOG(LogTemp, VeryVerbose, TEXT("[QueryResult] PromQL: %s => Result: %s"), *PromQL, *Result);
 
     if (!ResultText)
     {
@@ -133,22 +324,84 @@ void UMonitoringItemWidget::OnQueryResponseReceived(const FString& PromQL, const
 
 }
 
-void UMonitoringItemWidget::OnRangeQueryResponseReceived(const FString& PromQL, const TArray<FVector2D>& DataPoints)
+void UMonitoringItemWidget::OnRangeResultReceived(const FString& PromQL, const FPrometheusRangeResult& Result, bool bDelta)
 {
-    if (PromQL == LastSentPromQL && LineChartResult)
+    if (bDelta)
     {
-        InitializeChartWithHistory(DataPoints);
+        OnRangeQueryDeltaReceived(PromQL, Result);
+    }
+    else
+    {
+        OnRangeQueryResponseReceived(PromQL, Result);
+    }
+}
+
+void UMonitoringItemWidget::OnChartTileRequested(double StartTime, double EndTime, float StepSeconds)
+{
+    if (ManagerRef && !LastSentPromQL.IsEmpty())
+    {
+        ManagerRef->RequestRangeTile(LastSentPromQL, StartTime, EndTime, StepSeconds);
     }
 }
 
+void UMonitoringItemWidget::OnTileResultReceived(const FPrometheusRangeRequest& TileRequest, const FPrometheusRangeResult& Result)
+{
+    if (TileRequest.PromQL != LastSentPromQL || !LineChartResult)
+    {
+        return;
+    }
+
+    if (!SelectedType.Equals("Raw", ESearchCase::IgnoreCase))
+    {
+        LineChartResult->MergeTileData(Result, TileRequest.StepSeconds);
+        return;
+    }
+
+    // Raw 模式: 區塊內各自做差值，再換算成即時資料實際 step 的量 (manager 可能選了比 RangeStepSeconds 大的 step)，才能畫在一起
+    TWeakObjectPtr<UMonitoringItemWidget> WeakThis(this);
+    const uint32 Generation = ChartGeneration;
+    const float StepSeconds = TileRequest.StepSeconds;
+    const float LiveStepSeconds = ManagerRef ? ManagerRef->GetRangeStep(LastSentPromQL) : StepSeconds;
+    const float Scale = LiveStepSeconds / FMath::Max(StepSeconds, KINDA_SMALL_NUMBER);
+
+    UE::Tasks::Launch(UE_SOURCE_LOCATION, [WeakThis, Result, Generation, StepSeconds, Scale]()
+    {
+        FCounterDeltaState TileState;
+        FPrometheusRangeResult FinalResult;
+        FinalResult.Series.Reserve(Result.Series.Num());
+        for (const FPrometheusSeries& Series : Result.Series)
+        {
+            FPrometheusSeries& Deltas = FinalResult.Series.AddDefaulted_GetRef();
+            ApplyCounterDelta(Series, TileState, Deltas);
+            for (float& Value : Deltas.Values)
+            {
+                Value *= Scale;
+            }
+        }
 
-void UMonitoringItemWidget::InitializeChartWithHistory(const TArray<FVector2D>& DataPoints)
+        AsyncTask(ENamedThreads::GameThread, [WeakThis, FinalResult = MoveTemp(FinalResult), Generation, StepSeconds]()
+        {
+            UMonitoringItemWidget* This = WeakThis.Get();
+            if (This && This->LineChartResult && This->ChartGeneration == Generation)
+            {
+                This->LineChartResult->MergeTileData(FinalResult, StepSeconds);
+            }
+        });
+    });
+}
+
+void UMonitoringItemWidget::OnRangeQueryResponseReceived(const FString& PromQL, const FPrometheusRangeResult& Result)
 {
-    UE_LOG(LogTemp, Warning, TEXT("[RangeQuery] HistoryPoints count=%d"), DataPoints.Num());
-    for (const auto& P : DataPoints)
+    if (PromQL == LastSentPromQL && LineChartResult)
     {
-        UE_LOG(LogTemp, Warning, TEXT("Point: Time=%f, Value=%f"), P.X, P.Y);
+        InitializeChartWithHistory(Result);
     }
+}
+
+
+void UMonitoringItemWidget::InitializeChartWithHistory(const FPrometheusRangeResult& Result)
+{
+    UE_LOG(LogTemp, Verbose, TEXT("[RangeQuery] HistoryPoints series=%d count=%d"), Result.Series.Num(), Result.GetTotalPoints());
 
     if (!LineChartResult)
     {
@@ -156,27 +409,178 @@ void UMonitoringItemWidget::InitializeChartWithHistory(const TArray<FVector2D>&
         return;
     }
 
-    TArray<FVector2D> FinalPoints;
+    const uint32 TraceId = FPrometheusQueryTrace::GetCurrent();
+    PROMETHEUS_QUERY_TRACE_SCOPE(TraceId, ChartUpdate);
+
+    ++ChartGeneration;
+
+    // 換了 query 或類型才清掉圖表；同一個 query 的完整結果只取代即時視窗，縮放/平移的歷史保留
+    const FString DataKey = LastSentPromQL + TEXT("|") + SelectedType;
+    if (DataKey != ChartDataKey)
+    {
+        LineChartResult->ClearData();
+        ChartDataKey = DataKey;
+    }
+
+    // histogram bucket: 熱圖自己做累計 counter 的差值與 bucket 相減
+    SetShowHeatmap(HeatmapResult && UHeatmapWidget::IsHistogramResult(Result));
+    if (bShowingHeatmap)
+    {
+        if (ManagerRef)
+        {
+            HeatmapResult->SetBaseStep(ManagerRef->GetRangeStep(LastSentPromQL));
+        }
+        HeatmapResult->bCumulativeCounters = SelectedType.Equals("Raw", ESearchCase::IgnoreCase);
+        HeatmapResult->SetSeriesData(Result);
+        HeatmapResult->SetPendingTrace(TraceId);
+        return;
+    }
+
+    // step 依圖表寬度與點數上限由 manager 決定，LOD 的 bucket 寬度要跟著
+    if (ManagerRef)
+    {
+        LineChartResult->SetBaseStep(ManagerRef->GetRangeStep(LastSentPromQL));
+    }
+
+    if (SelectedType.Equals("Raw", ESearchCase::IgnoreCase))
+    {
+        LaunchCounterDeltaTransform(Result, true, TraceId);
+    }
+    else
+    {
+        LineChartResult->SetSeriesData(Result);
+        LineChartResult->SetPendingTrace(TraceId);
+    }
+
+    UE_LOG(LogTemp, Verbose, TEXT("LineChart initialized with %d series (mode=%s)"), Result.Series.Num(), *SelectedType);
+}
+
+void UMonitoringItemWidget::OnRangeQueryDeltaReceived(const FString& PromQL, const FPrometheusRangeResult& NewSamples)
+{
+    if (PromQL == LastSentPromQL && LineChartResult)
+    {
+        AppendChartSamples(NewSamples);
+    }
+}
+
+void UMonitoringItemWidget::AppendChartSamples(const FPrometheusRangeResult& NewSamples)
+{
+    if (!LineChartResult || NewSamples.Series.Num() == 0)
+    {
+        return;
+    }
+
+    const uint32 TraceId = FPrometheusQueryTrace::GetCurrent();
+    PROMETHEUS_QUERY_TRACE_SCOPE(TraceId, ChartUpdate);
+
+    if (bShowingHeatmap)
+    {
+        HeatmapResult->AppendSeriesData(NewSamples);
+        HeatmapResult->SetPendingTrace(TraceId);
+        return;
+    }
 
     if (SelectedType.Equals("Raw", ESearchCase::IgnoreCase))
     {
-        for (int32 i = 1; i < DataPoints.Num(); i++)
+        // 與 InitializeChartWithHistory 相同的差值轉換，第一筆接續上次的最後一個原始值
+        LaunchCounterDeltaTransform(NewSamples, false, TraceId);
+    }
+    else
+    {
+        LineChartResult->AppendSeriesData(NewSamples);
+        LineChartResult->SetPendingTrace(TraceId);
+    }
+}
+
+void UMonitoringItemWidget::LaunchCounterDeltaTransform(const FPrometheusRangeResult& Source, bool bHistory, uint32 TraceId)
+{
+    TWeakObjectPtr<UMonitoringItemWidget> WeakThis(this);
+    TSharedRef<FCounterDeltaState, ESPMode::ThreadSafe> State = CounterDeltaState;
+    const uint32 Generation = ChartGeneration;
+
+    auto Transform = [WeakThis, State, Source, bHistory, Generation, TraceId]()
+    {
+        TRACE_CPUPROFILER_EVENT_SCOPE(MonitoringItem_CounterDelta);
+        PROMETHEUS_QUERY_TRACE_SCOPE(TraceId, ChartUpdate);
+
+        if (bHistory)
         {
-            float Delta = DataPoints[i].Y - DataPoints[i - 1].Y;
+            State->LastRawSamples.Reset();
+        }
+
+        FPrometheusRangeResult FinalResult;
+        FinalResult.Series.Reserve(Source.Series.Num());
+        for (const FPrometheusSeries& Series : Source.Series)
+        {
+            ApplyCounterDelta(Series, *State, FinalResult.Series.AddDefaulted_GetRef());
+        }
+
+        AsyncTask(ENamedThreads::GameThread, [WeakThis, FinalResult = MoveTemp(FinalResult), bHistory, Generation, TraceId]()
+        {
+            UMonitoringItemWidget* This = WeakThis.Get();
+            if (!This || !This->LineChartResult || This->ChartGeneration != Generation)
+            {
+                return;
+            }
+            This->LineChartResult->SetPendingTrace(TraceId);
+
+            if (bHistory)
+            {
+                UE_LOG(LogTemp, Verbose, TEXT("Processed Raw mode with %d delta points"), FinalResult.GetTotalPoints());
+                This->LineChartResult->SetSeriesData(FinalResult);
+            }
+            else
+            {
+                This->LineChartResult->AppendSeriesData(FinalResult);
+            }
+        });
+    };
+
+    // 前一個轉換完成後才開始，State 同一時間只有一個 task 存取
+    PendingTransform = PendingTransform.IsValid()
+        ? UE::Tasks::Launch(UE_SOURCE_LOCATION, MoveTemp(Transform), UE::Tasks::Prerequisites(PendingTransform))
+        : UE::Tasks::Launch(UE_SOURCE_LOCATION, MoveTemp(Transform));
+}
+
+void UMonitoringItemWidget::SetShowHeatmap(bool bShow)
+{
+    bShowingHeatmap = bShow && HeatmapResult;
+
+    // 沒有綁定熱圖的 layout 不動圖表的顯示狀態
+    if (!HeatmapResult)
+    {
+        return;
+    }
+    HeatmapResult->SetVisibility(bShowingHeatmap ? ESlateVisibility::SelfHitTestInvisible : ESlateVisibility::Collapsed);
+    if (LineChartResult)
+    {
+        LineChartResult->SetVisibility(bShowingHeatmap ? ESlateVisibility::Collapsed : ESlateVisibility::Visible);
+    }
+}
+
+void UMonitoringItemWidget::ApplyCounterDelta(const FPrometheusSeries& Source, FCounterDeltaState& State, FPrometheusSeries& OutDeltas)
+{
+    OutDeltas.LabelSet = Source.LabelSet;
+    OutDeltas.Reserve(Source.Num());
+
+    // 每個 series 各自記住上一筆原始值
+    FVector2D* LastRawSample = State.LastRawSamples.Find(Source.LabelSet);
+    for (int32 i = 0; i < Source.Num(); ++i)
+    {
+        if (LastRawSample)
+        {
+            float Delta = Source.Values[i] - LastRawSample->Y;
             if (Delta < 0)
             {
                 // Counter reset，設成 0
                 Delta = 0.0f;
             }
-            FinalPoints.Add(FVector2D(DataPoints[i].X, Delta));
+            OutDeltas.Add(Source.Timestamps[i], Delta);
         }
-        UE_LOG(LogTemp, Log, TEXT("Processed Raw mode with %d delta points"), FinalPoints.Num());
-    }
-    else
-    {
-        FinalPoints = DataPoints;
+        else
+        {
+            LastRawSample = &State.LastRawSamples.Add(Source.LabelSet);
+        }
+        *LastRawSample = FVector2D(Source.Timestamps[i], Source.Values[i]);
     }
-
-    LineChartResult->SetChartData(FinalPoints);
-    UE_LOG(LogTemp, Log, TEXT("LineChart initialized with %d points (mode=%s)"), FinalPoints.Num(), *SelectedType);
-}
\ No newline at end of file
+}
@@ -2,24 +2,46 @@
 
 #include "CoreMinimal.h"
 #include "Blueprint/UserWidget.h"
+#include "Blueprint/IUserObjectListEntry.h"
 #include "Components/ComboBoxString.h"
 #include "LineChartWidget.h"
+#include "PrometheusSeries.h"
+#include "PrometheusManager.h"
+#include "Tasks/Task.h"
 #include "MonitoringItemWidget.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnPromQueryGenerated, const FString&, PromQL, class UMonitoringItemWidget*, TargetWidget);
 
+// Raw 模式差值計算的狀態，只在 worker 上的轉換 task 之間依序存取
+struct FCounterDeltaState
+{
+    // 每個 series 的上一筆原始 sample
+    TMap<FPrometheusLabelSetHandle, FVector2D> LastRawSamples;
+};
+
+class UMonitoringItemData;
+
+/**
+ * 顯示一個 UMonitoringItemData 的 widget。放在 dashboard 的 UListView 中時會被回收給其他項目，
+ * 訂閱與最近的結果都在資料物件上，綁定新的項目時依資料重建選單與圖表。
+ */
 UCLASS()
-class PROMETHEUSVIEWER_API UMonitoringItemWidget : public UUserWidget
+class PROMETHEUSVIEWER_API UMonitoringItemWidget : public UUserWidget, public IUserObjectListEntry
 {
     GENERATED_BODY()
 
 public:
 
-    UPROPERTY(meta = (BindWidget)) class UComboBoxString* MetricComboBox;
+    // 舊的下拉選單，metric 很多時請改用 MetricPicker
+    UPROPERTY(meta = (BindWidgetOptional)) class UComboBoxString* MetricComboBox;
+    UPROPERTY(meta = (BindWidgetOptional)) class UMetricPickerWidget* MetricPicker;
     UPROPERTY(meta = (BindWidget)) class UComboBoxString* TypeComboBox;
     UPROPERTY(meta = (BindWidget)) class UTextBlock* ResultText;
     UPROPERTY(meta = (BindWidget)) class ULineChartWidget* LineChartResult;
 
+    // *_bucket 的結果改畫熱圖 (有綁定時)，與 LineChartResult 擇一顯示
+    UPROPERTY(meta = (BindWidgetOptional)) class UHeatmapWidget* HeatmapResult;
+
     UFUNCTION()
     void OnMetricChanged(FString SelectedItem, ESelectInfo::Type SelectionType);
 
@@ -28,8 +50,10 @@ public:
 
     void InitializeOptions(APrometheusManager* Manager);
 
+    void OnMetricIndexReady(const TSharedPtr<const FPrometheusMetricIndex>& Index);
+
     UFUNCTION()
-    void OnMetricsReady(const TArray<FString>& Metrics);
+    void OnMetricPicked(const FString& Metric);
 
     FString SelectedMetric;
     FString SelectedType;
@@ -56,10 +80,76 @@ public:
     bool bMetricsInitialized = false;
 
     UFUNCTION()
-    void OnRangeQueryResponseReceived(const FString& PromQL, const TArray<FVector2D>& DataPoints);
+    void OnRangeQueryResponseReceived(const FString& PromQL, const FPrometheusRangeResult& Result);
+
+    UFUNCTION()
+    void InitializeChartWithHistory(const FPrometheusRangeResult& Result);
 
     UFUNCTION()
-    void InitializeChartWithHistory(const TArray<FVector2D>& DataPoints);
+    void OnRangeQueryDeltaReceived(const FString& PromQL, const FPrometheusRangeResult& NewSamples);
+
+    void AppendChartSamples(const FPrometheusRangeResult& NewSamples);
+
+    // 圖表縮放/平移到沒有資料的範圍，向 manager 要求對應解析度的歷史區塊
+    UFUNCTION()
+    void OnChartTileRequested(double StartTime, double EndTime, float StepSeconds);
+
+    // 由 UMonitoringItemData 轉送的訂閱結果
+    void OnRangeResultReceived(const FString& PromQL, const FPrometheusRangeResult& Result, bool bDelta);
+    void OnTileResultReceived(const FPrometheusRangeRequest& TileRequest, const FPrometheusRangeResult& Result);
+
+    UMonitoringItemData* GetItemData() const { return ItemData; }
+
 protected:
+    virtual void NativeDestruct() override;
+
+    // 有被畫出來才算可見 (列表外的項目沒有 widget，不會 paint)，圖表寬度讓 manager 決定 range query 的 step
+    virtual int32 NativePaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry,
+        const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements,
+        int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+
+    // UListView 把這個 widget 指派給某個項目 / 捲出畫面回收
+    virtual void NativeOnListItemObjectSet(UObject* ListItemObject) override;
+    virtual void NativeOnEntryReleased() override;
+
+    // 不在 UListView 中使用時 (例如直接放進 panel)，自己建立資料物件
+    UMonitoringItemData* GetOrCreateItemData();
+
+    // 依資料重建選單、數值與圖表，不送出新的查詢
+    void ApplyItemData();
+    void ReleaseItemData();
+
+    // 把目前的選擇交給資料物件，產生 PromQL 並送出查詢
+    void ApplySelection();
+
+    UPROPERTY(Transient)
+    TObjectPtr<UMonitoringItemData> ItemData;
+
+    // ApplyItemData 設定選單時不把選擇事件當成使用者操作
+    bool bApplyingItemData = false;
+
+    FDelegateHandle MetricIndexReadyHandle;
+
     APrometheusManager* ManagerRef;
+
+    // Raw 模式: 把 counter 轉成相鄰 sample 的差值 (在 worker 執行，不可存取 UObject)
+    static void ApplyCounterDelta(const FPrometheusSeries& Source, FCounterDeltaState& State, FPrometheusSeries& OutDeltas);
+
+    // 在 worker 做 Raw 轉換，完成後回到 game thread 更新圖表；bHistory 表示取代整個圖表
+    void LaunchCounterDeltaTransform(const FPrometheusRangeResult& Source, bool bHistory, uint32 TraceId);
+
+    TSharedRef<FCounterDeltaState, ESPMode::ThreadSafe> CounterDeltaState = MakeShared<FCounterDeltaState, ESPMode::ThreadSafe>();
+
+    // 轉換 task 依序串接，確保 history 與之後的 delta 順序正確
+    UE::Tasks::FTask PendingTransform;
+
+    // 每次重設圖表就遞增，丟棄舊選擇尚未完成的轉換結果
+    uint32 ChartGeneration = 0;
+
+    // 圖表目前資料所屬的 query 與類型，不同時才清掉圖表的歷史
+    FString ChartDataKey;
+
+    // 目前的 query 是 histogram bucket，資料送往 HeatmapResult
+    void SetShowHeatmap(bool bShow);
+    bool bShowingHeatmap = false;
 };
\ No newline at end of file
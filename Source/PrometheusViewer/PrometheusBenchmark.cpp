@@ -0,0 +1,755 @@
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Containers/StringConv.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Dom/JsonObject.h"
+#include "Dom/JsonValue.h"
+#include "PrometheusRangeParser.h"
+#include "PrometheusManager.h"
+#include "LineChartWidget.h"
+#include "Blueprint/UserWidget.h"
+#include "UObject/StrongObjectPtr.h"
+#include "Engine/World.h"
+#include "Containers/Ticker.h"
+#include "Async/Async.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonWriter.h"
+#include "Widgets/SVirtualWindow.h"
+#include "Rendering/DrawElements.h"
+#include "HttpModule.h"
+#include "PrometheusMockServer.h"
+
+#if !UE_BUILD_SHIPPING
+
+namespace PrometheusBenchmark
+{
+	// 產生 NumSeries x NumPoints 的 query_range 回應 (UTF-8)
+	static TArray<uint8> BuildRangePayload(int32 NumSeries, int32 NumPoints)
+	{
+		const int64 Start = FDateTime::UtcNow().ToUnixTimestamp() - NumPoints * 5;
+
+		FString Json = TEXT("{\"status\":\"success\",\"data\":{\"resultType\":\"matrix\",\"result\":[");
+		for (int32 s = 0; s < NumSeries; ++s)
+		{
+			if (s > 0)
+			{
+				Json += TEXT(",");
+			}
+			Json += FString::Printf(TEXT("{\"metric\":{\"__name__\":\"node_cpu_seconds_total\",\"instance\":\"10.0.%d.%d:9100\",\"job\":\"node\"},\"values\":["), s / 256, s % 256);
+			for (int32 p = 0; p < NumPoints; ++p)
+			{
+				if (p > 0)
+				{
+					Json += TEXT(",");
+				}
+				Json += FString::Printf(TEXT("[%lld.%03d,\"%.6f\"]"), Start + p * 5, p % 1000, FMath::Sin(p * 0.1f) * 100.0f + s);
+			}
+			Json += TEXT("]}");
+		}
+		Json += TEXT("]}}");
+
+		FTCHARToUTF8 Converter(*Json);
+		return TArray<uint8>(reinterpret_cast<const uint8*>(Converter.Get()), Converter.Length());
+	}
+
+	// 舊的 DOM 路徑: UTF-8 -> FString -> FJsonObject -> Atof
+	static int32 ParseWithDom(const TArray<uint8>& Body)
+	{
+		FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(Body.GetData()), Body.Num());
+		const FString JsonString(Converter.Length(), Converter.Get());
+
+		TArray<FVector2D> DataPoints;
+		TSharedPtr<FJsonObject> JsonObject;
+		TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(JsonString);
+
+		if (FJsonSerializer::Deserialize(Reader, JsonObject) && JsonObject.IsValid())
+		{
+			const TSharedPtr<FJsonObject>* DataObj;
+			const TArray<TSharedPtr<FJsonValue>>* ResultArray;
+			if (JsonObject->TryGetObjectField(TEXT("data"), DataObj) && (*DataObj)->TryGetArrayField(TEXT("result"), ResultArray))
+			{
+				for (const TSharedPtr<FJsonValue>& ResultEntry : *ResultArray)
+				{
+					TSharedPtr<FJsonObject> ResultObj = ResultEntry->AsObject();
+					const TArray<TSharedPtr<FJsonValue>>* ValuesArray;
+					if (ResultObj.IsValid() && ResultObj->TryGetArrayField(TEXT("values"), ValuesArray))
+					{
+						for (const TSharedPtr<FJsonValue>& V : *ValuesArray)
+						{
+							const TArray<TSharedPtr<FJsonValue>>* PointArray;
+							if (V->TryGetArray(PointArray) && PointArray->Num() == 2)
+							{
+								DataPoints.Add(FVector2D((*PointArray)[0]->AsNumber(), FCString::Atof(*(*PointArray)[1]->AsString())));
+							}
+						}
+					}
+				}
+			}
+		}
+		return DataPoints.Num();
+	}
+
+	static int32 ParseWithStreaming(const TArray<uint8>& Body, int32 ExpectedPoints)
+	{
+		FPrometheusRangeResult Result;
+		FPrometheusRangeParser::Parse(Body, ExpectedPoints, Result);
+		return Result.GetTotalPoints();
+	}
+
+	struct FRangeParseResult
+	{
+		int32 PayloadBytes = 0;
+		int32 DomSamples = 0;
+		int32 StreamSamples = 0;
+		double DomSeconds = 0.0;
+		double StreamSeconds = 0.0;
+	};
+
+	static FRangeParseResult MeasureRangeParse(int32 NumSeries, int32 NumPoints, int32 Iterations)
+	{
+		const TArray<uint8> Payload = BuildRangePayload(NumSeries, NumPoints);
+
+		FRangeParseResult Result;
+		Result.PayloadBytes = Payload.Num();
+
+		const double DomStart = FPlatformTime::Seconds();
+		for (int32 i = 0; i < Iterations; ++i)
+		{
+			Result.DomSamples = ParseWithDom(Payload);
+		}
+		Result.DomSeconds = (FPlatformTime::Seconds() - DomStart) / Iterations;
+
+		const double StreamStart = FPlatformTime::Seconds();
+		for (int32 i = 0; i < Iterations; ++i)
+		{
+			Result.StreamSamples = ParseWithStreaming(Payload, NumPoints);
+		}
+		Result.StreamSeconds = (FPlatformTime::Seconds() - StreamStart) / Iterations;
+		return Result;
+	}
+
+	static void RunRangeParse(const TArray<FString>& Args)
+	{
+		// 與 Prometheus.Bench.Run 相同的 Name=Value 參數
+		const FString Cmd = FString::Join(Args, TEXT(" "));
+		int32 NumSeries = 200;
+		int32 NumPoints = 61;
+		int32 Iterations = 20;
+		FParse::Value(*Cmd, TEXT("Series="), NumSeries);
+		FParse::Value(*Cmd, TEXT("Points="), NumPoints);
+		FParse::Value(*Cmd, TEXT("Iterations="), Iterations);
+		NumSeries = FMath::Max(NumSeries, 1);
+		NumPoints = FMath::Max(NumPoints, 1);
+		Iterations = FMath::Max(Iterations, 1);
+
+		const FRangeParseResult Result = MeasureRangeParse(NumSeries, NumPoints, Iterations);
+
+		UE_LOG(LogTemp, Display, TEXT("[Bench] RangeParse %d series x %d points (%d bytes, %d iterations)"),
+			NumSeries, NumPoints, Result.PayloadBytes, Iterations);
+		UE_LOG(LogTemp, Display, TEXT("[Bench]   DOM       %8.3f ms  %12.0f samples/s  (%d samples)"),
+			Result.DomSeconds * 1000.0, Result.DomSamples / FMath::Max(Result.DomSeconds, 1e-9), Result.DomSamples);
+		UE_LOG(LogTemp, Display, TEXT("[Bench]   Streaming %8.3f ms  %12.0f samples/s  (%d samples)  x%.1f"),
+			Result.StreamSeconds * 1000.0, Result.StreamSamples / FMath::Max(Result.StreamSeconds, 1e-9), Result.StreamSamples,
+			Result.DomSeconds / FMath::Max(Result.StreamSeconds, 1e-9));
+	}
+
+	static TSharedRef<FJsonObject> MakeLatencyJson(TArray<double> SamplesMs)
+	{
+		SamplesMs.Sort();
+		auto Percentile = [&SamplesMs](double Fraction)
+		{
+			return SamplesMs[FMath::Clamp(FMath::CeilToInt(Fraction * SamplesMs.Num()) - 1, 0, SamplesMs.Num() - 1)];
+		};
+
+		TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+		Json->SetNumberField(TEXT("count"), SamplesMs.Num());
+		if (SamplesMs.Num() > 0)
+		{
+			double Sum = 0.0;
+			for (double Sample : SamplesMs)
+			{
+				Sum += Sample;
+			}
+			Json->SetNumberField(TEXT("mean_ms"), Sum / SamplesMs.Num());
+			Json->SetNumberField(TEXT("min_ms"), SamplesMs[0]);
+			Json->SetNumberField(TEXT("p50_ms"), Percentile(0.5));
+			Json->SetNumberField(TEXT("p95_ms"), Percentile(0.95));
+			Json->SetNumberField(TEXT("max_ms"), SamplesMs.Last());
+		}
+		return Json;
+	}
+
+	struct FSuiteConfig
+	{
+		int32 NumSeries = 50;
+		int32 NumPoints = 61;
+		int32 Iterations = 20;
+		uint32 Port = 19090;
+		bool bGzip = false;
+		bool bExitWhenDone = false;
+	};
+
+	static FSuiteConfig ParseSuiteConfig(const TArray<FString>& Args)
+	{
+		FSuiteConfig Config;
+		const FString Cmd = FString::Join(Args, TEXT(" "));
+		FParse::Value(*Cmd, TEXT("Series="), Config.NumSeries);
+		FParse::Value(*Cmd, TEXT("Points="), Config.NumPoints);
+		FParse::Value(*Cmd, TEXT("Iterations="), Config.Iterations);
+		FParse::Value(*Cmd, TEXT("Port="), Config.Port);
+		Config.NumSeries = FMath::Max(Config.NumSeries, 1);
+		Config.NumPoints = FMath::Max(Config.NumPoints, 2);
+		Config.Iterations = FMath::Max(Config.Iterations, 1);
+		Config.bGzip = Args.Contains(TEXT("Gzip"));
+		Config.bExitWhenDone = Args.Contains(TEXT("Exit")) || FParse::Param(FCommandLine::Get(), TEXT("BenchExit"));
+		return Config;
+	}
+
+	/**
+	 * 依序量測: 解析吞吐量 -> 直接 HTTP 往返 -> 經由 APrometheusManager 的 range/instant 查詢派送到 widget
+	 * -> gzip 回應的 range 查詢 -> ULineChartWidget paint。HTTP 都是非同步的，每個回呼再送出下一個請求。
+	 * 結果寫成 JSON 到 Saved/Benchmarks。
+	 */
+	class FBenchmarkSuite : public TSharedFromThis<FBenchmarkSuite>
+	{
+	public:
+		static constexpr float StepSeconds = 5.0f;
+		static constexpr double StageTimeoutSeconds = 30.0;
+
+		FBenchmarkSuite(UWorld* InWorld, const FSuiteConfig& InConfig)
+			: World(InWorld)
+			, Config(InConfig)
+			, Results(MakeShared<FJsonObject>())
+		{
+		}
+
+		void Start()
+		{
+			TSharedRef<FJsonObject> ConfigJson = MakeShared<FJsonObject>();
+			ConfigJson->SetNumberField(TEXT("series"), Config.NumSeries);
+			ConfigJson->SetNumberField(TEXT("points"), Config.NumPoints);
+			ConfigJson->SetNumberField(TEXT("iterations"), Config.Iterations);
+			Results->SetNumberField(TEXT("version"), 1);
+			Results->SetStringField(TEXT("timestamp"), FDateTime::UtcNow().ToIso8601());
+			Results->SetStringField(TEXT("build"), LexToString(FApp::GetBuildConfiguration()));
+			Results->SetObjectField(TEXT("config"), ConfigJson);
+
+			BeginStage(TEXT("range_parse"));
+			RunParseStage();
+
+			BeginStage(TEXT("http_range"));
+			FPrometheusMockServer::FOptions Options;
+			Options.Port = Config.Port;
+			Options.NumSeries = Config.NumSeries;
+			Options.NumPoints = Config.NumPoints;
+			if (!Server.Start(Options))
+			{
+				Finish(TEXT("mock server failed to start"));
+				return;
+			}
+			TimeoutHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &FBenchmarkSuite::CheckTimeout), 1.0f);
+			SendHttpRequest();
+		}
+
+	private:
+		void BeginStage(const TCHAR* Name)
+		{
+			StageName = Name;
+			Iteration = 0;
+			RequestMs.Reset();
+			DispatchMs.Reset();
+			IngestMs.Reset();
+			StageProgressTime = FPlatformTime::Seconds();
+		}
+
+		bool CheckTimeout(float DeltaTime)
+		{
+			if (FPlatformTime::Seconds() - StageProgressTime > StageTimeoutSeconds)
+			{
+				Finish(FString::Printf(TEXT("timed out in %s"), *StageName));
+				return false;
+			}
+			return true;
+		}
+
+		void RunParseStage()
+		{
+			const FRangeParseResult Parse = MeasureRangeParse(Config.NumSeries, Config.NumPoints, Config.Iterations);
+
+			TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+			Json->SetNumberField(TEXT("payload_bytes"), Parse.PayloadBytes);
+			Json->SetNumberField(TEXT("dom_ms"), Parse.DomSeconds * 1000.0);
+			Json->SetNumberField(TEXT("dom_samples_per_sec"), Parse.DomSamples / FMath::Max(Parse.DomSeconds, 1e-9));
+			Json->SetNumberField(TEXT("streaming_ms"), Parse.StreamSeconds * 1000.0);
+			Json->SetNumberField(TEXT("streaming_samples_per_sec"), Parse.StreamSamples / FMath::Max(Parse.StreamSeconds, 1e-9));
+			Results->SetObjectField(StageName, Json);
+		}
+
+		// 不經過 manager 的 HTTP 往返，作為請求本身的基準
+		void SendHttpRequest()
+		{
+			if (Iteration >= Config.Iterations)
+			{
+				TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+				Json->SetNumberField(TEXT("payload_bytes"), Server.GetRangePayloadSize());
+				Json->SetObjectField(TEXT("request"), MakeLatencyJson(RequestMs));
+				Json->SetObjectField(TEXT("response"), MakeLatencyJson(DispatchMs));
+				Results->SetObjectField(StageName, Json);
+
+				StartManager();
+				return;
+			}
+
+			TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+			Request->SetURL(FString::Printf(TEXT("http://127.0.0.1:%u/api/v1/query_range?query=bench_metric&start=0&end=0&step=5"), Server.GetPort()));
+			Request->SetVerb(TEXT("GET"));
+			Request->OnProcessRequestComplete().BindSP(this, &FBenchmarkSuite::OnHttpResponse);
+
+			RequestStartTime = FPlatformTime::Seconds();
+			Request->ProcessRequest();
+		}
+
+		void OnHttpResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bSuccess)
+		{
+			if (!bSuccess || !Response.IsValid() || !EHttpResponseCodes::IsOk(Response->GetResponseCode()))
+			{
+				Finish(TEXT("mock server request failed"));
+				return;
+			}
+
+			const double Now = FPlatformTime::Seconds();
+			RequestMs.Add((Server.GetLastServedTime() - RequestStartTime) * 1000.0);
+			DispatchMs.Add((Now - Server.GetLastServedTime()) * 1000.0);
+			StageProgressTime = Now;
+
+			++Iteration;
+			SendHttpRequest();
+		}
+
+		void StartManager()
+		{
+			UWorld* InWorld = World.Get();
+			if (!InWorld)
+			{
+				Finish(TEXT("world is gone"));
+				return;
+			}
+
+			APrometheusManager* NewManager = InWorld->SpawnActorDeferred<APrometheusManager>(APrometheusManager::StaticClass(), FTransform::Identity);
+			NewManager->Target_IP = TEXT("127.0.0.1");
+			NewManager->TargetPort = Server.GetPort();
+
+			// 只量資料路徑: 不用磁碟快取、不做 count() 預查與自動 step；gzip 另外在 manager_gzip 量
+			NewManager->bUseSeriesCache = false;
+			NewManager->bEstimateSeriesCount = false;
+			NewManager->bAutoRangeStep = false;
+			NewManager->bRequestGzip = false;
+			NewManager->MaxTotalPoints = 0;
+			NewManager->FinishSpawning(FTransform::Identity);
+			Manager = NewManager;
+
+			Chart.Reset(CreateWidget<ULineChartWidget>(InWorld, ULineChartWidget::StaticClass()));
+			Chart->SetMaxPoints(Config.NumPoints);
+
+			BeginStage(TEXT("manager_range"));
+			SendManagerRangeQuery();
+		}
+
+		void SendManagerRangeQuery()
+		{
+			if (Iteration >= Config.Iterations)
+			{
+				TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+				Json->SetNumberField(TEXT("samples"), LastRangeResult.GetTotalPoints());
+				Json->SetObjectField(TEXT("request"), MakeLatencyJson(RequestMs));
+				Json->SetObjectField(TEXT("dispatch"), MakeLatencyJson(DispatchMs));
+				Json->SetObjectField(TEXT("widget_ingest"), MakeLatencyJson(IngestMs));
+				Results->SetObjectField(StageName, Json);
+
+				BeginStage(TEXT("manager_instant"));
+				SendManagerInstantQuery();
+				return;
+			}
+
+			// 每次用不同的 PromQL，避開 broker 的請求合併與本輪結果快取
+			const FString PromQL = FString::Printf(TEXT("bench_metric{iteration=\"%d\"}"), Iteration);
+			Subscription = Manager->Subscribe(PromQL, Chart.Get(), FOnPrometheusInstantResult(),
+				FOnPrometheusRangeResult::CreateSP(this, &FBenchmarkSuite::OnManagerRangeResult));
+
+			RequestStartTime = FPlatformTime::Seconds();
+			Manager->HandleRangeQuery(PromQL, (Config.NumPoints - 1) * StepSeconds, StepSeconds);
+		}
+
+		void OnManagerRangeResult(const FString& PromQL, const FPrometheusRangeResult& Result, bool bDelta)
+		{
+			const double Now = FPlatformTime::Seconds();
+			RequestMs.Add((Server.GetLastServedTime() - RequestStartTime) * 1000.0);
+			DispatchMs.Add((Now - Server.GetLastServedTime()) * 1000.0);
+
+			const double IngestStart = FPlatformTime::Seconds();
+			Chart->SetSeriesData(Result);
+			IngestMs.Add((FPlatformTime::Seconds() - IngestStart) * 1000.0);
+
+			LastRangeResult = Result;
+			StageProgressTime = Now;
+			++Iteration;
+
+			// 不在派送途中取消訂閱與送出下一個請求
+			TWeakPtr<FBenchmarkSuite> WeakSuite = AsShared();
+			AsyncTask(ENamedThreads::GameThread, [WeakSuite]()
+			{
+				TSharedPtr<FBenchmarkSuite> Suite = WeakSuite.Pin();
+				if (Suite && Suite->Manager.IsValid())
+				{
+					Suite->Manager->Unsubscribe(Suite->Subscription);
+					Suite->SendManagerRangeQuery();
+				}
+			});
+		}
+
+		void SendManagerInstantQuery()
+		{
+			if (Iteration >= Config.Iterations)
+			{
+				TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+				Json->SetObjectField(TEXT("request"), MakeLatencyJson(RequestMs));
+				Json->SetObjectField(TEXT("dispatch"), MakeLatencyJson(DispatchMs));
+				Results->SetObjectField(StageName, Json);
+
+				BeginStage(TEXT("manager_gzip"));
+				StartGzipStage();
+				return;
+			}
+
+			const FString PromQL = FString::Printf(TEXT("bench_metric{iteration=\"%d\"}"), Iteration);
+			Subscription = Manager->Subscribe(PromQL, Chart.Get(),
+				FOnPrometheusInstantResult::CreateSP(this, &FBenchmarkSuite::OnManagerInstantResult), FOnPrometheusRangeResult());
+
+			RequestStartTime = FPlatformTime::Seconds();
+			Manager->HandleQuery(PromQL);
+		}
+
+		void OnManagerInstantResult(const FString& PromQL, const FString& Value)
+		{
+			const double Now = FPlatformTime::Seconds();
+			RequestMs.Add((Server.GetLastServedTime() - RequestStartTime) * 1000.0);
+			DispatchMs.Add((Now - Server.GetLastServedTime()) * 1000.0);
+			StageProgressTime = Now;
+			++Iteration;
+
+			TWeakPtr<FBenchmarkSuite> WeakSuite = AsShared();
+			AsyncTask(ENamedThreads::GameThread, [WeakSuite]()
+			{
+				TSharedPtr<FBenchmarkSuite> Suite = WeakSuite.Pin();
+				if (Suite && Suite->Manager.IsValid())
+				{
+					Suite->Manager->Unsubscribe(Suite->Subscription);
+					Suite->SendManagerInstantQuery();
+				}
+			});
+		}
+
+		// 同樣的 range 查詢改由 mock 以 gzip 回應，走 DecodeResponseBody 的解壓縮路徑
+		void StartGzipStage()
+		{
+			Server.SetGzip(true);
+			Manager->bRequestGzip = true;
+
+			GzipStart.ReceivedCompressed = Manager->ReceivedCompressedBytes;
+			GzipStart.ReceivedUncompressed = Manager->ReceivedUncompressedBytes;
+			GzipStart.ServedBody = Server.GetServedBodyBytes();
+			GzipStart.ServedPayload = Server.GetServedPayloadBytes();
+			GzipStart.GzipResponses = Server.GetNumGzipServed();
+			GzipSampleMismatches = 0;
+
+			SendGzipRangeQuery();
+		}
+
+		void SendGzipRangeQuery()
+		{
+			if (Iteration >= Config.Iterations)
+			{
+				FinishGzipStage();
+				return;
+			}
+
+			const FString PromQL = FString::Printf(TEXT("bench_metric{gzip=\"%d\"}"), Iteration);
+			Subscription = Manager->Subscribe(PromQL, Chart.Get(), FOnPrometheusInstantResult(),
+				FOnPrometheusRangeResult::CreateSP(this, &FBenchmarkSuite::OnGzipRangeResult));
+
+			RequestStartTime = FPlatformTime::Seconds();
+			Manager->HandleRangeQuery(PromQL, (Config.NumPoints - 1) * StepSeconds, StepSeconds);
+		}
+
+		void OnGzipRangeResult(const FString& PromQL, const FPrometheusRangeResult& Result, bool bDelta)
+		{
+			const double Now = FPlatformTime::Seconds();
+			RequestMs.Add((Server.GetLastServedTime() - RequestStartTime) * 1000.0);
+			DispatchMs.Add((Now - Server.GetLastServedTime()) * 1000.0);
+
+			// 解壓縮後的內容與未壓縮的 manager_range 相同，sample 數也要相同
+			if (Result.GetTotalPoints() != LastRangeResult.GetTotalPoints())
+			{
+				++GzipSampleMismatches;
+			}
+			StageProgressTime = Now;
+			++Iteration;
+
+			TWeakPtr<FBenchmarkSuite> WeakSuite = AsShared();
+			AsyncTask(ENamedThreads::GameThread, [WeakSuite]()
+			{
+				TSharedPtr<FBenchmarkSuite> Suite = WeakSuite.Pin();
+				if (Suite && Suite->Manager.IsValid())
+				{
+					Suite->Manager->Unsubscribe(Suite->Subscription);
+					Suite->SendGzipRangeQuery();
+				}
+			});
+		}
+
+		void FinishGzipStage()
+		{
+			Server.SetGzip(false);
+			Manager->bRequestGzip = false;
+
+			const int64 ReceivedCompressed = Manager->ReceivedCompressedBytes - GzipStart.ReceivedCompressed;
+			const int64 ReceivedUncompressed = Manager->ReceivedUncompressedBytes - GzipStart.ReceivedUncompressed;
+			const int64 ServedBody = Server.GetServedBodyBytes() - GzipStart.ServedBody;
+			const int64 ServedPayload = Server.GetServedPayloadBytes() - GzipStart.ServedPayload;
+			const int64 GzipResponses = Server.GetNumGzipServed() - GzipStart.GzipResponses;
+
+			TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+			Json->SetNumberField(TEXT("samples"), LastRangeResult.GetTotalPoints());
+			Json->SetNumberField(TEXT("sample_mismatches"), GzipSampleMismatches);
+			Json->SetNumberField(TEXT("gzip_responses"), GzipResponses);
+			Json->SetNumberField(TEXT("served_body_bytes"), ServedBody);
+			Json->SetNumberField(TEXT("served_payload_bytes"), ServedPayload);
+			Json->SetNumberField(TEXT("received_compressed_bytes"), ReceivedCompressed);
+			Json->SetNumberField(TEXT("received_uncompressed_bytes"), ReceivedUncompressed);
+			Json->SetNumberField(TEXT("compression_ratio"), ReceivedUncompressed / FMath::Max<double>(ReceivedCompressed, 1.0));
+			Json->SetObjectField(TEXT("request"), MakeLatencyJson(RequestMs));
+			Json->SetObjectField(TEXT("dispatch"), MakeLatencyJson(DispatchMs));
+			Results->SetObjectField(StageName, Json);
+
+			if (GzipSampleMismatches > 0)
+			{
+				Finish(FString::Printf(TEXT("%d gzip responses decoded to a different sample count"), GzipSampleMismatches));
+				return;
+			}
+			if (GzipResponses < Config.Iterations)
+			{
+				Finish(FString::Printf(TEXT("only %lld of %d range responses were served gzip"), GzipResponses, Config.Iterations));
+				return;
+			}
+			// manager 收到的是壓縮後的 body，才表示解壓縮是 DecodeResponseBody 做的，不是 HTTP 層
+			if (ReceivedCompressed != ServedBody || ReceivedUncompressed != ServedPayload || ReceivedCompressed >= ReceivedUncompressed)
+			{
+				Finish(FString::Printf(TEXT("gzip byte counts do not match: received %lld/%lld bytes, served %lld/%lld bytes (compressed/uncompressed)"),
+					ReceivedCompressed, ReceivedUncompressed, ServedBody, ServedPayload));
+				return;
+			}
+
+			BeginStage(TEXT("chart_paint"));
+			RunChartPaint();
+			Finish();
+		}
+
+		// 不需要 RHI: 直接把 widget paint 到 element list，量的是 CPU 端的 paint 成本
+		void RunChartPaint()
+		{
+			const FVector2D ChartSize(1280.0, 400.0);
+			const TSharedRef<SVirtualWindow> Window = SNew(SVirtualWindow).Size(ChartSize);
+			const TSharedRef<SWidget> ChartWidget = Chart->TakeWidget();
+			ChartWidget->SlatePrepass(1.0f);
+
+			const FGeometry Geometry = FGeometry::MakeRoot(ChartSize, FSlateLayoutTransform());
+			const FSlateRect CullingRect(FVector2D::ZeroVector, ChartSize);
+			auto Paint = [&]()
+			{
+				FSlateWindowElementList ElementList(Window);
+				FPaintArgs PaintArgs(nullptr, Window->GetHittestGrid(), FVector2D::ZeroVector, FApp::GetCurrentTime(), FApp::GetDeltaTime());
+
+				const double Start = FPlatformTime::Seconds();
+				ChartWidget->Paint(PaintArgs, Geometry, CullingRect, ElementList, 0, FWidgetStyle(), true);
+				return (FPlatformTime::Seconds() - Start) * 1000.0;
+			};
+
+			// 資料剛換掉: 需要重建 decimation 與投影快取
+			TArray<double> ColdMs;
+			for (int32 i = 0; i < Config.Iterations; ++i)
+			{
+				Chart->SetSeriesData(LastRangeResult);
+				ColdMs.Add(Paint());
+			}
+
+			// 資料與尺寸不變: 只重畫快取的幾何
+			TArray<double> WarmMs;
+			for (int32 i = 0; i < Config.Iterations; ++i)
+			{
+				WarmMs.Add(Paint());
+			}
+
+			TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+			Json->SetNumberField(TEXT("width"), ChartSize.X);
+			Json->SetNumberField(TEXT("height"), ChartSize.Y);
+			Json->SetNumberField(TEXT("samples"), LastRangeResult.GetTotalPoints());
+			Json->SetObjectField(TEXT("cold"), MakeLatencyJson(ColdMs));
+			Json->SetObjectField(TEXT("warm"), MakeLatencyJson(WarmMs));
+			Results->SetObjectField(StageName, Json);
+		}
+
+		void Finish(const FString& Error = FString());
+
+		TWeakObjectPtr<UWorld> World;
+		FSuiteConfig Config;
+		FPrometheusMockServer Server;
+		TSharedRef<FJsonObject> Results;
+
+		TWeakObjectPtr<APrometheusManager> Manager;
+		TStrongObjectPtr<ULineChartWidget> Chart;
+		FPrometheusSubscriptionHandle Subscription;
+		FPrometheusRangeResult LastRangeResult;
+
+		// manager_gzip 開始時的累計值，結束時取差值比對
+		struct FGzipCounters
+		{
+			int64 ReceivedCompressed = 0;
+			int64 ReceivedUncompressed = 0;
+			int64 ServedBody = 0;
+			int64 ServedPayload = 0;
+			int64 GzipResponses = 0;
+		};
+		FGzipCounters GzipStart;
+		int32 GzipSampleMismatches = 0;
+
+		// 目前階段，超過 StageTimeoutSeconds 沒有進度就放棄
+		FString StageName;
+		double StageProgressTime = 0.0;
+		FTSTicker::FDelegateHandle TimeoutHandle;
+
+		int32 Iteration = 0;
+		double RequestStartTime = 0.0;
+		TArray<double> RequestMs;
+		TArray<double> DispatchMs;
+		TArray<double> IngestMs;
+	};
+
+	// 同一時間只跑一組
+	static TSharedPtr<FBenchmarkSuite> GActiveSuite;
+
+	void FBenchmarkSuite::Finish(const FString& Error)
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(TimeoutHandle);
+		if (Manager.IsValid())
+		{
+			Manager->Unsubscribe(Subscription);
+			Manager->Destroy();
+		}
+		Chart.Reset();
+		Server.Stop();
+
+		Results->SetStringField(TEXT("status"), Error.IsEmpty() ? TEXT("ok") : TEXT("failed"));
+		if (!Error.IsEmpty())
+		{
+			Results->SetStringField(TEXT("error"), Error);
+		}
+
+		FString Json;
+		const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+		FJsonSerializer::Serialize(Results, Writer);
+
+		const FString Path = FPaths::ProjectSavedDir() / TEXT("Benchmarks") /
+			FString::Printf(TEXT("PrometheusBench-%s.json"), *FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S")));
+		if (FFileHelper::SaveStringToFile(Json, *Path, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+		{
+			UE_LOG(LogTemp, Display, TEXT("[Bench] Results written to %s"), *FPaths::ConvertRelativePathToFull(Path));
+		}
+		if (!Error.IsEmpty())
+		{
+			UE_LOG(LogTemp, Error, TEXT("[Bench] Suite failed: %s"), *Error);
+		}
+		UE_LOG(LogTemp, Display, TEXT("[Bench] %s"), *Json);
+
+		if (Config.bExitWhenDone)
+		{
+			FPlatformMisc::RequestExit(false);
+		}
+
+		// 可能還在自己的回呼裡，下一個 tick 再釋放
+		AsyncTask(ENamedThreads::GameThread, []()
+		{
+			GActiveSuite.Reset();
+		});
+	}
+
+	static void RunSuite(const TArray<FString>& Args, UWorld* World)
+	{
+		if (GActiveSuite.IsValid())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[Bench] A benchmark suite is already running"));
+			return;
+		}
+		if (!World)
+		{
+			UE_LOG(LogTemp, Error, TEXT("[Bench] Prometheus.Bench.Run needs a world"));
+			return;
+		}
+
+		GActiveSuite = MakeShared<FBenchmarkSuite>(World, ParseSuiteConfig(Args));
+		GActiveSuite->Start();
+	}
+
+	static TUniquePtr<FPrometheusMockServer> GMockServer;
+
+	static void RunMockServer(const TArray<FString>& Args)
+	{
+		if (Args.Num() > 0 && Args[0] == TEXT("Stop"))
+		{
+			if (GMockServer)
+			{
+				GMockServer->Stop();
+				GMockServer.Reset();
+			}
+			return;
+		}
+
+		const FSuiteConfig Config = ParseSuiteConfig(Args);
+		if (!GMockServer)
+		{
+			GMockServer = MakeUnique<FPrometheusMockServer>();
+		}
+
+		// 給實際的 dashboard 連線用，range query 依請求的範圍產生資料
+		FPrometheusMockServer::FOptions Options;
+		Options.Port = Config.Port;
+		Options.NumSeries = Config.NumSeries;
+		Options.NumPoints = Config.NumPoints;
+		Options.bDynamicRanges = true;
+		Options.bGzip = Config.bGzip;
+		GMockServer->Start(Options);
+	}
+}
+
+static FAutoConsoleCommand GPrometheusBenchRangeParseCommand(
+	TEXT("Prometheus.Bench.RangeParse"),
+	TEXT("Compare DOM vs streaming query_range parsing. Usage: Prometheus.Bench.RangeParse [Series=200] [Points=61] [Iterations=20]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&PrometheusBenchmark::RunRangeParse));
+
+static FAutoConsoleCommandWithWorldAndArgs GPrometheusBenchRunCommand(
+	TEXT("Prometheus.Bench.Run"),
+	TEXT("Run the data path benchmarks against a local mock Prometheus and write JSON to Saved/Benchmarks. ")
+	TEXT("Usage: Prometheus.Bench.Run [Series=50] [Points=61] [Iterations=20] [Port=19090] [Exit]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&PrometheusBenchmark::RunSuite));
+
+static FAutoConsoleCommand GPrometheusBenchMockServerCommand(
+	TEXT("Prometheus.Bench.MockServer"),
+	TEXT("Start or stop a mock Prometheus serving synthetic payloads. Usage: Prometheus.Bench.MockServer [Stop] [Series=50] [Points=61] [Port=19090] [Gzip]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&PrometheusBenchmark::RunMockServer));
+
+#endif
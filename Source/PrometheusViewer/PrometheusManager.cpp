@@ -15,18 +15,19 @@
 #include "Math/Vector2D.h"
 #include "MonitoringItemWidget.h"
 #include "DashboardWidget.h"
+#include "PrometheusRangeParser.h"
+#include "Async/Async.h"
+#include "Tasks/Task.h"
+#include "Misc/Compression.h"
+#include "Misc/ScopeExit.h"
+#include "PrometheusViewerStats.h"
+#include "PrometheusQueryTrace.h"
 
 APrometheusManager::APrometheusManager()
 {
 	PrimaryActorTick.bCanEverTick = false;
 }
 
-void APrometheusManager::AddDynamicQuery(const FPrometheusQueryInfo& Info)
-{
-	QueryList.Add(Info);
-	QueryTextMap.Add(Info.Description, Info.UITextRef);
-}
-
 void APrometheusManager::BeginPlay()
 {
 	Super::BeginPlay();
@@ -52,10 +53,35 @@ void APrometheusManager::BeginPlay()
 
 	LoadPromQLMappings();
 
-	GetWorld()->GetTimerManager().SetTimer(AutoQueryTimer, this, &APrometheusManager::ExecuteAutoQueries, 5.0f, true);
+	if (bUseSeriesCache)
+	{
+		SeriesCache = MakeUnique<FPrometheusSeriesCache>(FPaths::ProjectSavedDir() / TEXT("PrometheusCache"),
+			int64(SeriesCacheMaxFileMB) * 1024 * 1024, int64(SeriesCacheMaxTotalMB) * 1024 * 1024);
+	}
+
+	// 排程器只檢查到期時間，每個 query 的實際間隔由 QuerySchedules 決定
+	GetWorld()->GetTimerManager().SetTimer(AutoQueryTimer, this, &APrometheusManager::ExecuteAutoQueries, 0.25f, true);
+
+	if (bServeMetrics)
+	{
+		FPrometheusViewerStats::Get().StartMetricsEndpoint(MetricsPort);
+	}
 }
 
 
+void APrometheusManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// 等背景寫入完成，下次啟動才讀得到完整的快取
+	SeriesCache.Reset();
+
+	if (bServeMetrics)
+	{
+		FPrometheusViewerStats::Get().StopMetricsEndpoint();
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 void APrometheusManager::ShowDashboard()
 {
 	if (CurrentWidget)
@@ -84,107 +110,348 @@ void APrometheusManager::ShowDashboard()
 	}
 }
 
+double APrometheusManager::AlignTime(double Time, double StepSeconds)
+{
+	return StepSeconds > 0.0 ? FMath::FloorToDouble(Time / StepSeconds) * StepSeconds : Time;
+}
+
+void APrometheusManager::PruneCompletedResults(double Now)
+{
+	for (auto It = CompletedInstantResults.CreateIterator(); It; ++It)
+	{
+		if (It->Value.ExpireTime <= Now)
+		{
+			It.RemoveCurrent();
+		}
+	}
+	for (auto It = CompletedRangeResults.CreateIterator(); It; ++It)
+	{
+		if (It->Value.ExpireTime <= Now)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+FString APrometheusManager::GetBaseUrl() const
+{
+	return FString::Printf(TEXT("http://%s:%d"), *Target_IP, TargetPort);
+}
+
+void APrometheusManager::SetCommonHeaders(IHttpRequest& Request) const
+{
+	Request.SetVerb(TEXT("GET"));
+	Request.SetHeader(TEXT("Authorization"), "Basic " + FBase64::Encode(Account + ":" + Password));
+	Request.SetHeader(TEXT("Content-Type"), TEXT("application/json"));
+	if (bRequestGzip)
+	{
+		Request.SetHeader(TEXT("Accept-Encoding"), TEXT("gzip"));
+	}
+}
+
+bool APrometheusManager::DecodeResponseBody(const FHttpResponsePtr& Response, TArrayView<const uint8>& OutBody)
+{
+	// 每個 worker thread 重複使用同一塊解壓縮 buffer，上次的 body 太大時先釋放
+	thread_local TArray<uint8> DecompressBuffer;
+	if (DecompressBuffer.Max() > RetainedDecompressBytes)
+	{
+		DecompressBuffer.Empty();
+	}
+
+	const TArray<uint8>& Content = Response->GetContent();
+	OutBody = Content;
+
+	// 只看 gzip magic，HTTP 層已經解壓縮過的內容直接使用
+	const int32 Num = Content.Num();
+	if (Num < 18 || Content[0] != 0x1f || Content[1] != 0x8b)
+	{
+		return true;
+	}
+
+	// gzip trailer 最後 4 bytes 是原始大小 (little endian)，由 server 決定，不能直接拿來配置記憶體:
+	// 超過上限或超過 deflate 可能的最大壓縮比都當作壞掉的回應
+	const uint32 UncompressedSize = uint32(Content[Num - 4]) | (uint32(Content[Num - 3]) << 8) | (uint32(Content[Num - 2]) << 16) | (uint32(Content[Num - 1]) << 24);
+	const int64 MaxSize = FMath::Min<int64>(MaxDecompressedBytes, int64(Num) * MaxDeflateRatio);
+	if (int64(UncompressedSize) > MaxSize)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[PrometheusManager] Rejected gzip body: %u bytes declared for %d compressed bytes"), UncompressedSize, Num);
+		return false;
+	}
+
+	DecompressBuffer.SetNumUninitialized(UncompressedSize, EAllowShrinking::No);
+	if (!FCompression::UncompressMemory(NAME_Gzip, DecompressBuffer.GetData(), UncompressedSize, Content.GetData(), Num))
+	{
+		return false;
+	}
+
+	OutBody = DecompressBuffer;
+	return true;
+}
+
+FString APrometheusManager::BodyToString(TArrayView<const uint8> Body)
+{
+	FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Body.GetData()), Body.Num());
+	return FString(Converted.Length(), Converted.Get());
+}
+
+void APrometheusManager::RecordTransferBytes(int64 CompressedBytes, int64 UncompressedBytes)
+{
+	ReceivedCompressedBytes += CompressedBytes;
+	ReceivedUncompressedBytes += UncompressedBytes;
+	FPrometheusViewerStats::Get().RecordBytesReceived(CompressedBytes, UncompressedBytes);
+}
+
+FString APrometheusManager::ParseInstantQueryValue(const FString& Content)
+{
+	FString ResultValue = TEXT("N/A");
+
+	TSharedPtr<FJsonObject> Json;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Content);
+
+	if (FJsonSerializer::Deserialize(Reader, Json))
+	{
+		const TSharedPtr<FJsonObject>* Data;
+		const TArray<TSharedPtr<FJsonValue>>* ResultArray;
+		if (Json->TryGetObjectField(TEXT("data"), Data) && (*Data)->TryGetArrayField(TEXT("result"), ResultArray) && ResultArray->Num() > 0)
+		{
+			const TSharedPtr<FJsonObject>* First;
+			if ((*ResultArray)[0]->TryGetObject(First))
+			{
+				const TArray<TSharedPtr<FJsonValue>>* ValueArray;
+				if ((*First)->TryGetArrayField(TEXT("value"), ValueArray) && ValueArray->Num() > 1)
+				{
+					ResultValue = (*ValueArray)[1]->AsString();
+				}
+			}
+		}
+	}
+	return ResultValue;
+}
+
+TArray<FString> APrometheusManager::ParseMetricNames(const FString& Content)
+{
+	TArray<FString> Metrics;
+
+	TSharedPtr<FJsonObject> Json;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Content);
+
+	if (FJsonSerializer::Deserialize(Reader, Json))
+	{
+		const TArray<TSharedPtr<FJsonValue>>* DataArray;
+		if (Json->TryGetArrayField(TEXT("data"), DataArray))
+		{
+			Metrics.Reserve(DataArray->Num());
+			for (const TSharedPtr<FJsonValue>& Value : *DataArray)
+			{
+				Metrics.Add(Value->AsString());
+			}
+		}
+	}
+	return Metrics;
+}
+
 void APrometheusManager::HandleQuery(const FString& PromQL)
 {
+	// 以對齊後的時間評估，同一個 refresh 內相同 PromQL 的請求 key 相同
+	const double Now = FDateTime::UtcNow().ToUnixTimestamp();
+	const double AlignedTime = AlignTime(Now, RangeStepSeconds);
+	const FString RequestKey = FString::Printf(TEXT("query|%s|%.0f"), *PromQL, AlignedTime);
+
+	PruneCompletedResults(Now);
+
+	if (FPrometheusInFlightRequest* InFlight = InFlightRequests.Find(RequestKey))
+	{
+		// 已有相同請求在路上，結果廣播時一併收到
+		++InFlight->NumWaiters;
+		return;
+	}
+	if (const FPrometheusCachedInstantResult* Cached = CompletedInstantResults.Find(RequestKey))
+	{
+		DispatchInstantResult(PromQL, Cached->Value);
+		return;
+	}
+
 	FString Encoded = FGenericPlatformHttp::UrlEncode(PromQL);
-	FString URL = FString::Printf(TEXT("http://%s:9090/api/v1/query?query=%s"), *Target_IP, *Encoded);
+	FString URL = FString::Printf(TEXT("%s/api/v1/query?query=%s&time=%.0f"), *GetBaseUrl(), *Encoded, AlignedTime);
 
-	TSharedRef<IHttpRequest> Request = FHttpModule::Get().CreateRequest();
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
 	Request->SetURL(URL);
-	Request->SetVerb(TEXT("GET"));
-	Request->SetHeader(TEXT("Authorization"), "Basic " + FBase64::Encode(Account + ":" + Password));
-	Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
-	Request->SetHeader(TEXT("PromQL"), PromQL); // 紀錄 PromQL 傳回時對應
+	SetCommonHeaders(*Request);
 
+	TWeakObjectPtr<APrometheusManager> WeakThis(this);
 	Request->OnProcessRequestComplete().BindLambda(
-		[this](FHttpRequestPtr Req, FHttpResponsePtr Resp, bool bSuccess)
+		[WeakThis, RequestKey, AlignedTime, PromQL](FHttpRequestPtr Req, FHttpResponsePtr Resp, bool bSuccess)
 		{
-			//檢查HTTP狀態碼
-			if (Resp.IsValid())
+			APrometheusManager* Manager = WeakThis.Get();
+			if (!Manager)
+			{
+				return;
+			}
+			Manager->OnHttpRequestFinished(Req);
+
+			// 已被新的選擇取代 (或被取消)，不解析直接丟棄
+			if (!Manager->IsRequestCurrent(RequestKey, Req))
+			{
+				return;
+			}
+
+			const bool bOk = bSuccess && Resp.IsValid() && EHttpResponseCodes::IsOk(Resp->GetResponseCode());
+
+			//檢查HTTP狀態碼，成功的請求每次 refresh 都有，只在 VeryVerbose 輸出
+			if (Resp.IsValid() && !bOk)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("HTTP Status Code: %d (%s)"), Resp->GetResponseCode(), *PromQL);
+			}
+			else if (Resp.IsValid())
 			{
-				UE_LOG(LogTemp, Warning, TEXT("HTTP Status Code: %d"), Resp->GetResponseCode());
+				UE_LOG(LogTemp, VeryVerbose, TEXT("HTTP Status Code: %d"), Resp->GetResponseCode());
 			}
-			FString ResultValue = TEXT("N/A");
-			FString PromQL = Req->GetHeader(TEXT("PromQL"));
 
-			if (bSuccess && Resp.IsValid())
+			// JSON 解析在 worker 執行，只把結果字串送回 game thread
+			UE::Tasks::Launch(UE_SOURCE_LOCATION, [WeakThis, RequestKey, AlignedTime, PromQL, Req, Resp, bSuccess, bOk]()
 			{
-				TSharedPtr<FJsonObject> Json;
-				TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Resp->GetContentAsString());
+				TRACE_CPUPROFILER_EVENT_SCOPE(PrometheusManager_ParseInstantQuery);
+				SCOPE_CYCLE_COUNTER(STAT_PrometheusViewer_ParseInstant);
+				FPrometheusViewerScopeTimer ParseTimer(FPrometheusViewerStats::Get().ParseTime);
+
+				FString ResultValue = TEXT("N/A");
+				int64 CompressedBytes = 0;
+				int64 UncompressedBytes = 0;
+				TArrayView<const uint8> Body;
+				if (bSuccess && Resp.IsValid() && DecodeResponseBody(Resp, Body))
+				{
+					CompressedBytes = Resp->GetContent().Num();
+					UncompressedBytes = Body.Num();
+					ResultValue = ParseInstantQueryValue(BodyToString(Body));
+				}
 
-				if (FJsonSerializer::Deserialize(Reader, Json))
+				AsyncTask(ENamedThreads::GameThread, [WeakThis, RequestKey, AlignedTime, PromQL, Req, ResultValue = MoveTemp(ResultValue), bOk, CompressedBytes, UncompressedBytes]()
 				{
-					const TArray<TSharedPtr<FJsonValue>>* ResultArray;
-					if (Json->GetObjectField("data")->TryGetArrayField("result", ResultArray) && ResultArray->Num() > 0)
+					APrometheusManager* This = WeakThis.Get();
+					if (!This)
 					{
-						const TSharedPtr<FJsonObject>* First;
-						if ((*ResultArray)[0]->TryGetObject(First))
-						{
-							const TArray<TSharedPtr<FJsonValue>>* ValueArray;
-							if ((*First)->TryGetArrayField("value", ValueArray) && ValueArray->Num() > 1)
-							{
-								ResultValue = (*ValueArray)[1]->AsString();
-							}
-						}
+						return;
 					}
-				}
-			}
-			// 廣播結果讓外部處理
-			OnQueryResponse.Broadcast(PromQL, ResultValue);
+
+					SCOPE_CYCLE_COUNTER(STAT_PrometheusViewer_Dispatch);
+					FPrometheusViewerScopeTimer DispatchTimer(FPrometheusViewerStats::Get().DispatchTime);
+					const double DispatchStart = FPlatformTime::Seconds();
+					ON_SCOPE_EXIT
+					{
+						This->GameThreadQuerySeconds += FPlatformTime::Seconds() - DispatchStart;
+					};
+
+					This->RecordTransferBytes(CompressedBytes, UncompressedBytes);
+					if (!This->IsRequestCurrent(RequestKey, Req))
+					{
+						return;
+					}
+
+					This->InFlightRequests.Remove(RequestKey);
+					This->ReportQueryResult(PromQL, bOk);
+					if (bOk)
+					{
+						FPrometheusCachedInstantResult& Cached = This->CompletedInstantResults.Add(RequestKey);
+						Cached.ExpireTime = AlignedTime + This->RangeStepSeconds;
+						Cached.Value = ResultValue;
+					}
+
+					// 只派送給訂閱這個 query 的 widget
+					This->DispatchInstantResult(PromQL, ResultValue);
+				});
+			});
 		}
 	);
 
-	Request->ProcessRequest();
-	UE_LOG(LogTemp, Warning, TEXT("[HandleQuery] Executing PromQL: %s"), *PromQL);
+	FPrometheusInFlightRequest& InFlight = InFlightRequests.Add(RequestKey);
+	InFlight.HttpRequest = Request;
+	InFlight.PromQL = PromQL;
+	InFlight.Generation = GetQueryGeneration(PromQL);
+	EnqueueHttpRequest(Request, PromQL, GetRequestPriority(PromQL));
+	UE_LOG(LogTemp, VeryVerbose, TEXT("[HandleQuery] Executing PromQL: %s"), *PromQL);
 }
 
-void APrometheusManager::FetchAvailableMetrics()
+void APrometheusManager::BroadcastMetricsFetched(const TSharedPtr<const FPrometheusMetricIndex>& Index)
 {
+	OnMetricIndexReady.Broadcast(Index);
+
+	if (OnMetricsFetched.IsBound())
+	{
+		TArray<FString> Metrics;
+		Metrics.Reserve(Index->Num());
+		for (const TSharedPtr<const FString>& Name : Index->GetNames())
+		{
+			Metrics.Add(*Name);
+		}
+		OnMetricsFetched.Broadcast(Metrics);
+	}
+}
 
-	if (bMetricsFetched)
+void APrometheusManager::FetchAvailableMetrics()
+{
+	// 已經有索引的 widget 直接用 GetMetricIndex()，這裡只負責抓一次
+	if (bMetricsFetched || bMetricsFetchInFlight)
 	{
-		OnMetricsFetched.Broadcast(CachedMetrics);
 		return;
 	}
-	FString URL = FString::Printf(TEXT("http://%s:9090/api/v1/label/__name__/values"), *Target_IP);
+	bMetricsFetchInFlight = true;
 
-	TSharedRef<IHttpRequest> Request = FHttpModule::Get().CreateRequest();
+	FString URL = FString::Printf(TEXT("%s/api/v1/label/__name__/values"), *GetBaseUrl());
+
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
 	Request->SetURL(URL);
-	Request->SetVerb(TEXT("GET"));
-	Request->SetHeader(TEXT("Authorization"), "Basic " + FBase64::Encode(Account + ":" + Password));
-	Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
+	SetCommonHeaders(*Request);
 
+	TWeakObjectPtr<APrometheusManager> WeakThis(this);
 	Request->OnProcessRequestComplete().BindLambda(
-		[this](FHttpRequestPtr Req, FHttpResponsePtr Resp, bool bSuccess)
+		[WeakThis](FHttpRequestPtr Req, FHttpResponsePtr Resp, bool bSuccess)
 		{
-			TArray<FString> Metrics;
+			if (APrometheusManager* Manager = WeakThis.Get())
+			{
+				Manager->OnHttpRequestFinished(Req);
+			}
 
-			if (bSuccess && Resp.IsValid())
+			UE::Tasks::Launch(UE_SOURCE_LOCATION, [WeakThis, Resp, bSuccess]()
 			{
-				TSharedPtr<FJsonObject> Json;
-				TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Resp->GetContentAsString());
+				TRACE_CPUPROFILER_EVENT_SCOPE(PrometheusManager_ParseMetricNames);
+
+				TArray<FString> Metrics;
+				int64 CompressedBytes = 0;
+				int64 UncompressedBytes = 0;
+				TArrayView<const uint8> Body;
+				if (bSuccess && Resp.IsValid() && DecodeResponseBody(Resp, Body))
+				{
+					CompressedBytes = Resp->GetContent().Num();
+					UncompressedBytes = Body.Num();
+					Metrics = ParseMetricNames(BodyToString(Body));
+				}
+
+				// 排序與建索引也在 worker 完成
+				const bool bFetched = Metrics.Num() > 0;
+				TSharedPtr<const FPrometheusMetricIndex> Index = MakeShared<FPrometheusMetricIndex>(MoveTemp(Metrics));
 
-				if (FJsonSerializer::Deserialize(Reader, Json))
+				AsyncTask(ENamedThreads::GameThread, [WeakThis, Index, bFetched, CompressedBytes, UncompressedBytes]()
 				{
-					const TArray<TSharedPtr<FJsonValue>>* DataArray;
-					if (Json->TryGetArrayField("data", DataArray))
+					if (APrometheusManager* This = WeakThis.Get())
 					{
-						for (const TSharedPtr<FJsonValue>& Value : *DataArray)
+						This->RecordTransferBytes(CompressedBytes, UncompressedBytes);
+
+						// 抓取失敗或是空的清單不保留，下一個 widget 初始化時會再抓一次
+						if (bFetched)
 						{
-							Metrics.Add(Value->AsString());
+							This->MetricIndex = Index;
 						}
+						This->bMetricsFetched = bFetched;
+						This->bMetricsFetchInFlight = false;
+						This->BroadcastMetricsFetched(Index);
 					}
-				}
-			}
-
-			// 呼叫廣播事件或回傳資料
-			CachedMetrics = Metrics;
-			bMetricsFetched = true;
-			OnMetricsFetched.Broadcast(CachedMetrics);
+				});
+			});
 		}
 	);
 
-	Request->ProcessRequest();
+	// metric 清單是使用者正在等的選單內容，優先送出
+	EnqueueHttpRequest(Request, FString(), MAX_int32);
 }
 
 
@@ -230,109 +497,941 @@ FString APrometheusManager::GetPromQLFromMapping(const FString& Metric, const FS
 
 void APrometheusManager::ExecuteAutoQueries()
 {
+	SCOPE_CYCLE_COUNTER(STAT_PrometheusViewer_Schedule);
+
+	const double Now = GetUnixTimeSeconds();
+	const double PlatformNow = FPlatformTime::Seconds();
+
+	int32 NumExecuted = 0;
+	ON_SCOPE_EXIT
+	{
+		GameThreadQuerySeconds += FPlatformTime::Seconds() - PlatformNow;
+		NumAutoQueryRefreshes += NumExecuted > 0 ? 1 : 0;
+	};
+
 	for (const FString& Query : RegisteredQueries)
 	{
+		FPrometheusQuerySchedule& Schedule = QuerySchedules.FindOrAdd(Query);
+		if (Now < Schedule.NextDueTime)
+		{
+			continue;
+		}
+
+		// 沒有可見的 widget: 不送請求，等重新出現時下一個 tick 立刻補上
+		if (!IsQueryVisible(Query, PlatformNow))
+		{
+			continue;
+		}
+
+		Schedule.LastRunTime = Now;
+		ScheduleNextRun(Schedule, Now);
+		++NumExecuted;
+
 		HandleQuery(Query); // 你原本的查詢函式
-		HandleRangeQuery(Query, 300.f, 5.f);
+		if (bIncrementalRangeQueries)
+		{
+			HandleIncrementalRangeQuery(Query);
+		}
+		else
+		{
+			HandleRangeQuery(Query, RangeWindowSeconds, RangeStepSeconds);
+		}
 	}
 }
 
-void APrometheusManager::RegisterQuery(const FString& PromQL)
+double APrometheusManager::GetUnixTimeSeconds()
 {
-	if (!RegisteredQueries.Contains(PromQL))
+	return (FDateTime::UtcNow() - FDateTime(1970, 1, 1)).GetTotalSeconds();
+}
+
+float APrometheusManager::GetScheduledInterval() const
+{
+	const float Interval = FMath::Max(QueryInterval, 0.25f);
+	if (ScrapeIntervalSeconds <= 0.0f)
 	{
-		RegisteredQueries.Add(PromQL);
+		return Interval;
 	}
+	return FMath::Max(1.0f, FMath::CeilToFloat(Interval / ScrapeIntervalSeconds)) * ScrapeIntervalSeconds;
 }
 
-void APrometheusManager::HandleRangeQuery(const FString& PromQL, float RangeSeconds, float StepSeconds)
+void APrometheusManager::ScheduleNextRun(FPrometheusQuerySchedule& Schedule, double Now) const
 {
-	// 準備 URL
-	FString Start = FString::FromInt(FDateTime::UtcNow().ToUnixTimestamp() - RangeSeconds); // 過去 5 分鐘
-	FString End = FString::FromInt(FDateTime::UtcNow().ToUnixTimestamp());
-	FString StepStr = FString::SanitizeFloat(StepSeconds, 0);
+	const float Interval = GetScheduledInterval();
+	const double JitterOffset = Schedule.Phase * SchedulerJitterFraction * Interval;
 
-	FString Url = FString::Printf(TEXT("http://%s:9090/api/v1/query_range?query=%s&start=%s&end=%s&step=%s"),
-		*Target_IP,
-		*FGenericPlatformHttp::UrlEncode(PromQL),
-		*Start,
-		*End,
-		*StepStr);
+	if (Schedule.ConsecutiveFailures > 0)
+	{
+		// 指數退避: Interval * 2^n，最多 MaxBackoffSeconds
+		const double Backoff = FMath::Min(Interval * FMath::Pow(2.0, static_cast<double>(Schedule.ConsecutiveFailures)), static_cast<double>(FMath::Max(MaxBackoffSeconds, Interval)));
+		Schedule.NextDueTime = Now + Backoff + JitterOffset;
+		return;
+	}
 
-	UE_LOG(LogTemp, Warning, TEXT("[PrometheusManager] RangeQuery URL = %s"), *Url);
-	UE_LOG(LogTemp, Warning, TEXT("UE Now: %s"), *FDateTime::UtcNow().ToString());
-	UE_LOG(LogTemp, Warning, TEXT("UE Now Unix: %lld"), FDateTime::UtcNow().ToUnixTimestamp());
+	// 對齊到下一個 scrape 邊界，再加上各 query 固定的錯開量
+	Schedule.NextDueTime = AlignTime(Now, Interval) + Interval + JitterOffset;
+}
 
+bool APrometheusManager::IsQueryVisible(const FString& PromQL, double PlatformNow) const
+{
+	const TArray<FPrometheusQuerySubscriber>* Subscribers = Subscriptions.Find(PromQL);
+	if (!Subscribers)
+	{
+		// 沒有透過 Subscribe 註冊 (例如 Blueprint 直接 RegisterQuery)，一律視為可見
+		return true;
+	}
 
-	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
-	Request->OnProcessRequestComplete().BindLambda(
-		[this, PromQL](FHttpRequestPtr Req, FHttpResponsePtr Response, bool bConnectedSuccessfully)
+	for (const FPrometheusQuerySubscriber& Subscriber : *Subscribers)
+	{
+		if (Subscriber.Owner.IsValid() && PlatformNow - Subscriber.LastVisibleTime <= VisibilityTimeoutSeconds)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void APrometheusManager::MarkSubscriptionVisible(const FPrometheusSubscriptionHandle& Handle, float PixelWidth)
+{
+	if (TArray<FPrometheusQuerySubscriber>* Subscribers = Subscriptions.Find(Handle.QueryId))
+	{
+		for (FPrometheusQuerySubscriber& Subscriber : *Subscribers)
 		{
-			if (!Response.IsValid() || !EHttpResponseCodes::IsOk(Response->GetResponseCode()))
+			if (Subscriber.Id == Handle.Id)
 			{
-				UE_LOG(LogTemp, Error, TEXT("[PrometheusManager] RangeQuery failed: %s"), *PromQL);
-				UE_LOG(LogTemp, Error, TEXT("[PrometheusManager] RangeQuery failed: %s | Code: %d | Body: %s"),
-					*PromQL,
-					Response->GetResponseCode(),
-					*Response->GetContentAsString());
+				Subscriber.LastVisibleTime = FPlatformTime::Seconds();
+				if (PixelWidth > 0.0f)
+				{
+					Subscriber.PixelWidth = PixelWidth;
+				}
 				return;
 			}
-			OnRangeQueryResponseReceived(PromQL, Response->GetContentAsString());
-		});
+		}
+	}
+}
 
-	Request->SetURL(Url);
-	Request->SetHeader("Content-Type", "application/json");
-	Request->SetHeader("Authorization", "Basic " + FBase64::Encode(Account + ":" + Password));
-	Request->SetVerb(TEXT("GET"));
-	Request->ProcessRequest();
+void APrometheusManager::ReportQueryResult(const FString& PromQL, bool bSuccess)
+{
+	FPrometheusQuerySchedule* Schedule = QuerySchedules.Find(PromQL);
+	if (!Schedule)
+	{
+		return;
+	}
+
+	if (bSuccess)
+	{
+		Schedule->ConsecutiveFailures = 0;
+		return;
+	}
+
+	// 同一輪的 instant 與 range 查詢都失敗時只算一次
+	if (Schedule->LastFailedRunTime == Schedule->LastRunTime)
+	{
+		return;
+	}
+	Schedule->LastFailedRunTime = Schedule->LastRunTime;
+	++Schedule->ConsecutiveFailures;
+
+	UE_LOG(LogTemp, Warning, TEXT("[PrometheusManager] Query failed %d times, backing off: %s"), Schedule->ConsecutiveFailures, *PromQL);
+	ScheduleNextRun(*Schedule, GetUnixTimeSeconds());
 }
 
-void APrometheusManager::OnRangeQueryResponseReceived(const FString& PromQL, const FString& JsonString)
+void APrometheusManager::RegisterQuery(const FString& PromQL)
 {
-	TArray<FVector2D> DataPoints;
+	if (!RegisteredQueries.Contains(PromQL))
+	{
+		RegisteredQueries.Add(PromQL);
 
-	TSharedPtr<FJsonObject> JsonObject;
-	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(JsonString);
+		// 新的 query 先以固定相位錯開，第一次在下一個 tick 執行
+		FPrometheusQuerySchedule& Schedule = QuerySchedules.FindOrAdd(PromQL);
+		Schedule.Phase = FRandomStream(GetTypeHash(PromQL)).GetFraction();
+		Schedule.NextDueTime = 0.0;
+	}
+}
 
-	if (FJsonSerializer::Deserialize(Reader, JsonObject) && JsonObject.IsValid())
+void APrometheusManager::GetDiagnosticCounts(TArray<TPair<FString, int32>>& OutCounts) const
+{
+	int32 NumSubscribers = 0;
+	for (const TPair<FString, TArray<FPrometheusQuerySubscriber>>& Pair : Subscriptions)
 	{
-		// 取 data 物件
-		const TSharedPtr<FJsonObject>* DataObj;
-		if (JsonObject->TryGetObjectField(TEXT("data"), DataObj))
-		{
-			// 取 result array
-			const TArray<TSharedPtr<FJsonValue>>* ResultArray;
-			if ((*DataObj)->TryGetArrayField(TEXT("result"), ResultArray))
-			{
-				for (const TSharedPtr<FJsonValue>& ResultEntry : *ResultArray)
-				{
-					TSharedPtr<FJsonObject> ResultObj = ResultEntry->AsObject();
-					if (!ResultObj.IsValid()) continue;
+		NumSubscribers += Pair.Value.Num();
+	}
 
-					// 取 values array
-					const TArray<TSharedPtr<FJsonValue>>* ValuesArray;
-					if (ResultObj->TryGetArrayField(TEXT("values"), ValuesArray))
-					{
-						for (const TSharedPtr<FJsonValue>& V : *ValuesArray)
-						{
-							const TArray<TSharedPtr<FJsonValue>>* PointArray;
-							if (V->TryGetArray(PointArray) && PointArray->Num() == 2)
-							{
-								double Timestamp = (*PointArray)[0]->AsNumber();
-								FString ValueStr = (*PointArray)[1]->AsString();
+	OutCounts.Emplace(TEXT("Subscriptions"), Subscriptions.Num());
+	OutCounts.Emplace(TEXT("Subscribers"), NumSubscribers);
+	OutCounts.Emplace(TEXT("RegisteredQueries"), RegisteredQueries.Num());
+	OutCounts.Emplace(TEXT("QuerySchedules"), QuerySchedules.Num());
+	OutCounts.Emplace(TEXT("RangeQueryStates"), RangeQueryStates.Num());
+	OutCounts.Emplace(TEXT("QueryGenerations"), QueryGenerations.Num());
+	OutCounts.Emplace(TEXT("SeriesCountEstimates"), SeriesCountEstimates.Num());
+	OutCounts.Emplace(TEXT("PendingCacheLoads"), PendingCacheLoads.Num());
+	OutCounts.Emplace(TEXT("InFlightRequests"), InFlightRequests.Num());
+	OutCounts.Emplace(TEXT("PendingHttpRequests"), PendingHttpRequests.Num());
+	OutCounts.Emplace(TEXT("ActiveHttpRequests"), ActiveHttpRequests.Num());
+	OutCounts.Emplace(TEXT("CompletedRangeResults"), CompletedRangeResults.Num());
+	OutCounts.Emplace(TEXT("CompletedInstantResults"), CompletedInstantResults.Num());
+	OutCounts.Emplace(TEXT("LineChartMap"), LineChartMap.Num());
+	OutCounts.Emplace(TEXT("LabelSets"), FPrometheusLabelSetTable::Get().Num());
+	OutCounts.Emplace(TEXT("OnQueryResponseBindings"), OnQueryResponse.GetAllObjects().Num());
+	OutCounts.Emplace(TEXT("OnRangeQueryResponseBindings"), OnRangeQueryResponse.GetAllObjects().Num());
+	OutCounts.Emplace(TEXT("OnRangeQueryDeltaBindings"), OnRangeQueryDelta.GetAllObjects().Num());
+	OutCounts.Emplace(TEXT("OnMetricsFetchedBindings"), OnMetricsFetched.GetAllObjects().Num());
+}
 
-								float Value = FCString::Atof(*ValueStr);
+void APrometheusManager::UnregisterQuery(const FString& PromQL)
+{
+	RegisteredQueries.Remove(PromQL);
+	RangeQueryStates.Remove(PromQL);
+	CancelQueryRequests(PromQL);
+	QuerySchedules.Remove(PromQL);
 
-								DataPoints.Add(FVector2D(Timestamp, Value));
-							}
-						}
-					}
-				}
-			}
+	// 已送出的請求都從 InFlightRequests 移除，晚到的回應一樣會被丟棄，不需要保留 generation；
+	// 之後重新選擇這個 query 時重新估計 series 數
+	QueryGenerations.Remove(PromQL);
+	SeriesCountEstimates.Remove(PromQL);
+	PendingCacheLoads.Remove(PromQL);
+}
+
+FPrometheusSubscriptionHandle APrometheusManager::Subscribe(const FString& PromQL, const UObject* Owner,
+	FOnPrometheusInstantResult OnInstantResult, FOnPrometheusRangeResult OnRangeResult, FOnPrometheusRangeTileResult OnTileResult)
+{
+	FPrometheusQuerySubscriber& Subscriber = Subscriptions.FindOrAdd(PromQL).AddDefaulted_GetRef();
+	Subscriber.Id = NextSubscriptionId++;
+	Subscriber.Owner = Owner;
+	// 剛訂閱的 widget 正在被操作，先當作可見
+	Subscriber.LastVisibleTime = FPlatformTime::Seconds();
+	Subscriber.OnInstantResult = MoveTemp(OnInstantResult);
+	Subscriber.OnRangeResult = MoveTemp(OnRangeResult);
+	Subscriber.OnTileResult = MoveTemp(OnTileResult);
+
+	FPrometheusSubscriptionHandle Handle;
+	Handle.QueryId = PromQL;
+	Handle.Id = Subscriber.Id;
+	return Handle;
+}
+
+void APrometheusManager::Unsubscribe(FPrometheusSubscriptionHandle& Handle)
+{
+	if (!Handle.IsValid())
+	{
+		return;
+	}
+
+	if (TArray<FPrometheusQuerySubscriber>* Subscribers = Subscriptions.Find(Handle.QueryId))
+	{
+		const uint64 Id = Handle.Id;
+		Subscribers->RemoveAll([Id](const FPrometheusQuerySubscriber& Subscriber) { return Subscriber.Id == Id; });
+		if (Subscribers->Num() == 0)
+		{
+			Subscriptions.Remove(Handle.QueryId);
+			UnregisterQuery(Handle.QueryId);
+		}
+	}
+	Handle.Reset();
+}
+
+void APrometheusManager::DispatchInstantResult(const FString& PromQL, const FString& Result)
+{
+	if (TArray<FPrometheusQuerySubscriber>* Subscribers = Subscriptions.Find(PromQL))
+	{
+		Subscribers->RemoveAll([](const FPrometheusQuerySubscriber& Subscriber) { return !Subscriber.Owner.IsValid(); });
+
+		// 複製一份，callback 中可以安全地 Unsubscribe
+		const TArray<FPrometheusQuerySubscriber> Snapshot = *Subscribers;
+		for (const FPrometheusQuerySubscriber& Subscriber : Snapshot)
+		{
+			Subscriber.OnInstantResult.ExecuteIfBound(PromQL, Result);
 		}
 	}
 
-	OnRangeQueryResponse.Broadcast(PromQL, DataPoints);
+	// Blueprint 用的廣播保留
+	OnQueryResponse.Broadcast(PromQL, Result);
+}
+
+int32 FPrometheusRangeRequest::GetExpectedPointsPerSeries() const
+{
+	return StepSeconds > 0.f ? FMath::CeilToInt((EndTime - StartTime) / StepSeconds) + 1 : 1;
+}
+
+FString FPrometheusRangeRequest::GetRequestKey() const
+{
+	return FString::Printf(TEXT("%s|%s|%.3f|%.3f|%g"), bTile ? TEXT("tile") : TEXT("range"), *PromQL, StartTime, EndTime, StepSeconds);
+}
 
-	UE_LOG(LogTemp, Log, TEXT("[Prometheus] RangeQuery %s returned %d points"), *PromQL, DataPoints.Num());
+void APrometheusManager::HandleRangeQuery(const FString& PromQL, float RangeSeconds, float StepSeconds)
+{
+	// 先知道大概有幾個 series 才能決定 step，count() 回來後會再進來
+	if (RequestSeriesCountIfNeeded(PromQL, RangeSeconds, StepSeconds))
+	{
+		return;
+	}
+
+	StepSeconds = ChooseRangeStep(PromQL, RangeSeconds, StepSeconds);
+	if (StepSeconds <= 0.0f)
+	{
+		const FPrometheusSeriesCountEstimate* Estimate = SeriesCountEstimates.Find(PromQL);
+		UE_LOG(LogTemp, Error, TEXT("[Prometheus] RangeQuery %s refused: ~%d series exceed the point budget (%d)"),
+			*PromQL, Estimate ? Estimate->NumSeries : 0, MaxTotalPoints);
+
+		// 當作失敗處理，排程器會退避而不是每個 tick 重試
+		ReportQueryResult(PromQL, false);
+		return;
+	}
+
+	// 剛啟動或新的選擇: 先畫出磁碟快取，只抓快取之後的部分
+	if (!RangeQueryStates.Contains(PromQL) && TryWarmStartFromCache(PromQL, RangeSeconds, StepSeconds))
+	{
+		return;
+	}
+
+	SendFullRangeQuery(PromQL, RangeSeconds, StepSeconds);
+}
+
+void APrometheusManager::SendFullRangeQuery(const FString& PromQL, float RangeSeconds, float StepSeconds)
+{
+	// end 對齊 step，同一個 refresh 內相同查詢會得到相同的 key
+	const double Now = AlignTime(FDateTime::UtcNow().ToUnixTimestamp(), StepSeconds);
+
+	FPrometheusRangeRequest RangeRequest;
+	RangeRequest.PromQL = PromQL;
+	RangeRequest.StartTime = Now - RangeSeconds;
+	RangeRequest.EndTime = Now;
+	RangeRequest.StepSeconds = StepSeconds;
+	RangeRequest.bDelta = false;
+	SendRangeQuery(RangeRequest);
+}
+
+float APrometheusManager::GetRangeStep(const FString& PromQL) const
+{
+	const FPrometheusRangeQueryState* State = RangeQueryStates.Find(PromQL);
+	return State ? State->StepSeconds : RangeStepSeconds;
+}
+
+float APrometheusManager::GetQueryPixelWidth(const FString& PromQL) const
+{
+	float PixelWidth = 0.0f;
+	if (const TArray<FPrometheusQuerySubscriber>* Subscribers = Subscriptions.Find(PromQL))
+	{
+		for (const FPrometheusQuerySubscriber& Subscriber : *Subscribers)
+		{
+			PixelWidth = FMath::Max(PixelWidth, Subscriber.PixelWidth);
+		}
+	}
+	return PixelWidth;
+}
+
+float APrometheusManager::RoundStepToScrapeInterval(float StepSeconds) const
+{
+	if (ScrapeIntervalSeconds <= 0.0f)
+	{
+		return StepSeconds;
+	}
+	return FMath::Max(1.0f, FMath::CeilToFloat(StepSeconds / ScrapeIntervalSeconds - KINDA_SMALL_NUMBER)) * ScrapeIntervalSeconds;
+}
+
+float APrometheusManager::ChooseRangeStep(const FString& PromQL, float RangeSeconds, float MinStepSeconds) const
+{
+	float StepSeconds = FMath::Max(MinStepSeconds, KINDA_SMALL_NUMBER);
+
+	// 每個像素最多一點，且不超過 MaxPointsPerSeries
+	if (bAutoRangeStep)
+	{
+		const float PixelWidth = GetQueryPixelWidth(PromQL);
+		const int32 MaxPoints = PixelWidth > 0.0f ? FMath::Min(FMath::FloorToInt(PixelWidth), MaxPointsPerSeries) : MaxPointsPerSeries;
+		StepSeconds = FMath::Max(StepSeconds, RangeSeconds / FMath::Max(MaxPoints - 1, 1));
+	}
+
+	// 總點數 = series 數 * 每個 series 的點數
+	const FPrometheusSeriesCountEstimate* Estimate = SeriesCountEstimates.Find(PromQL);
+	if (MaxTotalPoints > 0 && Estimate && Estimate->NumSeries > 0)
+	{
+		const int32 BudgetPerSeries = MaxTotalPoints / Estimate->NumSeries;
+		if (BudgetPerSeries < 2)
+		{
+			return 0.0f;
+		}
+		StepSeconds = FMath::Max(StepSeconds, RangeSeconds / (BudgetPerSeries - 1));
+	}
+
+	return RoundStepToScrapeInterval(StepSeconds);
+}
+
+bool APrometheusManager::RequestSeriesCountIfNeeded(const FString& PromQL, float RangeSeconds, float StepSeconds)
+{
+	if (!bEstimateSeriesCount || MaxTotalPoints <= 0)
+	{
+		return false;
+	}
+
+	const double Now = GetUnixTimeSeconds();
+	FPrometheusSeriesCountEstimate& Estimate = SeriesCountEstimates.FindOrAdd(PromQL);
+	if (Estimate.bPending)
+	{
+		Estimate.PendingRangeSeconds = RangeSeconds;
+		Estimate.PendingStepSeconds = StepSeconds;
+		return true;
+	}
+	if (Estimate.UpdatedTime > 0.0 && Now - Estimate.UpdatedTime < SeriesCountMaxAgeSeconds)
+	{
+		return false;
+	}
+
+	Estimate.bPending = true;
+	Estimate.PendingRangeSeconds = RangeSeconds;
+	Estimate.PendingStepSeconds = StepSeconds;
+
+	const FString RequestKey = FString::Printf(TEXT("count|%s"), *PromQL);
+	const FString Url = FString::Printf(TEXT("%s/api/v1/query?query=%s&time=%.0f"),
+		*GetBaseUrl(), *FGenericPlatformHttp::UrlEncode(FString::Printf(TEXT("count(%s)"), *PromQL)), Now);
+
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+	Request->SetURL(Url);
+	SetCommonHeaders(*Request);
+
+	TWeakObjectPtr<APrometheusManager> WeakThis(this);
+	Request->OnProcessRequestComplete().BindLambda(
+		[WeakThis, RequestKey, PromQL](FHttpRequestPtr Req, FHttpResponsePtr Resp, bool bSuccess)
+		{
+			APrometheusManager* This = WeakThis.Get();
+			if (!This)
+			{
+				return;
+			}
+			This->OnHttpRequestFinished(Req);
+
+			// 被取消時 CancelQueryRequests 已經清掉等待中的估計
+			if (!This->IsRequestCurrent(RequestKey, Req))
+			{
+				return;
+			}
+			This->InFlightRequests.Remove(RequestKey);
+
+			// 回應只有一個數字，直接在 game thread 解析
+			int32 NumSeries = 0;
+			TArrayView<const uint8> Body;
+			if (bSuccess && Resp.IsValid() && EHttpResponseCodes::IsOk(Resp->GetResponseCode()) && DecodeResponseBody(Resp, Body))
+			{
+				This->RecordTransferBytes(Resp->GetContent().Num(), Body.Num());
+				NumSeries = FCString::Atoi(*ParseInstantQueryValue(BodyToString(Body)));
+			}
+			else
+			{
+				// 估計失敗不擋查詢，只是這次沒有總點數的限制
+				UE_LOG(LogTemp, Warning, TEXT("[Prometheus] Series count estimate failed: %s"), *PromQL);
+			}
+
+			FPrometheusSeriesCountEstimate* Estimate = This->SeriesCountEstimates.Find(PromQL);
+			if (!Estimate)
+			{
+				return;
+			}
+			Estimate->NumSeries = NumSeries;
+			Estimate->UpdatedTime = GetUnixTimeSeconds();
+			Estimate->bPending = false;
+
+			UE_LOG(LogTemp, Log, TEXT("[Prometheus] %s has ~%d series"), *PromQL, NumSeries);
+			This->HandleRangeQuery(PromQL, Estimate->PendingRangeSeconds, Estimate->PendingStepSeconds);
+		});
+
+	FPrometheusInFlightRequest& InFlight = InFlightRequests.Add(RequestKey);
+	InFlight.HttpRequest = Request;
+	InFlight.PromQL = PromQL;
+	InFlight.Generation = GetQueryGeneration(PromQL);
+	EnqueueHttpRequest(Request, PromQL, GetRequestPriority(PromQL));
+	return true;
+}
+
+FString APrometheusManager::GetSeriesCacheKey(const FString& PromQL, float StepSeconds) const
+{
+	return FPrometheusSeriesCache::MakeKey(GetBaseUrl(), PromQL, StepSeconds);
+}
+
+bool APrometheusManager::TryWarmStartFromCache(const FString& PromQL, float RangeSeconds, float StepSeconds)
+{
+	if (!SeriesCache || !bIncrementalRangeQueries)
+	{
+		return false;
+	}
+
+	// 已經在讀，結果回來時一起處理
+	if (PendingCacheLoads.Contains(PromQL))
+	{
+		return true;
+	}
+
+	const uint32 LoadId = NextCacheLoadId++;
+	PendingCacheLoads.Add(PromQL, LoadId);
+
+	const double Now = FDateTime::UtcNow().ToUnixTimestamp();
+	TWeakObjectPtr<APrometheusManager> WeakThis(this);
+	SeriesCache->LoadAsync(GetSeriesCacheKey(PromQL, StepSeconds), Now - RangeSeconds,
+		[WeakThis, PromQL, LoadId, RangeSeconds, StepSeconds](FPrometheusRangeResult&& Cached)
+		{
+			AsyncTask(ENamedThreads::GameThread, [WeakThis, PromQL, LoadId, RangeSeconds, StepSeconds, Cached = MoveTemp(Cached)]() mutable
+			{
+				if (APrometheusManager* This = WeakThis.Get())
+				{
+					This->OnSeriesCacheLoaded(PromQL, LoadId, RangeSeconds, StepSeconds, MoveTemp(Cached));
+				}
+			});
+		});
+	return true;
+}
+
+void APrometheusManager::OnSeriesCacheLoaded(const FString& PromQL, uint32 LoadId, float RangeSeconds, float StepSeconds, FPrometheusRangeResult&& Cached)
+{
+	// 讀取期間 query 被取消或重新選擇，這次的結果作廢
+	const uint32* PendingId = PendingCacheLoads.Find(PromQL);
+	if (!PendingId || *PendingId != LoadId)
+	{
+		return;
+	}
+	PendingCacheLoads.Remove(PromQL);
+
+	// 讀取期間已經有其他結果 (例如增量查詢)，不再用較舊的快取覆蓋
+	if (RangeQueryStates.Contains(PromQL))
+	{
+		return;
+	}
+
+	if (Cached.GetTotalPoints() == 0)
+	{
+		SendFullRangeQuery(PromQL, RangeSeconds, StepSeconds);
+		return;
+	}
+
+	const double Now = FDateTime::UtcNow().ToUnixTimestamp();
+	FPrometheusRangeQueryState& State = RangeQueryStates.Add(PromQL);
+	State.LastTimestamp = Cached.GetLastTimestamp();
+	State.StepSeconds = StepSeconds;
+
+	UE_LOG(LogTemp, Log, TEXT("[Prometheus] RangeQuery %s warm start from cache: %d series, %d points"),
+		*PromQL, Cached.Series.Num(), Cached.GetTotalPoints());
+
+	FPrometheusRangeRequest CachedRequest;
+	CachedRequest.PromQL = PromQL;
+	CachedRequest.StartTime = Now - RangeSeconds;
+	CachedRequest.EndTime = State.LastTimestamp;
+	CachedRequest.StepSeconds = StepSeconds;
+	CachedRequest.bDelta = false;
+	BroadcastRangeResult(CachedRequest, Cached);
+
+	HandleIncrementalRangeQuery(PromQL);
+}
+
+void APrometheusManager::RequestRangeTile(const FString& PromQL, double StartTime, double EndTime, float StepSeconds)
+{
+	if (PromQL.IsEmpty() || StepSeconds <= 0.0f || StartTime > EndTime)
+	{
+		return;
+	}
+
+	// 區塊邊界由圖表對齊 step，相同區塊的請求會合併
+	FPrometheusRangeRequest RangeRequest;
+	RangeRequest.PromQL = PromQL;
+	RangeRequest.StartTime = StartTime;
+	RangeRequest.EndTime = EndTime;
+	RangeRequest.StepSeconds = StepSeconds;
+	RangeRequest.bTile = true;
+	SendRangeQuery(RangeRequest);
+}
+
+void APrometheusManager::HandleIncrementalRangeQuery(const FString& PromQL)
+{
+	const double Now = FDateTime::UtcNow().ToUnixTimestamp();
+	const FPrometheusRangeQueryState* State = RangeQueryStates.Find(PromQL);
+
+	// 還沒有歷史，或已落後超過整個視窗時，重抓完整範圍
+	if (!State || State->LastTimestamp <= 0.0 || Now - State->LastTimestamp >= RangeWindowSeconds)
+	{
+		HandleRangeQuery(PromQL, RangeWindowSeconds, RangeStepSeconds);
+		return;
+	}
+
+	// 只要 [last + step, now]，start 對齊上一批的 step 讓新的 sample 接得上
+	FPrometheusRangeRequest RangeRequest;
+	RangeRequest.PromQL = PromQL;
+	RangeRequest.StartTime = State->LastTimestamp + State->StepSeconds;
+	RangeRequest.EndTime = AlignTime(Now, State->StepSeconds);
+	RangeRequest.StepSeconds = State->StepSeconds;
+	RangeRequest.bDelta = true;
+
+	if (RangeRequest.StartTime > RangeRequest.EndTime)
+	{
+		return;
+	}
+	SendRangeQuery(RangeRequest);
+}
+
+void APrometheusManager::SendRangeQuery(FPrometheusRangeRequest RangeRequest)
+{
+	const FString RequestKey = RangeRequest.GetRequestKey();
+
+	PruneCompletedResults(FDateTime::UtcNow().ToUnixTimestamp());
+
+	if (FPrometheusInFlightRequest* InFlight = InFlightRequests.Find(RequestKey))
+	{
+		// 相同 key 已在路上: 不再送出，等同一份解析結果一起廣播
+		++InFlight->NumWaiters;
+		UE_LOG(LogTemp, Verbose, TEXT("[PrometheusManager] RangeQuery coalesced (%d waiters): %s"), InFlight->NumWaiters, *RequestKey);
+		return;
+	}
+	if (const FPrometheusCachedRangeResult* Cached = CompletedRangeResults.Find(RequestKey))
+	{
+		// 本輪已完成的相同請求，直接重用解析結果
+		BroadcastRangeResult(RangeRequest, Cached->Result);
+		return;
+	}
+
+	// 區塊是 zoom/pan 的補抓，不算在排程到畫面的延遲裡
+	if (!RangeRequest.bTile)
+	{
+		RangeRequest.TraceId = FPrometheusQueryTrace::Begin(RangeRequest.PromQL);
+	}
+	PROMETHEUS_QUERY_TRACE_SCOPE(RangeRequest.TraceId, Schedule);
+
+	// 準備 URL
+	FString Start = FString::Printf(TEXT("%.3f"), RangeRequest.StartTime);
+	FString End = FString::Printf(TEXT("%.3f"), RangeRequest.EndTime);
+	FString StepStr = FString::SanitizeFloat(RangeRequest.StepSeconds, 0);
+
+	FString Url = FString::Printf(TEXT("%s/api/v1/query_range?query=%s&start=%s&end=%s&step=%s"),
+		*GetBaseUrl(),
+		*FGenericPlatformHttp::UrlEncode(RangeRequest.PromQL),
+		*Start,
+		*End,
+		*StepStr);
+
+	UE_LOG(LogTemp, VeryVerbose, TEXT("[PrometheusManager] RangeQuery URL = %s"), *Url);
+
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+	TWeakObjectPtr<APrometheusManager> WeakThis(this);
+	Request->OnProcessRequestComplete().BindLambda(
+		[WeakThis, RangeRequest, RequestKey](FHttpRequestPtr Req, FHttpResponsePtr Response, bool bConnectedSuccessfully)
+		{
+			APrometheusManager* This = WeakThis.Get();
+			if (!This)
+			{
+				return;
+			}
+			This->OnHttpRequestFinished(Req);
+
+			PROMETHEUS_QUERY_TRACE_SCOPE(RangeRequest.TraceId, Response);
+
+			// 已被新的選擇取代 (或被取消)，不解析直接丟棄
+			if (!This->IsRequestCurrent(RequestKey, Req))
+			{
+				FPrometheusQueryTrace::Cancel(RangeRequest.TraceId);
+				return;
+			}
+
+			if (!Response.IsValid())
+			{
+				FPrometheusQueryTrace::Cancel(RangeRequest.TraceId);
+				This->InFlightRequests.Remove(RequestKey);
+				This->ReportRangeResult(RangeRequest, false);
+				UE_LOG(LogTemp, Error, TEXT("[PrometheusManager] RangeQuery failed: %s"), *RangeRequest.PromQL);
+				return;
+			}
+			if (!EHttpResponseCodes::IsOk(Response->GetResponseCode()))
+			{
+				FPrometheusQueryTrace::Cancel(RangeRequest.TraceId);
+				This->InFlightRequests.Remove(RequestKey);
+				This->ReportRangeResult(RangeRequest, false);
+				// body 可能是 gzip，只記錄大小
+				UE_LOG(LogTemp, Error, TEXT("[PrometheusManager] RangeQuery failed: %s | Code: %d | Body: %d bytes | Content-Encoding: %s"),
+					*RangeRequest.PromQL,
+					Response->GetResponseCode(),
+					Response->GetContent().Num(),
+					*Response->GetHeader(TEXT("Content-Encoding")));
+				return;
+			}
+
+			// 解析在 worker 執行 (label intern 是 thread-safe 的)，完成後把結果 move 回 game thread
+			UE::Tasks::Launch(UE_SOURCE_LOCATION, [WeakThis, RangeRequest, RequestKey, Req, Response]()
+			{
+				TRACE_CPUPROFILER_EVENT_SCOPE(PrometheusManager_ParseRangeQuery);
+				SCOPE_CYCLE_COUNTER(STAT_PrometheusViewer_ParseRange);
+				PROMETHEUS_QUERY_TRACE_SCOPE(RangeRequest.TraceId, Parse);
+				FPrometheusViewerScopeTimer ParseTimer(FPrometheusViewerStats::Get().ParseTime);
+
+				FPrometheusRangeResult Result;
+				FString Error;
+				bool bParsed = false;
+
+				// gzip 回應解壓縮到 worker 的 buffer 後直接交給 parser
+				TArrayView<const uint8> Body;
+				if (DecodeResponseBody(Response, Body))
+				{
+					bParsed = FPrometheusRangeParser::Parse(Body.GetData(), Body.Num(), RangeRequest.GetExpectedPointsPerSeries(), Result, &Error);
+				}
+				else
+				{
+					Error = TEXT("gzip decompression failed");
+				}
+				const int64 CompressedBytes = Response->GetContent().Num();
+				const int64 UncompressedBytes = Body.Num();
+
+				AsyncTask(ENamedThreads::GameThread, [WeakThis, RangeRequest, RequestKey, Req, Result = MoveTemp(Result), Error = MoveTemp(Error), bParsed, CompressedBytes, UncompressedBytes]() mutable
+				{
+					APrometheusManager* This = WeakThis.Get();
+					if (!This)
+					{
+						return;
+					}
+					This->RecordTransferBytes(CompressedBytes, UncompressedBytes);
+					if (!This->IsRequestCurrent(RequestKey, Req))
+					{
+						FPrometheusQueryTrace::Cancel(RangeRequest.TraceId);
+						return;
+					}
+
+					This->InFlightRequests.Remove(RequestKey);
+					This->ReportRangeResult(RangeRequest, bParsed);
+					if (!bParsed)
+					{
+						FPrometheusQueryTrace::Cancel(RangeRequest.TraceId);
+						UE_LOG(LogTemp, Error, TEXT("[Prometheus] RangeQuery %s parse failed: %s"), *RangeRequest.PromQL, *Error);
+						return;
+					}
+					This->OnRangeQueryResponseReceived(RangeRequest, MoveTemp(Result));
+				});
+			});
+		});
+
+	Request->SetURL(Url);
+	SetCommonHeaders(*Request);
+
+	FPrometheusInFlightRequest& InFlight = InFlightRequests.Add(RequestKey);
+	InFlight.HttpRequest = Request;
+	InFlight.PromQL = RangeRequest.PromQL;
+	InFlight.Generation = GetQueryGeneration(RangeRequest.PromQL);
+	EnqueueHttpRequest(Request, RangeRequest.PromQL, GetRequestPriority(RangeRequest.PromQL), RangeRequest.TraceId);
+}
+
+void APrometheusManager::EnqueueHttpRequest(const TSharedRef<IHttpRequest, ESPMode::ThreadSafe>& Request, const FString& PromQL, int32 Priority, uint32 TraceId)
+{
+	FPrometheusQueuedRequest Queued;
+	Queued.HttpRequest = Request;
+	Queued.PromQL = PromQL;
+	Queued.Priority = Priority;
+	Queued.Sequence = NextRequestSequence++;
+	Queued.TraceId = TraceId;
+	PendingHttpRequests.HeapPush(MoveTemp(Queued), FPrometheusQueuedRequestPredicate());
+
+	PumpRequestQueue();
+}
+
+void APrometheusManager::PumpRequestQueue()
+{
+	while (ActiveHttpRequests.Num() < FMath::Max(MaxConcurrentRequests, 1) && PendingHttpRequests.Num() > 0)
+	{
+		FPrometheusQueuedRequest Next;
+		PendingHttpRequests.HeapPop(Next, FPrometheusQueuedRequestPredicate());
+
+		PROMETHEUS_QUERY_TRACE_SCOPE(Next.TraceId, Send);
+
+		ActiveHttpRequests.Add(Next.HttpRequest);
+		if (!Next.HttpRequest->ProcessRequest())
+		{
+			// 有些 backend 送出失敗時仍會呼叫 completion callback，由 ReleaseHttpRequest 保證只釋放一次
+			ReleaseHttpRequest(Next.HttpRequest);
+			FPrometheusQueryTrace::Cancel(Next.TraceId);
+			continue;
+		}
+		++SentHttpRequests;
+	}
+
+	FPrometheusViewerStats::Get().SetRequestGauges(ActiveHttpRequests.Num(), PendingHttpRequests.Num());
+}
+
+bool APrometheusManager::ReleaseHttpRequest(const FHttpRequestPtr& Request)
+{
+	return ActiveHttpRequests.Remove(Request) > 0;
+}
+
+void APrometheusManager::OnHttpRequestFinished(const FHttpRequestPtr& Request)
+{
+	if (!ReleaseHttpRequest(Request))
+	{
+		return;
+	}
+
+	FPrometheusViewerStats::Get().RecordRequestCompleted(Request->GetElapsedTime());
+	PumpRequestQueue();
+}
+
+int32 APrometheusManager::GetRequestPriority(const FString& PromQL) const
+{
+	return IsQueryVisible(PromQL, FPlatformTime::Seconds()) ? 1 : 0;
+}
+
+uint32 APrometheusManager::GetQueryGeneration(const FString& PromQL) const
+{
+	return QueryGenerations.FindRef(PromQL);
+}
+
+bool APrometheusManager::IsRequestCurrent(const FString& RequestKey, const FHttpRequestPtr& Request) const
+{
+	const FPrometheusInFlightRequest* InFlight = InFlightRequests.Find(RequestKey);
+	return InFlight
+		&& InFlight->HttpRequest == Request
+		&& InFlight->Generation == GetQueryGeneration(InFlight->PromQL);
+}
+
+void APrometheusManager::CancelQueryRequests(const FString& PromQL)
+{
+	// 之後回來的回應 generation 不符，會在解析前丟棄
+	++QueryGenerations.FindOrAdd(PromQL);
+
+	// 等待中的 count() 不會再回來，下次重新估計
+	if (const FPrometheusSeriesCountEstimate* Estimate = SeriesCountEstimates.Find(PromQL))
+	{
+		if (Estimate->bPending)
+		{
+			SeriesCountEstimates.Remove(PromQL);
+		}
+	}
+
+	// 還在排隊的直接移除，不會送出
+	const int32 NumQueued = PendingHttpRequests.Num();
+	PendingHttpRequests.RemoveAll([&PromQL](const FPrometheusQueuedRequest& Queued)
+	{
+		if (Queued.PromQL != PromQL)
+		{
+			return false;
+		}
+		FPrometheusQueryTrace::Cancel(Queued.TraceId);
+		return true;
+	});
+	if (PendingHttpRequests.Num() != NumQueued)
+	{
+		PendingHttpRequests.Heapify(FPrometheusQueuedRequestPredicate());
+	}
+
+	// 已送出的取消連線，completion callback 會照常釋放併發名額
+	TArray<FHttpRequestPtr> RequestsToCancel;
+	for (auto It = InFlightRequests.CreateIterator(); It; ++It)
+	{
+		if (It->Value.PromQL == PromQL)
+		{
+			if (It->Value.HttpRequest.IsValid() && It->Value.HttpRequest->GetStatus() == EHttpRequestStatus::Processing)
+			{
+				RequestsToCancel.Add(It->Value.HttpRequest);
+			}
+			It.RemoveCurrent();
+		}
+	}
+	for (const FHttpRequestPtr& Request : RequestsToCancel)
+	{
+		Request->CancelRequest();
+	}
+}
+
+void APrometheusManager::ReportRangeResult(const FPrometheusRangeRequest& RangeRequest, bool bSuccess)
+{
+	// 補抓歷史失敗不影響即時查詢的退避
+	if (!RangeRequest.bTile)
+	{
+		ReportQueryResult(RangeRequest.PromQL, bSuccess);
+	}
+}
+
+void APrometheusManager::OnRangeQueryResponseReceived(const FPrometheusRangeRequest& RangeRequest, FPrometheusRangeResult&& Result)
+{
+	SCOPE_CYCLE_COUNTER(STAT_PrometheusViewer_Dispatch);
+	FPrometheusViewerScopeTimer DispatchTimer(FPrometheusViewerStats::Get().DispatchTime);
+	const double DispatchStart = FPlatformTime::Seconds();
+	ON_SCOPE_EXIT
+	{
+		GameThreadQuerySeconds += FPlatformTime::Seconds() - DispatchStart;
+	};
+
+	const FString& PromQL = RangeRequest.PromQL;
+
+	if (RangeRequest.bTile)
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("[Prometheus] RangeTile %s returned %d series, %d points (step=%g)"),
+			*PromQL, Result.Series.Num(), Result.GetTotalPoints(), RangeRequest.StepSeconds);
+		BroadcastRangeResult(RangeRequest, Result);
+		return;
+	}
+
+	// 記錄每個 query 收到的最後時間，下次只抓之後的部分
+	const double LastTimestamp = Result.GetLastTimestamp();
+	FPrometheusRangeQueryState& State = RangeQueryStates.FindOrAdd(PromQL);
+	State.StepSeconds = RangeRequest.StepSeconds;
+	if (!RangeRequest.bDelta)
+	{
+		State.LastTimestamp = LastTimestamp;
+	}
+	else if (LastTimestamp > State.LastTimestamp)
+	{
+		State.LastTimestamp = LastTimestamp;
+	}
+
+	UE_LOG(LogTemp, Verbose, TEXT("[Prometheus] RangeQuery %s returned %d series, %d points (delta=%d)"),
+		*PromQL, Result.Series.Num(), Result.GetTotalPoints(), RangeRequest.bDelta ? 1 : 0);
+
+	if (SeriesCache)
+	{
+		// 完整範圍取代快取檔，增量只附加新的 sample
+		SeriesCache->Store(GetSeriesCacheKey(PromQL, RangeRequest.StepSeconds), Result, !RangeRequest.bDelta,
+			RangeRequest.EndTime - RangeWindowSeconds);
+	}
+
+	// 沒有新 sample 的增量不會派送，也就不會有 paint
+	if (RangeRequest.bDelta && Result.GetTotalPoints() == 0)
+	{
+		FPrometheusQueryTrace::Cancel(RangeRequest.TraceId);
+	}
+
+	FPrometheusCachedRangeResult& Cached = CompletedRangeResults.Add(RangeRequest.GetRequestKey());
+	Cached.ExpireTime = RangeRequest.EndTime + RangeRequest.StepSeconds;
+	Cached.Result = MoveTemp(Result);
+
+	// 訂閱者在派送期間用 FPrometheusQueryTrace::GetCurrent() 接續同一個 id
+	PROMETHEUS_QUERY_TRACE_SCOPE(RangeRequest.TraceId, Broadcast);
+	FPrometheusQueryTrace::FCurrentScope CurrentTrace(RangeRequest.TraceId);
+	BroadcastRangeResult(RangeRequest, Cached.Result);
+}
+
+void APrometheusManager::BroadcastRangeResult(const FPrometheusRangeRequest& RangeRequest, const FPrometheusRangeResult& Result)
+{
+	if (RangeRequest.bDelta && Result.GetTotalPoints() == 0)
+	{
+		return;
+	}
+
+	if (RangeRequest.bTile)
+	{
+		if (TArray<FPrometheusQuerySubscriber>* Subscribers = Subscriptions.Find(RangeRequest.PromQL))
+		{
+			const TArray<FPrometheusQuerySubscriber> Snapshot = *Subscribers;
+			for (const FPrometheusQuerySubscriber& Subscriber : Snapshot)
+			{
+				Subscriber.OnTileResult.ExecuteIfBound(RangeRequest, Result);
+			}
+		}
+		return;
+	}
+
+	if (TArray<FPrometheusQuerySubscriber>* Subscribers = Subscriptions.Find(RangeRequest.PromQL))
+	{
+		Subscribers->RemoveAll([](const FPrometheusQuerySubscriber& Subscriber) { return !Subscriber.Owner.IsValid(); });
+
+		const TArray<FPrometheusQuerySubscriber> Snapshot = *Subscribers;
+		for (const FPrometheusQuerySubscriber& Subscriber : Snapshot)
+		{
+			Subscriber.OnRangeResult.ExecuteIfBound(RangeRequest.PromQL, Result, RangeRequest.bDelta);
+		}
+	}
+
+	if (RangeRequest.bDelta)
+	{
+		OnRangeQueryDelta.Broadcast(RangeRequest.PromQL, Result);
+	}
+	else
+	{
+		OnRangeQueryResponse.Broadcast(RangeRequest.PromQL, Result);
+	}
 }
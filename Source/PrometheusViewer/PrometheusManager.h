@@ -5,6 +5,9 @@
 #include "Interfaces/IHttpRequest.h"
 #include "Interfaces/IHttpResponse.h"
 #include "Delegates/DelegateCombinations.h"
+#include "PrometheusSeries.h"
+#include "PrometheusSeriesCache.h"
+#include "PrometheusMetricIndex.h"
 #include "PrometheusManager.generated.h"
 
 
@@ -13,7 +16,15 @@ class UTextBlock;
 class ULineChartWidget;
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnPrometheusQueryResponse, const FString&, PromQL, const FString&, Result);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMetricsFetchedDelegate, const TArray<FString>&, Metrics);
-DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnRangeQueryResponse, const FString&, PromQL, const TArray<FVector2D>&, DataPoints);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnRangeQueryResponse, const FString&, PromQL, const FPrometheusRangeResult&, Result);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnRangeQueryDelta, const FString&, PromQL, const FPrometheusRangeResult&, NewSamples);
+
+// Subscription 用的 native delegate，只會收到自己訂閱的 query
+DECLARE_DELEGATE_TwoParams(FOnPrometheusInstantResult, const FString& /*PromQL*/, const FString& /*Result*/);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnPrometheusMetricIndexReady, const TSharedPtr<const FPrometheusMetricIndex>& /*Index*/);
+DECLARE_DELEGATE_ThreeParams(FOnPrometheusRangeResult, const FString& /*PromQL*/, const FPrometheusRangeResult& /*Result*/, bool /*bDelta*/);
+struct FPrometheusRangeRequest;
+DECLARE_DELEGATE_TwoParams(FOnPrometheusRangeTileResult, const FPrometheusRangeRequest& /*TileRequest*/, const FPrometheusRangeResult& /*Result*/);
 
 
 USTRUCT(BlueprintType)
@@ -46,8 +57,9 @@ struct FDataPoint
 {
 	GENERATED_BODY()
 
+	// Unix 時間 (秒)，用 float 存時誤差可達上百秒
 	UPROPERTY(BlueprintReadWrite)
-	float Time;
+	double Time;
 
 	UPROPERTY(BlueprintReadWrite)
 	float Value;
@@ -56,44 +68,156 @@ struct FDataPoint
 		: Time(0), Value(0)
 	{}
 
-	FDataPoint(float InTime, float InValue)	: Time(InTime), Value(InValue) {}
+	FDataPoint(double InTime, float InValue)	: Time(InTime), Value(InValue) {}
 };
 
+
 USTRUCT(BlueprintType)
-struct FPrometheusQueryInfo
+struct FPrometheusRangeQueryInfo
 {
 	GENERATED_BODY()
 
 	UPROPERTY()
-	FString PromQL;
+	FString Description;
 
 	UPROPERTY()
-	FString Description;
+	FString PromQL;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FColor LineColor;
 
 	UPROPERTY()
-	TWeakObjectPtr<UTextBlock> UITextRef;
+	ULineChartWidget* LineChartWidgetRef;
 };
 
 
-USTRUCT(BlueprintType)
-struct FPrometheusRangeQueryInfo
+// 單次 query_range 請求的參數
+struct FPrometheusRangeRequest
 {
-	GENERATED_BODY()
+	FString PromQL;
+	double StartTime = 0.0;
+	double EndTime = 0.0;
+	float StepSeconds = 5.f;
 
-	UPROPERTY()
-	FString Description;
+	// true 表示只抓上次之後的新 sample，結果要接在現有資料後面
+	bool bDelta = false;
 
-	UPROPERTY()
+	// zoom/pan 補抓的歷史區塊，不更新增量狀態、磁碟快取與排程
+	bool bTile = false;
+
+	// FPrometheusQueryTrace 的 correlation id，送出時才指定，0 表示不追蹤
+	uint32 TraceId = 0;
+
+	int32 GetExpectedPointsPerSeries() const;
+
+	// 請求合併用的 key: PromQL + 範圍 + step (時間已對齊)
+	FString GetRequestKey() const;
+};
+
+// 每個 registered query 的增量抓取狀態
+struct FPrometheusRangeQueryState
+{
+	double LastTimestamp = 0.0;
+	float StepSeconds = 5.f;
+};
+
+// 進行中的 HTTP 請求，相同 key 的後續請求只增加 waiter
+struct FPrometheusInFlightRequest
+{
+	FHttpRequestPtr HttpRequest;
 	FString PromQL;
+	int32 NumWaiters = 1;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	FColor LineColor;
+	// 送出時的 query generation，被新的選擇取代後回應會在解析前丟棄
+	uint32 Generation = 0;
+};
 
-	UPROPERTY()
-	ULineChartWidget* LineChartWidgetRef;
+// 等待送出的 HTTP 請求，可見 widget 的請求優先，同優先度依序送出
+struct FPrometheusQueuedRequest
+{
+	TSharedPtr<IHttpRequest, ESPMode::ThreadSafe> HttpRequest;
+	FString PromQL;
+	int32 Priority = 0;
+	uint64 Sequence = 0;
+	uint32 TraceId = 0;
+};
+
+struct FPrometheusQueuedRequestPredicate
+{
+	bool operator()(const FPrometheusQueuedRequest& A, const FPrometheusQueuedRequest& B) const
+	{
+		return A.Priority != B.Priority ? A.Priority > B.Priority : A.Sequence < B.Sequence;
+	}
+};
+
+// 本輪已完成的結果，在下一個對齊時間之前重複請求直接重用
+struct FPrometheusCachedRangeResult
+{
+	double ExpireTime = 0.0;
+	FPrometheusRangeResult Result;
+};
+
+struct FPrometheusCachedInstantResult
+{
+	double ExpireTime = 0.0;
+	FString Value;
+};
+
+// Subscribe 回傳的 handle，以 query id (PromQL) 為 key
+struct FPrometheusSubscriptionHandle
+{
+	FString QueryId;
+	uint64 Id = 0;
+
+	bool IsValid() const { return Id != 0; }
+	void Reset()
+	{
+		QueryId.Reset();
+		Id = 0;
+	}
+};
+
+struct FPrometheusQuerySubscriber
+{
+	uint64 Id = 0;
+
+	// Owner 被銷毀後在下次派送時自動移除
+	TWeakObjectPtr<const UObject> Owner;
+
+	// 最後一次被畫出來的時間 (FPlatformTime::Seconds)，排程器用來判斷是否可見
+	double LastVisibleTime = 0.0;
+
+	// 最後一次 paint 時圖表的繪圖寬度 (像素)，決定 range query 的 step
+	float PixelWidth = 0.0f;
+
+	FOnPrometheusInstantResult OnInstantResult;
+	FOnPrometheusRangeResult OnRangeResult;
+	FOnPrometheusRangeTileResult OnTileResult;
+};
+
+// count() 預先查詢得到的 series 數量
+struct FPrometheusSeriesCountEstimate
+{
+	int32 NumSeries = 0;
+	double UpdatedTime = 0.0;
+	bool bPending = false;
+
+	// 等待結果時最後一次要求的範圍查詢參數，回來後用它繼續
+	float PendingRangeSeconds = 0.0f;
+	float PendingStepSeconds = 0.0f;
 };
 
+// 每個 registered query 的排程狀態
+struct FPrometheusQuerySchedule
+{
+	double NextDueTime = 0.0;
+	double LastRunTime = 0.0;
+	double LastFailedRunTime = -1.0;
 
+	// 依 PromQL 固定的相位 [0, 1)，讓各 query 不會在同一個 frame 送出
+	float Phase = 0.0f;
+	int32 ConsecutiveFailures = 0;
+};
 
 UCLASS()
 class PROMETHEUSVIEWER_API APrometheusManager : public AActor
@@ -105,6 +229,8 @@ public:
 	UPROPERTY(EditAnywhere, Category = "PrometheusManage")
 	FString Target_IP;
 	UPROPERTY(EditAnywhere, Category = "PrometheusManage")
+	int32 TargetPort = 9090;
+	UPROPERTY(EditAnywhere, Category = "PrometheusManage")
 	FString Account;
 	UPROPERTY(EditAnywhere, Category = "PrometheusManage")
 	FString Password;
@@ -118,30 +244,85 @@ public:
 
 	TArray<FPrometheusRangeQueryInfo> RangeQueryList;
 
-	TArray<FPrometheusQueryInfo> QueryList;
-
 	TMap<FString, TWeakObjectPtr<ULineChartWidget>> LineChartMap;
-	TMap<FString, TWeakObjectPtr<UTextBlock>> QueryTextMap;
 
 	void FetchAvailableMetrics();
-	void OnRangeQueryResponseReceived(const FString& PromQL, const FString& JsonString);
+	// 已在 worker 解析完成的結果，只在 game thread 呼叫
+	void OnRangeQueryResponseReceived(const FPrometheusRangeRequest& RangeRequest, FPrometheusRangeResult&& Result);
 	UFUNCTION(BlueprintCallable, Category = "Prometheus")
 	void HandleRangeQuery(const FString& PromQL, float RangeSeconds, float StepSeconds);
 	UPROPERTY(BlueprintAssignable, Category = "Prometheus")
 	FOnRangeQueryResponse OnRangeQueryResponse;
 
+	// 只抓上次收到的最後 sample 之後的資料，沒有歷史時退回完整的 HandleRangeQuery
+	UFUNCTION(BlueprintCallable, Category = "Prometheus")
+	void HandleIncrementalRangeQuery(const FString& PromQL);
+
+	// 圖表縮放/平移到沒有資料的範圍時呼叫，結果只送給訂閱者的 OnTileResult
+	UFUNCTION(BlueprintCallable, Category = "Prometheus")
+	void RequestRangeTile(const FString& PromQL, double StartTime, double EndTime, float StepSeconds);
+
+	// 增量查詢的新 sample，接收端應 append 而不是取代
+	UPROPERTY(BlueprintAssignable, Category = "Prometheus")
+	FOnRangeQueryDelta OnRangeQueryDelta;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
+	bool bIncrementalRangeQueries = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
+	float RangeWindowSeconds = 300.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
+	float RangeStepSeconds = 5.0f;
+
+	TMap<FString, FPrometheusRangeQueryState> RangeQueryStates;
+
+	// 目前這個 query 使用的 step (最後一次完整範圍查詢決定)
+	float GetRangeStep(const FString& PromQL) const;
+
+	// 依圖表寬度與點數上限計算 step，傳入的 step 當作下限
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
+	bool bAutoRangeStep = true;
+
+	// 每個 series 最多的點數 (圖表寬度較小時以寬度為準)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config", meta = (ClampMin = "2"))
+	int32 MaxPointsPerSeries = 1000;
+
+	// 單一 range query 所有 series 加起來的點數上限，超過時放大 step，連每個 series 2 點都放不下時拒絕；0 表示不限制
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config", meta = (ClampMin = "0"))
+	int32 MaxTotalPoints = 200000;
+
+	// 送出 range query 前先以 count() 估計 series 數量，結果保留 SeriesCountMaxAgeSeconds
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
+	bool bEstimateSeriesCount = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
+	float SeriesCountMaxAgeSeconds = 300.0f;
+
+	// Request broker: 相同 key 的請求同一時間只有一個 HTTP 請求與一次解析
+	TMap<FString, FPrometheusInFlightRequest> InFlightRequests;
+	TMap<FString, FPrometheusCachedRangeResult> CompletedRangeResults;
+	TMap<FString, FPrometheusCachedInstantResult> CompletedInstantResults;
+
+	static double AlignTime(double Time, double StepSeconds);
+
 	FTimerHandle QueryTimerHandle;
 	void HandleQuery(const FString& PromQL);
 
 	UPROPERTY(BlueprintAssignable)
 	FOnPrometheusQueryResponse OnQueryResponse;
 
-	TArray<FString> CachedMetrics;
 	bool bMetricsFetched = false;
+	bool bMetricsFetchInFlight = false;
 
+	// Blueprint 用，只有在有綁定時才會展開成陣列
 	UPROPERTY(BlueprintAssignable, Category = "Prometheus")
 	FMetricsFetchedDelegate OnMetricsFetched;
 
+	// 所有 widget 共用同一份 metric 名稱索引
+	const TSharedPtr<const FPrometheusMetricIndex>& GetMetricIndex() const { return MetricIndex; }
+	FOnPrometheusMetricIndexReady OnMetricIndexReady;
+
 	UPROPERTY()
 	TArray<FString> MetricNameList;
 
@@ -151,28 +332,184 @@ public:
 	UPROPERTY(EditDefaultsOnly, Category = "Prometheus")
 	UDataTable* PromQLMappingTable;
 
-	void AddDynamicQuery(const FPrometheusQueryInfo& Info);
-
 	TMap<FString, TMap<FString, FString>> PromQLMappings;
 
 	void LoadPromQLMappings();
 
 	FString GetPromQLFromMapping(const FString& Metric, const FString& Type) const;
 
+	// 每個 query 的更新間隔，會對齊到 ScrapeIntervalSeconds 的整數倍
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
 	float QueryInterval = 5.0f;
 
+	// Prometheus 的 scrape interval，比這個更頻繁的查詢只會拿到相同的資料
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
+	float ScrapeIntervalSeconds = 5.0f;
+
+	// 每個 query 在間隔內錯開的比例
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config", meta = (ClampMin = "0", ClampMax = "1"))
+	float SchedulerJitterFraction = 0.2f;
+
+	// 失敗時指數退避的上限 (秒)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
+	float MaxBackoffSeconds = 120.0f;
+
+	// 超過這個時間沒有被畫出來的 widget 視為隱藏，它的 query 暫停
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
+	float VisibilityTimeoutSeconds = 1.0f;
+
 	FTimerHandle AutoQueryTimer;
 
 	void ExecuteAutoQueries();
 
+	// 要求 gzip 回應，在 worker 解壓縮
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
+	bool bRequestGzip = true;
+
+	// 收到的 body 大小累計 (傳輸時 / 解壓縮後)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
+	int64 ReceivedCompressedBytes = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
+	int64 ReceivedUncompressedBytes = 0;
+
+	// 實際送出的 HTTP 請求數 (合併或重用快取的不算)
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
+	int64 SentHttpRequests = 0;
+
+	// 排程與結果派送在 game thread 上花的時間累計 (秒)，以及有送出查詢的排程次數
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
+	double GameThreadQuerySeconds = 0.0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Stats")
+	int32 NumAutoQueryRefreshes = 0;
+
+	// 內部容器與綁定的數量，長時間執行時用來檢查有沒有持續成長
+	void GetDiagnosticCounts(TArray<TPair<FString, int32>>& OutCounts) const;
+
+	// 本機 series 快取: 啟動時先畫出上次的資料，只補抓缺少的部分
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
+	bool bUseSeriesCache = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config", meta = (ClampMin = "1"))
+	int32 SeriesCacheMaxFileMB = 4;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config", meta = (ClampMin = "1"))
+	int32 SeriesCacheMaxTotalMB = 64;
+
+	// 在本機 MetricsPort 提供 viewer 自己的 /metrics (Prometheus text format)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config")
+	bool bServeMetrics = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config", meta = (ClampMin = "1", ClampMax = "65535"))
+	int32 MetricsPort = 9464;
+
+	// 同時進行中的 HTTP 請求上限，其餘排隊
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Config", meta = (ClampMin = "1"))
+	int32 MaxConcurrentRequests = 4;
+
+	// Widget 每次 paint 時呼叫，讓排程器知道這個訂閱目前可見
+	void MarkSubscriptionVisible(const FPrometheusSubscriptionHandle& Handle, float PixelWidth = 0.0f);
+
 	void RegisterQuery(const FString& PromQL);
 
 	UPROPERTY()
 	TArray<FString> RegisteredQueries; 
 
+	// 訂閱單一 query 的結果，派送時只查這個 query 的訂閱者 (與 dashboard 大小無關)
+	FPrometheusSubscriptionHandle Subscribe(const FString& PromQL, const UObject* Owner,
+		FOnPrometheusInstantResult OnInstantResult, FOnPrometheusRangeResult OnRangeResult,
+		FOnPrometheusRangeTileResult OnTileResult = FOnPrometheusRangeTileResult());
+
+	// 最後一個訂閱者離開時，該 query 也會停止自動查詢
+	void Unsubscribe(FPrometheusSubscriptionHandle& Handle);
+
+	void UnregisterQuery(const FString& PromQL);
+
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	void SendRangeQuery(FPrometheusRangeRequest RangeRequest);
+	void BroadcastRangeResult(const FPrometheusRangeRequest& RangeRequest, const FPrometheusRangeResult& Result);
+	void PruneCompletedResults(double Now);
+	void DispatchInstantResult(const FString& PromQL, const FString& Result);
+
+	FString GetBaseUrl() const;
+	void SetCommonHeaders(IHttpRequest& Request) const;
+	void RecordTransferBytes(int64 CompressedBytes, int64 UncompressedBytes);
+
+	// 在 worker thread 執行，不可存取 UObject
+	// gzip 內容解壓縮到 thread_local buffer，OutBody 在同一個 thread 下次呼叫前有效
+	static bool DecodeResponseBody(const FHttpResponsePtr& Response, TArrayView<const uint8>& OutBody);
+
+	// 解壓縮後的大小上限，以及 deflate 的最大壓縮比 (約 1032:1)
+	static constexpr int32 MaxDecompressedBytes = 256 * 1024 * 1024;
+	static constexpr int32 MaxDeflateRatio = 1032;
+	// thread_local buffer 超過這個大小時不保留，下次解壓縮前釋放
+	static constexpr int32 RetainedDecompressBytes = 16 * 1024 * 1024;
+	static FString BodyToString(TArrayView<const uint8> Body);
+	static FString ParseInstantQueryValue(const FString& Content);
+	static TArray<FString> ParseMetricNames(const FString& Content);
+
+	TMap<FString, TArray<FPrometheusQuerySubscriber>> Subscriptions;
+	uint64 NextSubscriptionId = 1;
+
+	// 排程: 對齊 scrape interval、錯開相位、失敗退避、隱藏時暫停
+	float GetScheduledInterval() const;
+	bool IsQueryVisible(const FString& PromQL, double PlatformNow) const;
+	void ScheduleNextRun(FPrometheusQuerySchedule& Schedule, double Now) const;
+	void ReportQueryResult(const FString& PromQL, bool bSuccess);
+	void ReportRangeResult(const FPrometheusRangeRequest& RangeRequest, bool bSuccess);
+	static double GetUnixTimeSeconds();
+
+	TMap<FString, FPrometheusQuerySchedule> QuerySchedules;
+
+	// 沒有狀態的 query 在背景讀磁碟快取，讀到時先廣播，再以增量查詢補上快取之後的部分；
+	// 回傳 true 表示讀取中，結果回來前不送完整的範圍查詢
+	bool TryWarmStartFromCache(const FString& PromQL, float RangeSeconds, float StepSeconds);
+	void OnSeriesCacheLoaded(const FString& PromQL, uint32 LoadId, float RangeSeconds, float StepSeconds, FPrometheusRangeResult&& Cached);
+	FString GetSeriesCacheKey(const FString& PromQL, float StepSeconds) const;
+
+	// 送出 [now - RangeSeconds, now] 的完整範圍查詢
+	void SendFullRangeQuery(const FString& PromQL, float RangeSeconds, float StepSeconds);
+
+	// 讀取中的快取 (PromQL -> 讀取編號)，UnregisterQuery 時移除，之後回來的結果會被丟棄
+	TMap<FString, uint32> PendingCacheLoads;
+	uint32 NextCacheLoadId = 1;
+
+	TUniquePtr<FPrometheusSeriesCache> SeriesCache;
+
+	// step 選擇: 對齊 scrape interval 的整數倍，快取 key 才會穩定；回傳 <= 0 表示超過點數上限
+	float ChooseRangeStep(const FString& PromQL, float RangeSeconds, float MinStepSeconds) const;
+	float RoundStepToScrapeInterval(float StepSeconds) const;
+	float GetQueryPixelWidth(const FString& PromQL) const;
+
+	// 沒有估計值或已過期時送出 count() 查詢並回傳 true，結果回來後重新呼叫 HandleRangeQuery
+	bool RequestSeriesCountIfNeeded(const FString& PromQL, float RangeSeconds, float StepSeconds);
+
+	TMap<FString, FPrometheusSeriesCountEstimate> SeriesCountEstimates;
+
+	void BroadcastMetricsFetched(const TSharedPtr<const FPrometheusMetricIndex>& Index);
+	TSharedPtr<const FPrometheusMetricIndex> MetricIndex;
+
+	// 請求佇列: 限制同時進行的 HTTP 請求數
+	void EnqueueHttpRequest(const TSharedRef<IHttpRequest, ESPMode::ThreadSafe>& Request, const FString& PromQL, int32 Priority, uint32 TraceId = 0);
+	void OnHttpRequestFinished(const FHttpRequestPtr& Request);
+	void PumpRequestQueue();
+	// 把請求移出進行中的集合，不在集合內 (已釋放過) 時回傳 false
+	bool ReleaseHttpRequest(const FHttpRequestPtr& Request);
+	int32 GetRequestPriority(const FString& PromQL) const;
+
+	// 取消已被取代的 query 的排隊與進行中請求，並讓尚未解析的回應失效
+	void CancelQueryRequests(const FString& PromQL);
+	uint32 GetQueryGeneration(const FString& PromQL) const;
+	bool IsRequestCurrent(const FString& RequestKey, const FHttpRequestPtr& Request) const;
+
+	TArray<FPrometheusQueuedRequest> PendingHttpRequests;
+	// 已送出、還沒釋放併發名額的請求，每個請求只會釋放一次
+	TSet<FHttpRequestPtr> ActiveHttpRequests;
+	uint64 NextRequestSequence = 0;
+	TMap<FString, uint32> QueryGenerations;
 	TArray<FMonitoringRequest> PendingMonitoringRequests;
 
 };
@@ -0,0 +1,100 @@
+#include "PrometheusMetricIndex.h"
+#include "Algo/LowerBound.h"
+
+FPrometheusMetricIndex::FPrometheusMetricIndex(TArray<FString>&& InNames)
+{
+	InNames.Sort([](const FString& A, const FString& B) { return A.Compare(B, ESearchCase::IgnoreCase) < 0; });
+
+	Names.Reserve(InNames.Num());
+	for (FString& Name : InNames)
+	{
+		if (Names.Num() > 0 && Names.Last()->Equals(Name, ESearchCase::CaseSensitive))
+		{
+			continue;
+		}
+		Names.Add(MakeShared<const FString>(MoveTemp(Name)));
+	}
+}
+
+int32 FPrometheusMetricIndex::GetFuzzySpan(const FString& Name, const FString& Query)
+{
+	int32 First = INDEX_NONE;
+	int32 QueryIndex = 0;
+	for (int32 i = 0; i < Name.Len() && QueryIndex < Query.Len(); ++i)
+	{
+		if (FChar::ToLower(Name[i]) == FChar::ToLower(Query[QueryIndex]))
+		{
+			if (First == INDEX_NONE)
+			{
+				First = i;
+			}
+			if (++QueryIndex == Query.Len())
+			{
+				return i - First + 1;
+			}
+		}
+	}
+	return INDEX_NONE;
+}
+
+void FPrometheusMetricIndex::Search(const FString& Query, TArray<TSharedPtr<const FString>>& OutResults, int32 MaxResults) const
+{
+	OutResults.Reset();
+
+	const int32 Limit = MaxResults > 0 ? MaxResults : MAX_int32;
+	if (Query.IsEmpty())
+	{
+		OutResults.Append(Names.GetData(), FMath::Min(Names.Num(), Limit));
+		return;
+	}
+
+	// Prefix: 排序過的名稱中連續的一段
+	const int32 PrefixStart = Algo::LowerBound(Names, Query, [](const TSharedPtr<const FString>& Name, const FString& Value)
+	{
+		return Name->Compare(Value, ESearchCase::IgnoreCase) < 0;
+	});
+	int32 PrefixEnd = PrefixStart;
+	while (PrefixEnd < Names.Num() && Names[PrefixEnd]->StartsWith(Query, ESearchCase::IgnoreCase))
+	{
+		++PrefixEnd;
+	}
+	for (int32 i = PrefixStart; i < PrefixEnd && OutResults.Num() < Limit; ++i)
+	{
+		OutResults.Add(Names[i]);
+	}
+
+	// Substring 與 fuzzy 需要掃過其餘的名稱
+	TArray<TPair<int32, int32>> FuzzyMatches;
+	for (int32 i = 0; i < Names.Num() && OutResults.Num() < Limit; ++i)
+	{
+		if (i == PrefixStart && PrefixEnd > PrefixStart)
+		{
+			i = PrefixEnd - 1;
+			continue;
+		}
+
+		const FString& Name = *Names[i];
+		if (Name.Contains(Query, ESearchCase::IgnoreCase))
+		{
+			OutResults.Add(Names[i]);
+		}
+		else
+		{
+			const int32 Span = GetFuzzySpan(Name, Query);
+			if (Span != INDEX_NONE)
+			{
+				FuzzyMatches.Emplace(Span, i);
+			}
+		}
+	}
+
+	FuzzyMatches.StableSort([](const TPair<int32, int32>& A, const TPair<int32, int32>& B) { return A.Key < B.Key; });
+	for (const TPair<int32, int32>& Match : FuzzyMatches)
+	{
+		if (OutResults.Num() >= Limit)
+		{
+			break;
+		}
+		OutResults.Add(Names[Match.Value]);
+	}
+}
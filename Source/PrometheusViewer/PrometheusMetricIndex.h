@@ -0,0 +1,29 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * 共用的 metric 名稱索引。名稱只存一份 (依字母排序、不分大小寫)，
+ * 建好之後不再修改，可以在 worker 建立後交給多個 widget 共用。
+ */
+class PROMETHEUSVIEWER_API FPrometheusMetricIndex
+{
+public:
+	explicit FPrometheusMetricIndex(TArray<FString>&& InNames);
+
+	int32 Num() const { return Names.Num(); }
+
+	const TArray<TSharedPtr<const FString>>& GetNames() const { return Names; }
+
+	/**
+	 * 依符合程度排序: prefix (二分搜尋) > substring > fuzzy (依序包含所有字元，間隔越小越前面)。
+	 * Query 為空時回傳全部；MaxResults <= 0 表示不限制。
+	 */
+	void Search(const FString& Query, TArray<TSharedPtr<const FString>>& OutResults, int32 MaxResults = 0) const;
+
+	// 依序包含 Query 的所有字元 (不分大小寫) 時回傳涵蓋的長度，否則 INDEX_NONE
+	static int32 GetFuzzySpan(const FString& Name, const FString& Query);
+
+private:
+	TArray<TSharedPtr<const FString>> Names;
+};
@@ -0,0 +1,244 @@
+#include "PrometheusMockServer.h"
+
+#if !UE_BUILD_SHIPPING
+
+#include "HttpServerModule.h"
+#include "IHttpRouter.h"
+#include "HttpServerRequest.h"
+#include "HttpServerResponse.h"
+#include "GenericPlatform/GenericPlatformHttp.h"
+#include "HAL/PlatformTime.h"
+#include "Containers/StringConv.h"
+#include "Misc/Compression.h"
+
+namespace PrometheusMockServer
+{
+	static TArray<uint8> ToUtf8(const FString& Json)
+	{
+		FTCHARToUTF8 Converter(*Json);
+		return TArray<uint8>(reinterpret_cast<const uint8*>(Converter.Get()), Converter.Length());
+	}
+
+	static FString GetSeriesLabels(int32 SeriesIndex)
+	{
+		return FString::Printf(TEXT("{\"__name__\":\"node_cpu_seconds_total\",\"instance\":\"10.0.%d.%d:9100\",\"job\":\"node\"}"),
+			SeriesIndex / 256, SeriesIndex % 256);
+	}
+
+	// 依絕對時間產生，同一個時間點每次請求的值都相同
+	static double GetSampleValue(int32 SeriesIndex, int64 Time)
+	{
+		return FMath::Sin(Time * 0.02) * 100.0 + SeriesIndex;
+	}
+
+	static bool AcceptsGzip(const FHttpServerRequest& Request)
+	{
+		if (const TArray<FString>* Values = Request.Headers.Find(TEXT("Accept-Encoding")))
+		{
+			for (const FString& Value : *Values)
+			{
+				if (Value.Contains(TEXT("gzip")))
+				{
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	static bool CompressGzip(const TArray<uint8>& Payload, TArray<uint8>& OutCompressed)
+	{
+		int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Gzip, Payload.Num());
+		OutCompressed.SetNumUninitialized(CompressedSize);
+		if (!FCompression::CompressMemory(NAME_Gzip, OutCompressed.GetData(), CompressedSize, Payload.GetData(), Payload.Num()))
+		{
+			OutCompressed.Reset();
+			return false;
+		}
+		OutCompressed.SetNum(CompressedSize);
+		return true;
+	}
+}
+
+TArray<uint8> FPrometheusMockServer::BuildRangePayload(int32 NumSeries, int64 StartTime, int64 StepSeconds, int32 NumPoints)
+{
+	using namespace PrometheusMockServer;
+
+	FString Json = TEXT("{\"status\":\"success\",\"data\":{\"resultType\":\"matrix\",\"result\":[");
+	for (int32 s = 0; s < NumSeries; ++s)
+	{
+		if (s > 0)
+		{
+			Json += TEXT(",");
+		}
+		Json += FString::Printf(TEXT("{\"metric\":%s,\"values\":["), *GetSeriesLabels(s));
+		for (int32 p = 0; p < NumPoints; ++p)
+		{
+			if (p > 0)
+			{
+				Json += TEXT(",");
+			}
+			const int64 Time = StartTime + p * StepSeconds;
+			Json += FString::Printf(TEXT("[%lld,\"%.6f\"]"), Time, GetSampleValue(s, Time));
+		}
+		Json += TEXT("]}");
+	}
+	Json += TEXT("]}}");
+	return ToUtf8(Json);
+}
+
+TArray<uint8> FPrometheusMockServer::BuildInstantPayload(int32 NumSeries)
+{
+	using namespace PrometheusMockServer;
+
+	const int64 Now = FDateTime::UtcNow().ToUnixTimestamp();
+
+	FString Json = TEXT("{\"status\":\"success\",\"data\":{\"resultType\":\"vector\",\"result\":[");
+	for (int32 s = 0; s < NumSeries; ++s)
+	{
+		if (s > 0)
+		{
+			Json += TEXT(",");
+		}
+		Json += FString::Printf(TEXT("{\"metric\":%s,\"value\":[%lld,\"%.6f\"]}"), *GetSeriesLabels(s), Now, GetSampleValue(s, Now));
+	}
+	Json += TEXT("]}}");
+	return ToUtf8(Json);
+}
+
+TArray<uint8> FPrometheusMockServer::BuildMetricNamesPayload(int32 NumMetrics)
+{
+	using namespace PrometheusMockServer;
+
+	FString Json = TEXT("{\"status\":\"success\",\"data\":[");
+	for (int32 i = 0; i < NumMetrics; ++i)
+	{
+		if (i > 0)
+		{
+			Json += TEXT(",");
+		}
+		Json += FString::Printf(TEXT("\"mock_metric_%04d\""), i);
+	}
+	Json += TEXT("]}");
+	return ToUtf8(Json);
+}
+
+bool FPrometheusMockServer::Start(const FOptions& InOptions)
+{
+	using namespace PrometheusMockServer;
+
+	Stop();
+
+	Options = InOptions;
+	Options.NumSeries = FMath::Max(Options.NumSeries, 1);
+	Options.NumPoints = FMath::Clamp(Options.NumPoints, 1, MaxPointsPerSeries);
+
+	const int64 Now = FDateTime::UtcNow().ToUnixTimestamp();
+	RangePayload = BuildRangePayload(Options.NumSeries, Now - Options.NumPoints * 5, 5, Options.NumPoints);
+	InstantPayload = BuildInstantPayload(Options.NumSeries);
+	CountPayload = ToUtf8(FString::Printf(TEXT("{\"status\":\"success\",\"data\":{\"resultType\":\"vector\",\"result\":[{\"metric\":{},\"value\":[%lld,\"%d\"]}]}}"),
+		Now, Options.NumSeries));
+	MetricNamesPayload = BuildMetricNamesPayload(Options.NumMetricNames);
+
+	Router = FHttpServerModule::Get().GetHttpRouter(Options.Port, true);
+	if (!Router.IsValid())
+	{
+		UE_LOG(LogTemp, Error, TEXT("[MockPrometheus] Could not bind port %u"), Options.Port);
+		return false;
+	}
+
+	Routes.Add(Router->BindRoute(FHttpPath(TEXT("/api/v1/query_range")), EHttpServerRequestVerbs::VERB_GET,
+		FHttpRequestHandler::CreateRaw(this, &FPrometheusMockServer::HandleRange)));
+	Routes.Add(Router->BindRoute(FHttpPath(TEXT("/api/v1/query")), EHttpServerRequestVerbs::VERB_GET,
+		FHttpRequestHandler::CreateRaw(this, &FPrometheusMockServer::HandleInstant)));
+	Routes.Add(Router->BindRoute(FHttpPath(TEXT("/api/v1/label/__name__/values")), EHttpServerRequestVerbs::VERB_GET,
+		FHttpRequestHandler::CreateLambda([this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			return Serve(Request, MetricNamesPayload, FPlatformTime::Seconds(), OnComplete);
+		})));
+
+	FHttpServerModule::Get().StartAllListeners();
+
+	UE_LOG(LogTemp, Display, TEXT("[MockPrometheus] Listening on 127.0.0.1:%u (%d series, %s%s)"), Options.Port, Options.NumSeries,
+		Options.bDynamicRanges ? TEXT("ranges follow start/end/step") : *FString::Printf(TEXT("%d points, %d bytes"), Options.NumPoints, RangePayload.Num()),
+		Options.bGzip ? TEXT(", gzip") : TEXT(""));
+	return true;
+}
+
+void FPrometheusMockServer::Stop()
+{
+	if (!Router.IsValid())
+	{
+		return;
+	}
+
+	for (const FHttpRouteHandle& Route : Routes)
+	{
+		Router->UnbindRoute(Route);
+	}
+	Routes.Reset();
+	Router.Reset();
+	// listener 不關，同一個 HTTP server 上可能還有 /metrics
+}
+
+bool FPrometheusMockServer::HandleRange(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	const FString* Start = Request.QueryParams.Find(TEXT("start"));
+	const FString* End = Request.QueryParams.Find(TEXT("end"));
+	const FString* Step = Request.QueryParams.Find(TEXT("step"));
+	if (!Options.bDynamicRanges || !Start || !End || !Step)
+	{
+		return Serve(Request, RangePayload, StartTime, OnComplete);
+	}
+
+	// 與 Prometheus 相同: 從 start 開始每 step 一點，直到 end
+	const int64 StepSeconds = FMath::Max<int64>(FMath::RoundToInt64(FCString::Atod(**Step)), 1);
+	const int64 First = FMath::CeilToInt64(FCString::Atod(**Start));
+	const int64 Last = FMath::FloorToInt64(FCString::Atod(**End));
+	const int32 NumPoints = Last >= First ? static_cast<int32>(FMath::Min<int64>((Last - First) / StepSeconds + 1, MaxPointsPerSeries)) : 0;
+
+	return Serve(Request, BuildRangePayload(Options.NumSeries, First, StepSeconds, NumPoints), StartTime, OnComplete);
+}
+
+bool FPrometheusMockServer::HandleInstant(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	const FString* Query = Request.QueryParams.Find(TEXT("query"));
+	const bool bCount = Query && FGenericPlatformHttp::UrlDecode(*Query).StartsWith(TEXT("count("));
+	return Serve(Request, bCount ? CountPayload : InstantPayload, StartTime, OnComplete);
+}
+
+bool FPrometheusMockServer::Serve(const FHttpServerRequest& Request, TArray<uint8> Payload, double StartTime, const FHttpResultCallback& OnComplete)
+{
+	using namespace PrometheusMockServer;
+
+	TUniquePtr<FHttpServerResponse> Response = MakeUnique<FHttpServerResponse>();
+	Response->Code = EHttpServerResponseCodes::Ok;
+	Response->Headers.Add(TEXT("Content-Type"), { TEXT("application/json") });
+	ServedPayloadBytes += Payload.Num();
+
+	TArray<uint8> Compressed;
+	if (Options.bGzip && AcceptsGzip(Request) && CompressGzip(Payload, Compressed))
+	{
+		Response->Headers.Add(TEXT("Content-Encoding"), { TEXT("gzip") });
+		Response->Body = MoveTemp(Compressed);
+		++NumGzipServed;
+	}
+	else
+	{
+		Response->Body = MoveTemp(Payload);
+	}
+	ServedBodyBytes += Response->Body.Num();
+
+	LastServedTime = FPlatformTime::Seconds();
+	ServeSeconds += LastServedTime - StartTime;
+	++NumServed;
+
+	OnComplete(MoveTemp(Response));
+	return true;
+}
+
+#endif
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if !UE_BUILD_SHIPPING
+
+#include "HttpRouteHandle.h"
+#include "HttpResultCallback.h"
+
+class IHttpRouter;
+struct FHttpServerRequest;
+
+/**
+ * 開發用的本機假 Prometheus (Prometheus.Bench.* 與 Prometheus.Soak.Run)。
+ * query_range 回傳 NumSeries 個 series: bDynamicRanges 時依請求的 start/end/step 產生 sample，
+ * 否則固定回傳啟動時產生的 NumPoints 個點。instant query 每個 series 一個值，count() 回傳 series 數。
+ * bGzip 時請求帶有 Accept-Encoding: gzip 就以 gzip 壓縮回應。
+ * HTTP server 在 game thread tick，處理函式也在 game thread 執行。
+ */
+class PROMETHEUSVIEWER_API FPrometheusMockServer
+{
+public:
+	struct FOptions
+	{
+		uint32 Port = 19090;
+		int32 NumSeries = 50;
+		int32 NumPoints = 61;
+		int32 NumMetricNames = 200;
+		bool bDynamicRanges = false;
+		bool bGzip = false;
+	};
+
+	bool Start(const FOptions& InOptions);
+	void Stop();
+
+	bool IsRunning() const { return Router.IsValid(); }
+	uint32 GetPort() const { return Options.Port; }
+	int32 GetRangePayloadSize() const { return RangePayload.Num(); }
+
+	// 最後一個回應交給 server 的時間 (FPlatformTime::Seconds)
+	double GetLastServedTime() const { return LastServedTime; }
+
+	int64 GetNumServed() const { return NumServed; }
+
+	// 執行中切換是否壓縮回應，之後的請求才生效
+	void SetGzip(bool bEnable) { Options.bGzip = bEnable; }
+
+	// 送出的 body 大小累計 (實際傳輸 / 壓縮前)，以及以 gzip 送出的回應數
+	int64 GetServedBodyBytes() const { return ServedBodyBytes; }
+	int64 GetServedPayloadBytes() const { return ServedPayloadBytes; }
+	int64 GetNumGzipServed() const { return NumGzipServed; }
+
+	// 在 game thread 上產生回應花的時間，量測 frame time 時可以扣掉
+	double GetServeSeconds() const { return ServeSeconds; }
+
+	// NumSeries x NumPoints 的 query_range 回應 (UTF-8)，timestamp 從 StartTime 每 StepSeconds 一點
+	static TArray<uint8> BuildRangePayload(int32 NumSeries, int64 StartTime, int64 StepSeconds, int32 NumPoints);
+	static TArray<uint8> BuildInstantPayload(int32 NumSeries);
+	static TArray<uint8> BuildMetricNamesPayload(int32 NumMetrics);
+
+	// Prometheus 單一 series 的點數上限
+	static constexpr int32 MaxPointsPerSeries = 11000;
+
+private:
+	bool HandleRange(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	bool HandleInstant(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete);
+	bool Serve(const FHttpServerRequest& Request, TArray<uint8> Payload, double StartTime, const FHttpResultCallback& OnComplete);
+
+	FOptions Options;
+	TSharedPtr<IHttpRouter> Router;
+	TArray<FHttpRouteHandle> Routes;
+
+	double LastServedTime = 0.0;
+	int64 NumServed = 0;
+	double ServeSeconds = 0.0;
+	int64 ServedBodyBytes = 0;
+	int64 ServedPayloadBytes = 0;
+	int64 NumGzipServed = 0;
+
+	TArray<uint8> RangePayload;
+	TArray<uint8> InstantPayload;
+	TArray<uint8> CountPayload;
+	TArray<uint8> MetricNamesPayload;
+};
+
+#endif
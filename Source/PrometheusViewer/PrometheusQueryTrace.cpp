@@ -0,0 +1,147 @@
+#include "PrometheusQueryTrace.h"
+#include "PrometheusViewerStats.h"
+#include "ProfilingDebugging/MiscTrace.h"
+#include "HAL/PlatformTime.h"
+
+UE_TRACE_CHANNEL_DEFINE(PrometheusViewerChannel);
+
+UE_TRACE_EVENT_BEGIN(PrometheusViewer, QueryBegin)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, CorrelationId)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, PromQL)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(PrometheusViewer, QueryStage)
+	UE_TRACE_EVENT_FIELD(uint64, StartCycle)
+	UE_TRACE_EVENT_FIELD(uint64, EndCycle)
+	UE_TRACE_EVENT_FIELD(uint32, CorrelationId)
+	UE_TRACE_EVENT_FIELD(uint8, Stage)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(PrometheusViewer, QueryEnd)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, CorrelationId)
+	UE_TRACE_EVENT_FIELD(double, EndToEndSeconds)
+	UE_TRACE_EVENT_FIELD(bool, bCanceled)
+UE_TRACE_EVENT_END()
+
+uint32 FPrometheusQueryTrace::CurrentCorrelationId = 0;
+
+namespace PrometheusQueryTrace
+{
+	struct FPendingQuery
+	{
+		double StartTime = 0.0;
+
+		// 只有 channel 開啟時才有，Insights 的 timing region 名稱
+		FString RegionName;
+	};
+
+	// 沒有畫出來的 query (例如 widget 不可見) 過了這個時間就不再追蹤
+	static constexpr double MaxPendingSeconds = 60.0;
+
+	static TMap<uint32, FPendingQuery> GPendingQueries;
+	static uint32 GNextCorrelationId = 1;
+
+	static void Finish(uint32 CorrelationId, bool bCanceled)
+	{
+		FPendingQuery Pending;
+		if (CorrelationId == 0 || !GPendingQueries.RemoveAndCopyValue(CorrelationId, Pending))
+		{
+			return;
+		}
+
+		const double EndToEndSeconds = FPlatformTime::Seconds() - Pending.StartTime;
+		if (!bCanceled)
+		{
+			FPrometheusViewerStats::Get().RecordEndToEndLatency(EndToEndSeconds);
+		}
+
+		UE_TRACE_LOG(PrometheusViewer, QueryEnd, PrometheusViewerChannel)
+			<< QueryEnd.Cycle(FPlatformTime::Cycles64())
+			<< QueryEnd.CorrelationId(CorrelationId)
+			<< QueryEnd.EndToEndSeconds(EndToEndSeconds)
+			<< QueryEnd.bCanceled(bCanceled);
+
+		if (!Pending.RegionName.IsEmpty())
+		{
+			TRACE_END_REGION(*Pending.RegionName);
+		}
+	}
+}
+
+uint32 FPrometheusQueryTrace::Begin(const FString& PromQL)
+{
+	using namespace PrometheusQueryTrace;
+
+	check(IsInGameThread());
+
+	const double Now = FPlatformTime::Seconds();
+	TArray<uint32> Expired;
+	for (const TPair<uint32, FPendingQuery>& Pair : GPendingQueries)
+	{
+		if (Now - Pair.Value.StartTime > MaxPendingSeconds)
+		{
+			Expired.Add(Pair.Key);
+		}
+	}
+	for (uint32 ExpiredId : Expired)
+	{
+		Finish(ExpiredId, true);
+	}
+
+	const uint32 CorrelationId = GNextCorrelationId++;
+	if (GNextCorrelationId == 0)
+	{
+		GNextCorrelationId = 1;
+	}
+
+	FPendingQuery& Pending = GPendingQueries.Add(CorrelationId);
+	Pending.StartTime = Now;
+
+	if (UE_TRACE_CHANNELEXPR_IS_ENABLED(PrometheusViewerChannel))
+	{
+		Pending.RegionName = FString::Printf(TEXT("PrometheusQuery #%u %s"), CorrelationId, *PromQL.Left(64));
+		TRACE_BEGIN_REGION(*Pending.RegionName);
+
+		UE_TRACE_LOG(PrometheusViewer, QueryBegin, PrometheusViewerChannel)
+			<< QueryBegin.Cycle(FPlatformTime::Cycles64())
+			<< QueryBegin.CorrelationId(CorrelationId)
+			<< QueryBegin.PromQL(*PromQL, PromQL.Len());
+	}
+
+	return CorrelationId;
+}
+
+void FPrometheusQueryTrace::End(uint32 CorrelationId)
+{
+	check(IsInGameThread());
+	PrometheusQueryTrace::Finish(CorrelationId, false);
+}
+
+void FPrometheusQueryTrace::Cancel(uint32 CorrelationId)
+{
+	check(IsInGameThread());
+	PrometheusQueryTrace::Finish(CorrelationId, true);
+}
+
+FPrometheusQueryTraceScope::FPrometheusQueryTraceScope(uint32 InCorrelationId, EPrometheusQueryStage InStage)
+	: CorrelationId(InCorrelationId)
+	, Stage(InStage)
+	, StartCycle(FPlatformTime::Cycles64())
+{
+}
+
+FPrometheusQueryTraceScope::~FPrometheusQueryTraceScope()
+{
+	if (CorrelationId == 0)
+	{
+		return;
+	}
+
+	UE_TRACE_LOG(PrometheusViewer, QueryStage, PrometheusViewerChannel)
+		<< QueryStage.StartCycle(StartCycle)
+		<< QueryStage.EndCycle(FPlatformTime::Cycles64())
+		<< QueryStage.CorrelationId(CorrelationId)
+		<< QueryStage.Stage(static_cast<uint8>(Stage));
+}
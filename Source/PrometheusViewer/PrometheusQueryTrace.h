@@ -0,0 +1,80 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+// -trace=default,PrometheusViewer
+UE_TRACE_CHANNEL_EXTERN(PrometheusViewerChannel, PROMETHEUSVIEWER_API);
+
+// 一次 range query 從排程到畫面的各階段
+enum class EPrometheusQueryStage : uint8
+{
+	Schedule,		// SendRangeQuery 決定送出
+	Send,			// ProcessRequest (含排隊之後的送出)
+	Response,		// HTTP 回應回到 game thread
+	Parse,			// worker 上解壓縮與解析
+	Broadcast,		// OnRangeQueryResponse 派送給訂閱者
+	ChartUpdate,	// InitializeChartWithHistory 或增量 append
+	FirstPaint,		// 第一次畫出這份資料的 NativePaint
+};
+
+/**
+ * 每個 range query 一個 correlation id，各階段以 scoped trace event 記錄，
+ * 在 Insights 裡同一個 id 的 region 就是這個 query 從排程到第一次 paint 的時間。
+ * Begin / End / Cancel 只在 game thread 呼叫；Stage scope 可以在任何 thread。
+ */
+class PROMETHEUSVIEWER_API FPrometheusQueryTrace
+{
+public:
+	// 開始追蹤，回傳 correlation id (不會是 0)
+	static uint32 Begin(const FString& PromQL);
+
+	// 資料已畫出: 記錄端到端延遲並結束 region，同一個 id 只算第一次
+	static void End(uint32 CorrelationId);
+
+	// 請求失敗或被取代，不會有畫面
+	static void Cancel(uint32 CorrelationId);
+
+	// 派送期間目前的 id，讓訂閱者不必改 delegate 簽名就能接續追蹤
+	static uint32 GetCurrent() { return CurrentCorrelationId; }
+
+	class FCurrentScope
+	{
+	public:
+		explicit FCurrentScope(uint32 CorrelationId)
+			: Previous(CurrentCorrelationId)
+		{
+			CurrentCorrelationId = CorrelationId;
+		}
+
+		~FCurrentScope()
+		{
+			CurrentCorrelationId = Previous;
+		}
+
+	private:
+		uint32 Previous;
+	};
+
+private:
+	static uint32 CurrentCorrelationId;
+};
+
+// 一個階段的開始與結束，CorrelationId 為 0 時不記錄
+class PROMETHEUSVIEWER_API FPrometheusQueryTraceScope
+{
+public:
+	FPrometheusQueryTraceScope(uint32 InCorrelationId, EPrometheusQueryStage InStage);
+	~FPrometheusQueryTraceScope();
+
+private:
+	uint32 CorrelationId;
+	EPrometheusQueryStage Stage;
+	uint64 StartCycle;
+};
+
+// Timing view 的 CPU scope 加上帶 correlation id 的 stage event
+#define PROMETHEUS_QUERY_TRACE_SCOPE(CorrelationId, StageName) \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR("PrometheusQuery." #StageName, PrometheusViewerChannel); \
+	FPrometheusQueryTraceScope PREPROCESSOR_JOIN(PrometheusQueryTraceScope, __LINE__)(CorrelationId, EPrometheusQueryStage::StageName)
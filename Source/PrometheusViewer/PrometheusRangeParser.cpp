@@ -0,0 +1,723 @@
+#include "PrometheusRangeParser.h"
+#include "Containers/StringConv.h"
+#include <limits>
+
+namespace PrometheusRangeParserPrivate
+{
+	// 1e0 ~ 1e22 都能以 double 精確表示，搭配 53 bit 以內的尾數可得到正確捨入的結果
+	static const double PowersOf10[] =
+	{
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	static const int32 MaxDepth = 64;
+
+	FORCEINLINE bool IsDigit(ANSICHAR C)
+	{
+		return C >= '0' && C <= '9';
+	}
+
+	FORCEINLINE bool KeyEquals(const ANSICHAR* Begin, const ANSICHAR* End, const ANSICHAR* Literal, int32 LiteralLen)
+	{
+		return (End - Begin) == LiteralLen && FMemory::Memcmp(Begin, Literal, LiteralLen) == 0;
+	}
+
+#define PROM_KEY_EQUALS(Begin, End, Literal) KeyEquals(Begin, End, Literal, sizeof(Literal) - 1)
+
+	struct FCursor
+	{
+		const ANSICHAR* Ptr;
+		const ANSICHAR* End;
+
+		FORCEINLINE void SkipWhitespace()
+		{
+			while (Ptr < End && (*Ptr == ' ' || *Ptr == '\n' || *Ptr == '\r' || *Ptr == '\t'))
+			{
+				++Ptr;
+			}
+		}
+
+		FORCEINLINE bool Peek(ANSICHAR C)
+		{
+			SkipWhitespace();
+			return Ptr < End && *Ptr == C;
+		}
+
+		FORCEINLINE bool Consume(ANSICHAR C)
+		{
+			if (Peek(C))
+			{
+				++Ptr;
+				return true;
+			}
+			return false;
+		}
+
+		// 回傳字串內容的原始區段 (不含引號)，有跳脫字元時 bOutEscaped = true
+		bool ReadString(const ANSICHAR*& OutBegin, const ANSICHAR*& OutEnd, bool& bOutEscaped)
+		{
+			if (!Consume('"'))
+			{
+				return false;
+			}
+
+			OutBegin = Ptr;
+			bOutEscaped = false;
+			while (Ptr < End)
+			{
+				const ANSICHAR C = *Ptr;
+				if (C == '"')
+				{
+					OutEnd = Ptr;
+					++Ptr;
+					return true;
+				}
+				if (C == '\\')
+				{
+					if (End - Ptr < 2)
+					{
+						return false;
+					}
+					bOutEscaped = true;
+					Ptr += 2;
+					continue;
+				}
+				++Ptr;
+			}
+			return false;
+		}
+
+		bool ReadNumberToken(const ANSICHAR*& OutBegin, const ANSICHAR*& OutEnd)
+		{
+			SkipWhitespace();
+			OutBegin = Ptr;
+			while (Ptr < End && (IsDigit(*Ptr) || *Ptr == '-' || *Ptr == '+' || *Ptr == '.' || *Ptr == 'e' || *Ptr == 'E'))
+			{
+				++Ptr;
+			}
+			OutEnd = Ptr;
+			return OutEnd > OutBegin;
+		}
+
+		bool SkipValue(int32 Depth)
+		{
+			if (Depth > MaxDepth)
+			{
+				return false;
+			}
+
+			SkipWhitespace();
+			if (Ptr >= End)
+			{
+				return false;
+			}
+
+			const ANSICHAR* Begin;
+			const ANSICHAR* StrEnd;
+			bool bEscaped;
+
+			switch (*Ptr)
+			{
+			case '"':
+				return ReadString(Begin, StrEnd, bEscaped);
+
+			case '{':
+				++Ptr;
+				if (Consume('}'))
+				{
+					return true;
+				}
+				do
+				{
+					if (!ReadString(Begin, StrEnd, bEscaped) || !Consume(':') || !SkipValue(Depth + 1))
+					{
+						return false;
+					}
+				} while (Consume(','));
+				return Consume('}');
+
+			case '[':
+				++Ptr;
+				if (Consume(']'))
+				{
+					return true;
+				}
+				do
+				{
+					if (!SkipValue(Depth + 1))
+					{
+						return false;
+					}
+				} while (Consume(','));
+				return Consume(']');
+
+			default:
+				// number / true / false / null
+				Begin = Ptr;
+				while (Ptr < End && (FCharAnsi::IsAlnum(*Ptr) || *Ptr == '-' || *Ptr == '+' || *Ptr == '.'))
+				{
+					++Ptr;
+				}
+				return Ptr > Begin;
+			}
+		}
+	};
+
+	template <typename AllocatorType>
+	static void AppendUtf8(TArray<ANSICHAR, AllocatorType>& Out, uint32 CodePoint)
+	{
+		if (CodePoint < 0x80)
+		{
+			Out.Add(static_cast<ANSICHAR>(CodePoint));
+		}
+		else if (CodePoint < 0x800)
+		{
+			Out.Add(static_cast<ANSICHAR>(0xC0 | (CodePoint >> 6)));
+			Out.Add(static_cast<ANSICHAR>(0x80 | (CodePoint & 0x3F)));
+		}
+		else if (CodePoint < 0x10000)
+		{
+			Out.Add(static_cast<ANSICHAR>(0xE0 | (CodePoint >> 12)));
+			Out.Add(static_cast<ANSICHAR>(0x80 | ((CodePoint >> 6) & 0x3F)));
+			Out.Add(static_cast<ANSICHAR>(0x80 | (CodePoint & 0x3F)));
+		}
+		else
+		{
+			Out.Add(static_cast<ANSICHAR>(0xF0 | (CodePoint >> 18)));
+			Out.Add(static_cast<ANSICHAR>(0x80 | ((CodePoint >> 12) & 0x3F)));
+			Out.Add(static_cast<ANSICHAR>(0x80 | ((CodePoint >> 6) & 0x3F)));
+			Out.Add(static_cast<ANSICHAR>(0x80 | (CodePoint & 0x3F)));
+		}
+	}
+
+	static bool ReadHex4(const ANSICHAR* P, const ANSICHAR* End, uint32& Out)
+	{
+		if (End - P < 4)
+		{
+			return false;
+		}
+		Out = 0;
+		for (int32 i = 0; i < 4; ++i)
+		{
+			const ANSICHAR C = P[i];
+			uint32 Nibble;
+			if (C >= '0' && C <= '9') Nibble = C - '0';
+			else if (C >= 'a' && C <= 'f') Nibble = C - 'a' + 10;
+			else if (C >= 'A' && C <= 'F') Nibble = C - 'A' + 10;
+			else return false;
+			Out = (Out << 4) | Nibble;
+		}
+		return true;
+	}
+
+	static FString DecodeString(const ANSICHAR* Begin, const ANSICHAR* End, bool bEscaped)
+	{
+		if (!bEscaped)
+		{
+			FUTF8ToTCHAR Converter(Begin, End - Begin);
+			return FString(Converter.Length(), Converter.Get());
+		}
+
+		// label 值含跳脫字元時才需要額外的暫存
+		TArray<ANSICHAR, TInlineAllocator<256>> Unescaped;
+		for (const ANSICHAR* P = Begin; P < End; ++P)
+		{
+			if (*P != '\\' || P + 1 >= End)
+			{
+				Unescaped.Add(*P);
+				continue;
+			}
+
+			++P;
+			switch (*P)
+			{
+			case 'n': Unescaped.Add('\n'); break;
+			case 't': Unescaped.Add('\t'); break;
+			case 'r': Unescaped.Add('\r'); break;
+			case 'b': Unescaped.Add('\b'); break;
+			case 'f': Unescaped.Add('\f'); break;
+			case 'u':
+			{
+				uint32 CodePoint;
+				if (!ReadHex4(P + 1, End, CodePoint))
+				{
+					break;
+				}
+				P += 4;
+
+				// surrogate pair
+				uint32 Low;
+				if (CodePoint >= 0xD800 && CodePoint <= 0xDBFF && End - P > 6 && P[1] == '\\' && P[2] == 'u'
+					&& ReadHex4(P + 3, End, Low) && Low >= 0xDC00 && Low <= 0xDFFF)
+				{
+					CodePoint = 0x10000 + ((CodePoint - 0xD800) << 10) + (Low - 0xDC00);
+					P += 6;
+				}
+				AppendUtf8(Unescaped, CodePoint);
+				break;
+			}
+			default:
+				// \" \\ \/
+				Unescaped.Add(*P);
+				break;
+			}
+		}
+
+		FUTF8ToTCHAR Converter(Unescaped.GetData(), Unescaped.Num());
+		return FString(Converter.Length(), Converter.Get());
+	}
+
+	// [ <unix time>, "<value>" ]
+	static bool ParseSample(FCursor& Cursor, FPrometheusSeries& Series)
+	{
+		const ANSICHAR* Begin;
+		const ANSICHAR* End;
+		bool bEscaped;
+		double Timestamp;
+		double Value;
+
+		if (!Cursor.Consume('[')
+			|| !Cursor.ReadNumberToken(Begin, End)
+			|| !FPrometheusRangeParser::ParseDouble(Begin, End, Timestamp)
+			|| !Cursor.Consume(',')
+			|| !Cursor.ReadString(Begin, End, bEscaped)
+			|| !FPrometheusRangeParser::ParseDouble(Begin, End, Value)
+			|| !Cursor.Consume(']'))
+		{
+			return false;
+		}
+
+		Series.Add(Timestamp, static_cast<float>(Value));
+		return true;
+	}
+
+	// 正規化成 name{a="1",b="2"} 後 intern
+	static bool ParseLabels(FCursor& Cursor, FPrometheusLabelSetHandle& OutLabelSet)
+	{
+		if (!Cursor.Consume('{'))
+		{
+			return false;
+		}
+
+		FString MetricName;
+		TArray<TPair<FString, FString>, TInlineAllocator<8>> Pairs;
+
+		if (!Cursor.Consume('}'))
+		{
+			do
+			{
+				const ANSICHAR* KeyBegin;
+				const ANSICHAR* KeyEnd;
+				const ANSICHAR* ValueBegin;
+				const ANSICHAR* ValueEnd;
+				bool bKeyEscaped;
+				bool bValueEscaped;
+
+				if (!Cursor.ReadString(KeyBegin, KeyEnd, bKeyEscaped)
+					|| !Cursor.Consume(':')
+					|| !Cursor.ReadString(ValueBegin, ValueEnd, bValueEscaped))
+				{
+					return false;
+				}
+
+				if (PROM_KEY_EQUALS(KeyBegin, KeyEnd, "__name__"))
+				{
+					MetricName = DecodeString(ValueBegin, ValueEnd, bValueEscaped);
+				}
+				else
+				{
+					Pairs.Emplace(DecodeString(KeyBegin, KeyEnd, bKeyEscaped), DecodeString(ValueBegin, ValueEnd, bValueEscaped));
+				}
+			} while (Cursor.Consume(','));
+
+			if (!Cursor.Consume('}'))
+			{
+				return false;
+			}
+		}
+
+		Pairs.Sort([](const TPair<FString, FString>& A, const TPair<FString, FString>& B)
+		{
+			return A.Key < B.Key;
+		});
+
+		FString OutLabels = MoveTemp(MetricName);
+		OutLabels += TEXT("{");
+		for (int32 i = 0; i < Pairs.Num(); ++i)
+		{
+			if (i > 0)
+			{
+				OutLabels += TEXT(",");
+			}
+			OutLabels += Pairs[i].Key;
+			OutLabels += TEXT("=\"");
+			OutLabels += Pairs[i].Value.ReplaceCharWithEscapedChar();
+			OutLabels += TEXT("\"");
+		}
+		OutLabels += TEXT("}");
+
+		OutLabelSet = FPrometheusLabelSetTable::Get().Intern(OutLabels);
+		return true;
+	}
+
+	static bool ParseSeries(FCursor& Cursor, int32 ExpectedPoints, FPrometheusSeries& Series)
+	{
+		if (!Cursor.Consume('{'))
+		{
+			return false;
+		}
+		if (Cursor.Consume('}'))
+		{
+			return true;
+		}
+
+		do
+		{
+			const ANSICHAR* KeyBegin;
+			const ANSICHAR* KeyEnd;
+			bool bEscaped;
+			if (!Cursor.ReadString(KeyBegin, KeyEnd, bEscaped) || !Cursor.Consume(':'))
+			{
+				return false;
+			}
+
+			if (PROM_KEY_EQUALS(KeyBegin, KeyEnd, "metric"))
+			{
+				if (!ParseLabels(Cursor, Series.LabelSet))
+				{
+					return false;
+				}
+			}
+			else if (PROM_KEY_EQUALS(KeyBegin, KeyEnd, "values"))
+			{
+				Series.Reserve(Series.Num() + ExpectedPoints);
+
+				if (!Cursor.Consume('['))
+				{
+					return false;
+				}
+				if (!Cursor.Consume(']'))
+				{
+					do
+					{
+						if (!ParseSample(Cursor, Series))
+						{
+							return false;
+						}
+					} while (Cursor.Consume(','));
+
+					if (!Cursor.Consume(']'))
+					{
+						return false;
+					}
+				}
+			}
+			else if (PROM_KEY_EQUALS(KeyBegin, KeyEnd, "value"))
+			{
+				if (!ParseSample(Cursor, Series))
+				{
+					return false;
+				}
+			}
+			else
+			{
+				// histogram / histograms 等目前不支援的欄位直接略過，不影響其他欄位；
+				// 只有內容不是合法的 JSON 時才失敗
+				if (!Cursor.SkipValue(0))
+				{
+					return false;
+				}
+			}
+		} while (Cursor.Consume(','));
+
+		return Cursor.Consume('}');
+	}
+
+	static bool ParseResult(FCursor& Cursor, int32 ExpectedPoints, FPrometheusRangeResult& OutResult)
+	{
+		if (!Cursor.Peek('['))
+		{
+			return false;
+		}
+
+		// scalar / string 結果: "result": [ <time>, "<value>" ]
+		const ANSICHAR* ArrayStart = Cursor.Ptr;
+		++Cursor.Ptr;
+		if (!Cursor.Peek('{') && !Cursor.Peek(']'))
+		{
+			Cursor.Ptr = ArrayStart;
+			return ParseSample(Cursor, OutResult.Series.AddDefaulted_GetRef());
+		}
+
+		if (Cursor.Consume(']'))
+		{
+			return true;
+		}
+
+		do
+		{
+			if (!ParseSeries(Cursor, ExpectedPoints, OutResult.Series.AddDefaulted_GetRef()))
+			{
+				return false;
+			}
+		} while (Cursor.Consume(','));
+
+		return Cursor.Consume(']');
+	}
+
+	static bool ParseData(FCursor& Cursor, int32 ExpectedPoints, FPrometheusRangeResult& OutResult)
+	{
+		if (!Cursor.Consume('{'))
+		{
+			return false;
+		}
+		if (Cursor.Consume('}'))
+		{
+			return true;
+		}
+
+		do
+		{
+			const ANSICHAR* KeyBegin;
+			const ANSICHAR* KeyEnd;
+			bool bEscaped;
+			if (!Cursor.ReadString(KeyBegin, KeyEnd, bEscaped) || !Cursor.Consume(':'))
+			{
+				return false;
+			}
+
+			if (PROM_KEY_EQUALS(KeyBegin, KeyEnd, "result"))
+			{
+				if (!ParseResult(Cursor, ExpectedPoints, OutResult))
+				{
+					return false;
+				}
+			}
+			else if (!Cursor.SkipValue(0))
+			{
+				return false;
+			}
+		} while (Cursor.Consume(','));
+
+		return Cursor.Consume('}');
+	}
+
+#undef PROM_KEY_EQUALS
+}
+
+bool FPrometheusRangeParser::Parse(const uint8* Data, int32 Num, int32 ExpectedPointsPerSeries,
+	FPrometheusRangeResult& OutResult, FString* OutError)
+{
+	using namespace PrometheusRangeParserPrivate;
+
+	FCursor Cursor{ reinterpret_cast<const ANSICHAR*>(Data), reinterpret_cast<const ANSICHAR*>(Data) + Num };
+	ExpectedPointsPerSeries = FMath::Max(ExpectedPointsPerSeries, 1);
+
+	bool bSuccessStatus = true;
+	bool bHasData = false;
+
+	if (!Cursor.Consume('{'))
+	{
+		if (OutError) *OutError = TEXT("response is not a JSON object");
+		return false;
+	}
+
+	if (!Cursor.Consume('}'))
+	{
+		do
+		{
+			const ANSICHAR* KeyBegin;
+			const ANSICHAR* KeyEnd;
+			bool bEscaped;
+			if (!Cursor.ReadString(KeyBegin, KeyEnd, bEscaped) || !Cursor.Consume(':'))
+			{
+				if (OutError) *OutError = TEXT("malformed JSON key");
+				return false;
+			}
+
+			if (KeyEquals(KeyBegin, KeyEnd, "status", 6))
+			{
+				const ANSICHAR* ValueBegin;
+				const ANSICHAR* ValueEnd;
+				if (!Cursor.ReadString(ValueBegin, ValueEnd, bEscaped))
+				{
+					if (OutError) *OutError = TEXT("malformed status");
+					return false;
+				}
+				bSuccessStatus = KeyEquals(ValueBegin, ValueEnd, "success", 7);
+			}
+			else if (KeyEquals(KeyBegin, KeyEnd, "error", 5) && OutError)
+			{
+				const ANSICHAR* ValueBegin;
+				const ANSICHAR* ValueEnd;
+				if (!Cursor.ReadString(ValueBegin, ValueEnd, bEscaped))
+				{
+					return false;
+				}
+				*OutError = DecodeString(ValueBegin, ValueEnd, bEscaped);
+			}
+			else if (KeyEquals(KeyBegin, KeyEnd, "data", 4))
+			{
+				if (!ParseData(Cursor, ExpectedPointsPerSeries, OutResult))
+				{
+					if (OutError) *OutError = TEXT("malformed data section");
+					return false;
+				}
+				bHasData = true;
+			}
+			else if (!Cursor.SkipValue(0))
+			{
+				if (OutError) *OutError = TEXT("malformed JSON value");
+				return false;
+			}
+		} while (Cursor.Consume(','));
+
+		if (!Cursor.Consume('}'))
+		{
+			if (OutError) *OutError = TEXT("unterminated JSON object");
+			return false;
+		}
+	}
+
+	return bSuccessStatus && bHasData;
+}
+
+bool FPrometheusRangeParser::ParseDouble(const ANSICHAR* Begin, const ANSICHAR* End, double& OutValue)
+{
+	using namespace PrometheusRangeParserPrivate;
+
+	const ANSICHAR* P = Begin;
+	if (P >= End)
+	{
+		return false;
+	}
+
+	bool bNegative = false;
+	if (*P == '-' || *P == '+')
+	{
+		bNegative = (*P == '-');
+		++P;
+	}
+
+	// Prometheus 以字串輸出 NaN / +Inf / -Inf
+	if (P < End && !IsDigit(*P) && *P != '.')
+	{
+		const int32 Len = static_cast<int32>(End - P);
+		if (Len == 3 && FCStringAnsi::Strnicmp(P, "NaN", 3) == 0)
+		{
+			OutValue = std::numeric_limits<double>::quiet_NaN();
+			return true;
+		}
+		if ((Len == 3 && FCStringAnsi::Strnicmp(P, "Inf", 3) == 0) || (Len == 8 && FCStringAnsi::Strnicmp(P, "Infinity", 8) == 0))
+		{
+			OutValue = bNegative ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+			return true;
+		}
+		return false;
+	}
+
+	uint64 Mantissa = 0;
+	int32 Digits = 0;
+	int32 Exponent = 0;
+	bool bAnyDigit = false;
+	bool bTruncated = false;
+
+	for (; P < End && IsDigit(*P); ++P)
+	{
+		bAnyDigit = true;
+		if (Digits < 19)
+		{
+			Mantissa = Mantissa * 10 + (*P - '0');
+			if (Mantissa != 0)
+			{
+				++Digits;
+			}
+		}
+		else
+		{
+			++Exponent;
+			bTruncated |= (*P != '0');
+		}
+	}
+
+	if (P < End && *P == '.')
+	{
+		++P;
+		for (; P < End && IsDigit(*P); ++P)
+		{
+			bAnyDigit = true;
+			if (Digits < 19)
+			{
+				Mantissa = Mantissa * 10 + (*P - '0');
+				if (Mantissa != 0)
+				{
+					++Digits;
+				}
+				--Exponent;
+			}
+			else
+			{
+				bTruncated |= (*P != '0');
+			}
+		}
+	}
+
+	if (!bAnyDigit)
+	{
+		return false;
+	}
+
+	if (P < End && (*P == 'e' || *P == 'E'))
+	{
+		++P;
+		bool bExponentNegative = false;
+		if (P < End && (*P == '-' || *P == '+'))
+		{
+			bExponentNegative = (*P == '-');
+			++P;
+		}
+
+		int32 ExponentValue = 0;
+		bool bAnyExponentDigit = false;
+		for (; P < End && IsDigit(*P); ++P)
+		{
+			bAnyExponentDigit = true;
+			if (ExponentValue < 10000)
+			{
+				ExponentValue = ExponentValue * 10 + (*P - '0');
+			}
+		}
+		if (!bAnyExponentDigit)
+		{
+			return false;
+		}
+		Exponent += bExponentNegative ? -ExponentValue : ExponentValue;
+	}
+
+	if (P != End)
+	{
+		return false;
+	}
+
+	// 快速路徑 (Clinger): 尾數可被 double 精確表示且 10 的次方也精確時，一次乘除即為正確捨入
+	if (!bTruncated && Mantissa <= (1ull << 53) && Exponent >= -22 && Exponent <= 22)
+	{
+		double Result = static_cast<double>(Mantissa);
+		Result = Exponent < 0 ? Result / PowersOf10[-Exponent] : Result * PowersOf10[Exponent];
+		OutValue = bNegative ? -Result : Result;
+		return true;
+	}
+
+	// 慢速路徑: 極端指數或超過 19 位有效數字時交給 CRT
+	ANSICHAR Buffer[128];
+	const int32 Len = static_cast<int32>(End - Begin);
+	if (Len >= UE_ARRAY_COUNT(Buffer))
+	{
+		return false;
+	}
+	FMemory::Memcpy(Buffer, Begin, Len);
+	Buffer[Len] = '\0';
+	OutValue = FCStringAnsi::Atod(Buffer);
+	return true;
+}
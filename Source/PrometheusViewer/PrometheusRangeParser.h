@@ -0,0 +1,29 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PrometheusSeries.h"
+
+/**
+ * Prometheus HTTP API 回應的串流式 (SAX) 解析器。
+ * 直接掃描 GetContent() 的 UTF-8 位元組，不建立 FJsonObject DOM，
+ * 每個 sample 直接寫入預先配置的 timestamp / value 陣列，label set 在解析時 intern。
+ */
+class PROMETHEUSVIEWER_API FPrometheusRangeParser
+{
+public:
+	/**
+	 * 解析 matrix (query_range)、vector (query) 或 scalar 結果。
+	 * ExpectedPointsPerSeries 用來預先 Reserve 每個 series 的陣列 (通常是 Range / Step + 1)。
+	 */
+	static bool Parse(const uint8* Data, int32 Num, int32 ExpectedPointsPerSeries,
+		FPrometheusRangeResult& OutResult, FString* OutError = nullptr);
+
+	static bool Parse(const TArray<uint8>& Body, int32 ExpectedPointsPerSeries,
+		FPrometheusRangeResult& OutResult, FString* OutError = nullptr)
+	{
+		return Parse(Body.GetData(), Body.Num(), ExpectedPointsPerSeries, OutResult, OutError);
+	}
+
+	// 快速浮點數解析 (支援 Prometheus 的 NaN / +Inf / -Inf)，整個區段都必須是數字才回傳 true
+	static bool ParseDouble(const ANSICHAR* Begin, const ANSICHAR* End, double& OutValue);
+};
@@ -0,0 +1,137 @@
+#include "PrometheusSeries.h"
+#include "HAL/PlatformTime.h"
+
+int32 FPrometheusRangeResult::GetTotalPoints() const
+{
+	int32 Total = 0;
+	for (const FPrometheusSeries& S : Series)
+	{
+		Total += S.Num();
+	}
+	return Total;
+}
+
+double FPrometheusRangeResult::GetLastTimestamp() const
+{
+	double LastTimestamp = 0.0;
+	for (const FPrometheusSeries& S : Series)
+	{
+		if (S.Num() > 0)
+		{
+			LastTimestamp = FMath::Max(LastTimestamp, S.Timestamps.Last());
+		}
+	}
+	return LastTimestamp;
+}
+
+const FPrometheusSeries* FPrometheusRangeResult::FindSeries(FPrometheusLabelSetHandle LabelSet) const
+{
+	return Series.FindByPredicate([LabelSet](const FPrometheusSeries& S)
+	{
+		return S.LabelSet == LabelSet;
+	});
+}
+
+FPrometheusLabelSetTable& FPrometheusLabelSetTable::Get()
+{
+	static FPrometheusLabelSetTable Instance;
+	return Instance;
+}
+
+FPrometheusLabelSetHandle FPrometheusLabelSetTable::Intern(const FString& InLabels)
+{
+	FPrometheusLabelSetHandle Handle;
+	{
+		FReadScopeLock ReadLock(Lock);
+		if (const int32* Existing = Lookup.Find(InLabels))
+		{
+			const FEntry& Entry = Entries[*Existing];
+			Touch(Entry);
+			Handle.Index = *Existing;
+			Handle.Serial = Entry.Serial;
+			return Handle;
+		}
+	}
+
+	FWriteScopeLock WriteLock(Lock);
+	if (const int32* Existing = Lookup.Find(InLabels))
+	{
+		const FEntry& Entry = Entries[*Existing];
+		Touch(Entry);
+		Handle.Index = *Existing;
+		Handle.Serial = Entry.Serial;
+		return Handle;
+	}
+
+	SweepIfDue();
+
+	Handle.Index = FreeIndices.Num() > 0 ? FreeIndices.Pop(EAllowShrinking::No) : Entries.AddDefaulted();
+	FEntry& Entry = Entries[Handle.Index];
+	Entry.Labels = InLabels;
+	Entry.bInUse = true;
+	Entry.LastUsedSweep = CurrentSweep;
+	Handle.Serial = Entry.Serial;
+
+	Lookup.Add(InLabels, Handle.Index);
+	return Handle;
+}
+
+FString FPrometheusLabelSetTable::Resolve(FPrometheusLabelSetHandle Handle) const
+{
+	FReadScopeLock ReadLock(Lock);
+	if (!Entries.IsValidIndex(Handle.Index))
+	{
+		return FString();
+	}
+
+	const FEntry& Entry = Entries[Handle.Index];
+	if (!Entry.bInUse || Entry.Serial != Handle.Serial)
+	{
+		return FString();
+	}
+	Touch(Entry);
+	return Entry.Labels;
+}
+
+int32 FPrometheusLabelSetTable::Num() const
+{
+	FReadScopeLock ReadLock(Lock);
+	return Entries.Num() - FreeIndices.Num();
+}
+
+void FPrometheusLabelSetTable::Touch(const FEntry& Entry) const
+{
+	// 多個 reader 可能同時寫入，值都是目前的週期
+	FPlatformAtomics::AtomicStore_Relaxed(&Entry.LastUsedSweep, CurrentSweep);
+}
+
+void FPrometheusLabelSetTable::SweepIfDue()
+{
+	const double Now = FPlatformTime::Seconds();
+	if (LastSweepTime == 0.0)
+	{
+		LastSweepTime = Now;
+		return;
+	}
+	if (Now - LastSweepTime < SweepIntervalSeconds)
+	{
+		return;
+	}
+	LastSweepTime = Now;
+	++CurrentSweep;
+
+	for (int32 Index = 0; Index < Entries.Num(); ++Index)
+	{
+		FEntry& Entry = Entries[Index];
+		if (!Entry.bInUse || CurrentSweep - Entry.LastUsedSweep <= RetentionSweeps)
+		{
+			continue;
+		}
+
+		Lookup.Remove(Entry.Labels);
+		Entry.Labels.Empty();
+		Entry.bInUse = false;
+		++Entry.Serial;
+		FreeIndices.Add(Index);
+	}
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/ScopeRWLock.h"
+#include "PrometheusSeries.generated.h"
+
+// 指向 FPrometheusLabelSetTable 中的 label set 字串
+USTRUCT(BlueprintType)
+struct FPrometheusLabelSetHandle
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Prometheus")
+	int32 Index = INDEX_NONE;
+
+	// 位置被回收再使用時遞增，舊的 handle 不會等於新的 label set
+	UPROPERTY(BlueprintReadOnly, Category = "Prometheus")
+	int32 Serial = 0;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+
+	bool operator==(const FPrometheusLabelSetHandle& Other) const { return Index == Other.Index && Serial == Other.Serial; }
+	bool operator!=(const FPrometheusLabelSetHandle& Other) const { return !(*this == Other); }
+
+	friend uint32 GetTypeHash(const FPrometheusLabelSetHandle& Handle) { return ::GetTypeHash(Handle.Index); }
+};
+
+// 單一 series: label set + 連續的 timestamp / value 欄位 (每個 sample 12 bytes，FVector2D 是 16 bytes)
+USTRUCT(BlueprintType)
+struct FPrometheusSeries
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Prometheus")
+	FPrometheusLabelSetHandle LabelSet;
+
+	// Unix 秒
+	UPROPERTY(BlueprintReadOnly, Category = "Prometheus")
+	TArray<double> Timestamps;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Prometheus")
+	TArray<float> Values;
+
+	int32 Num() const { return Timestamps.Num(); }
+
+	void Reserve(int32 Count)
+	{
+		Timestamps.Reserve(Count);
+		Values.Reserve(Count);
+	}
+
+	void Add(double Timestamp, float Value)
+	{
+		Timestamps.Add(Timestamp);
+		Values.Add(Value);
+	}
+};
+
+// query / query_range 的結果，每個 series 各自保留
+USTRUCT(BlueprintType)
+struct FPrometheusRangeResult
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Prometheus")
+	TArray<FPrometheusSeries> Series;
+
+	int32 GetTotalPoints() const;
+
+	// 所有 series 中最後一個 timestamp，沒有資料時為 0
+	double GetLastTimestamp() const;
+
+	const FPrometheusSeries* FindSeries(FPrometheusLabelSetHandle LabelSet) const;
+};
+
+/**
+ * label set 字串的 intern 表。相同的 label set 在整個程式中只存一份，
+ * series 只帶一個 int 的 handle。可在任意執行緒呼叫。
+ * Intern / Resolve 會標記 label set 仍在使用；series 換掉 (例如 pod 重建) 之後，
+ * 超過 RetentionSweeps 次回收週期沒有再出現的 label set 會被回收，位置給新的 label set 使用。
+ */
+class PROMETHEUSVIEWER_API FPrometheusLabelSetTable
+{
+public:
+	// 回收週期 (秒)，只在有新的 label set 加入時檢查
+	static constexpr double SweepIntervalSeconds = 60.0;
+
+	// 連續這麼多個週期沒有使用就回收，需比圖表的時間範圍長
+	static constexpr int32 RetentionSweeps = 10;
+
+	static FPrometheusLabelSetTable& Get();
+
+	FPrometheusLabelSetHandle Intern(const FString& Labels);
+
+	// 已被回收的 handle 回傳空字串
+	FString Resolve(FPrometheusLabelSetHandle Handle) const;
+
+	// 目前保留中的 label set 數
+	int32 Num() const;
+
+private:
+	struct FEntry
+	{
+		FString Labels;
+		int32 Serial = 0;
+		bool bInUse = false;
+
+		// 最後一次使用時的週期，讀取時在 read lock 下以 atomic 更新
+		mutable int32 LastUsedSweep = 0;
+	};
+
+	void Touch(const FEntry& Entry) const;
+
+	// 需持有 write lock
+	void SweepIfDue();
+
+	mutable FRWLock Lock;
+	TMap<FString, int32> Lookup;
+	TArray<FEntry> Entries;
+	TArray<int32> FreeIndices;
+	int32 CurrentSweep = 0;
+	double LastSweepTime = 0.0;
+};
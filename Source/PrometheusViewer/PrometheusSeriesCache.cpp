@@ -0,0 +1,550 @@
+#include "PrometheusSeriesCache.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Hash/CityHash.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace PrometheusSeriesCachePrivate
+{
+	/**
+	 * 檔案格式 (little endian):
+	 *   Header : uint32 Magic, uint32 Version, uint32 KeyLen, Key (UTF-8)
+	 *   Record : uint8 Type 後接內容
+	 *     Label   : uint32 Id, uint32 Len, Labels (UTF-8)
+	 *     Samples : uint32 Id, uint32 Count, double[Count] Timestamps, float[Count] Values
+	 */
+	static const uint32 Magic = 0x31435350; // "PSC1"
+	static const uint32 Version = 1;
+
+	enum class ERecordType : uint8
+	{
+		Label = 1,
+		Samples = 2,
+	};
+
+	static const TCHAR* FileExtension = TEXT(".pcache");
+
+	template <typename T>
+	static void Write(TArray<uint8>& Out, const T& Value)
+	{
+		Out.Append(reinterpret_cast<const uint8*>(&Value), sizeof(T));
+	}
+
+	static void WriteString(TArray<uint8>& Out, const FString& Value)
+	{
+		FTCHARToUTF8 Utf8(*Value);
+		Write<uint32>(Out, Utf8.Length());
+		Out.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+	}
+
+	static void WriteHeader(TArray<uint8>& Out, const FString& Key)
+	{
+		Write<uint32>(Out, Magic);
+		Write<uint32>(Out, Version);
+		WriteString(Out, Key);
+	}
+
+	static void WriteLabelRecord(TArray<uint8>& Out, uint32 Id, const FString& Labels)
+	{
+		Write<uint8>(Out, static_cast<uint8>(ERecordType::Label));
+		Write<uint32>(Out, Id);
+		WriteString(Out, Labels);
+	}
+
+	// 只寫入 MinTimestamp 之後的 sample，全部過期時不寫
+	static void WriteSamplesRecord(TArray<uint8>& Out, uint32 Id, const FPrometheusSeries& Series, double MinTimestamp)
+	{
+		int32 First = 0;
+		while (First < Series.Num() && Series.Timestamps[First] < MinTimestamp)
+		{
+			++First;
+		}
+		const int32 Count = Series.Num() - First;
+		if (Count <= 0)
+		{
+			return;
+		}
+
+		Write<uint8>(Out, static_cast<uint8>(ERecordType::Samples));
+		Write<uint32>(Out, Id);
+		Write<uint32>(Out, Count);
+		Out.Append(reinterpret_cast<const uint8*>(Series.Timestamps.GetData() + First), Count * sizeof(double));
+		Out.Append(reinterpret_cast<const uint8*>(Series.Values.GetData() + First), Count * sizeof(float));
+	}
+
+	struct FReader
+	{
+		const uint8* Ptr;
+		const uint8* End;
+
+		template <typename T>
+		bool Read(T& OutValue)
+		{
+			if (End - Ptr < static_cast<int64>(sizeof(T)))
+			{
+				return false;
+			}
+			FMemory::Memcpy(&OutValue, Ptr, sizeof(T));
+			Ptr += sizeof(T);
+			return true;
+		}
+
+		bool ReadString(FString& OutValue)
+		{
+			uint32 Len = 0;
+			if (!Read(Len) || End - Ptr < static_cast<int64>(Len))
+			{
+				return false;
+			}
+			FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Ptr), Len);
+			OutValue = FString(Converted.Length(), Converted.Get());
+			Ptr += Len;
+			return true;
+		}
+	};
+
+	// 把 Source 中比目前最後一點新的 sample 接到 Target
+	static void MergeSeries(FPrometheusSeries& Target, const FPrometheusSeries& Source)
+	{
+		for (int32 i = 0; i < Source.Num(); ++i)
+		{
+			if (Target.Num() == 0 || Source.Timestamps[i] > Target.Timestamps.Last())
+			{
+				Target.Add(Source.Timestamps[i], Source.Values[i]);
+			}
+		}
+	}
+
+	// 依 label set 把 Source 的每個 series 接到 Target 對應的 series，沒有的新增
+	static void MergeResult(FPrometheusRangeResult& Target, const FPrometheusRangeResult& Source)
+	{
+		for (const FPrometheusSeries& Series : Source.Series)
+		{
+			FPrometheusSeries* Existing = Target.Series.FindByPredicate([&Series](const FPrometheusSeries& S) { return S.LabelSet == Series.LabelSet; });
+			if (!Existing)
+			{
+				Existing = &Target.Series.AddDefaulted_GetRef();
+				Existing->LabelSet = Series.LabelSet;
+			}
+			MergeSeries(*Existing, Series);
+		}
+	}
+}
+
+FPrometheusSeriesCache::FPrometheusSeriesCache(const FString& InDirectory, int64 InMaxFileBytes, int64 InMaxTotalBytes)
+	: Directory(InDirectory)
+	, MaxFileBytes(InMaxFileBytes)
+	, MaxTotalBytes(InMaxTotalBytes)
+{
+	IFileManager::Get().MakeDirectory(*Directory, true);
+
+	PendingIo = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this]()
+	{
+		EnforceTotalSize(FString());
+	});
+}
+
+FPrometheusSeriesCache::~FPrometheusSeriesCache()
+{
+	Flush();
+}
+
+void FPrometheusSeriesCache::Flush()
+{
+	if (PendingIo.IsValid())
+	{
+		PendingIo.Wait();
+	}
+}
+
+FString FPrometheusSeriesCache::NormalizeQuery(const FString& PromQL)
+{
+	FString Result;
+	Result.Reserve(PromQL.Len());
+
+	TCHAR Quote = 0;
+	bool bPendingSpace = false;
+	for (const TCHAR Ch : PromQL)
+	{
+		if (Quote)
+		{
+			Result.AppendChar(Ch);
+			if (Ch == Quote)
+			{
+				Quote = 0;
+			}
+			continue;
+		}
+
+		if (FChar::IsWhitespace(Ch))
+		{
+			bPendingSpace = Result.Len() > 0;
+			continue;
+		}
+		if (bPendingSpace)
+		{
+			Result.AppendChar(TEXT(' '));
+			bPendingSpace = false;
+		}
+		if (Ch == TEXT('"') || Ch == TEXT('\'') || Ch == TEXT('`'))
+		{
+			Quote = Ch;
+		}
+		Result.AppendChar(Ch);
+	}
+	return Result;
+}
+
+FString FPrometheusSeriesCache::MakeKey(const FString& Target, const FString& PromQL, float StepSeconds)
+{
+	return FString::Printf(TEXT("%s|%s|%g"), *Target, *NormalizeQuery(PromQL), StepSeconds);
+}
+
+FString FPrometheusSeriesCache::GetFilePath(const FString& Key) const
+{
+	FTCHARToUTF8 Utf8(*Key);
+	const uint64 Hash = CityHash64(Utf8.Get(), Utf8.Length());
+	return Directory / FString::Printf(TEXT("%016llx%s"), Hash, PrometheusSeriesCachePrivate::FileExtension);
+}
+
+void FPrometheusSeriesCache::LoadAsync(const FString& Key, double MinTimestamp, TUniqueFunction<void(FPrometheusRangeResult&& Result)> OnLoaded)
+{
+	// 排在之前的寫入之後，不會讀到寫一半的檔案；memory-map 與解析都不在 game thread
+	EnqueueIo([Path = GetFilePath(Key), Key, MinTimestamp, OnLoaded = MoveTemp(OnLoaded)]()
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(PrometheusSeriesCache_Load);
+
+		FPrometheusRangeResult Result;
+		if (!ReadFile(Path, Key, MinTimestamp, Result, nullptr))
+		{
+			Result.Series.Reset();
+		}
+		OnLoaded(MoveTemp(Result));
+	});
+}
+
+void FPrometheusSeriesCache::EnqueueIo(TUniqueFunction<void()> Io)
+{
+	PendingIo = PendingIo.IsValid()
+		? UE::Tasks::Launch(UE_SOURCE_LOCATION, MoveTemp(Io), UE::Tasks::Prerequisites(PendingIo))
+		: UE::Tasks::Launch(UE_SOURCE_LOCATION, MoveTemp(Io));
+}
+
+void FPrometheusSeriesCache::Store(const FString& Key, const FPrometheusRangeResult& Result, bool bReplace, double MinTimestamp)
+{
+	if (!bReplace && Result.GetTotalPoints() == 0)
+	{
+		return;
+	}
+
+	// 寫入依序串接在同一條 task 鏈上，FileStates 同一時間只有一個 task 存取
+	EnqueueIo([this, Key, Result, bReplace, MinTimestamp]()
+	{
+		TRACE_CPUPROFILER_EVENT_SCOPE(PrometheusSeriesCache_Store);
+
+		if (bReplace)
+		{
+			WriteReplace(Key, Result, MinTimestamp);
+		}
+		else
+		{
+			WriteAppend(Key, Result, MinTimestamp);
+		}
+	});
+}
+
+void FPrometheusSeriesCache::WriteReplace(const FString& Key, const FPrometheusRangeResult& Result, double MinTimestamp)
+{
+	using namespace PrometheusSeriesCachePrivate;
+
+	FFileState& State = FileStates.FindOrAdd(Key);
+	State.LabelIds.Reset();
+
+	TArray<uint8> Bytes;
+	WriteHeader(Bytes, Key);
+	for (const FPrometheusSeries& Series : Result.Series)
+	{
+		const FString Labels = FPrometheusLabelSetTable::Get().Resolve(Series.LabelSet);
+		const uint32 Id = State.LabelIds.Num();
+		State.LabelIds.Add(Labels, Id);
+
+		WriteLabelRecord(Bytes, Id, Labels);
+		WriteSamplesRecord(Bytes, Id, Series, MinTimestamp);
+	}
+
+	// 先寫到暫存檔再搬過去，中途失敗不會留下壞掉的快取
+	const FString Path = GetFilePath(Key);
+	const FString TempPath = Path + TEXT(".tmp");
+	if (!FFileHelper::SaveArrayToFile(Bytes, *TempPath) || !IFileManager::Get().Move(*Path, *TempPath, true))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[SeriesCache] Failed to write %s"), *Path);
+		FileStates.Remove(Key);
+		return;
+	}
+	State.Size = Bytes.Num();
+
+	EnforceTotalSize(Path);
+}
+
+void FPrometheusSeriesCache::WriteAppend(const FString& Key, const FPrometheusRangeResult& Result, double MinTimestamp)
+{
+	using namespace PrometheusSeriesCachePrivate;
+
+	const FString Path = GetFilePath(Key);
+	FFileState* State = FileStates.Find(Key);
+	if (!State)
+	{
+		// 這次執行還沒寫過這個檔案: 從現有檔案重建 label id
+		FFileState NewState;
+		FPrometheusRangeResult Existing;
+		int64 ValidBytes = 0;
+		if (!ReadFile(Path, Key, TNumericLimits<double>::Lowest(), Existing, &NewState.LabelIds, &ValidBytes))
+		{
+			WriteReplace(Key, Result, MinTimestamp);
+			return;
+		}
+		NewState.Size = IFileManager::Get().FileSize(*Path);
+		if (ValidBytes < NewState.Size)
+		{
+			// 上次在附加途中中斷，尾端留下寫到一半的紀錄: 之後附加的資料都會讀不到，改成重寫整個檔案
+			UE_LOG(LogTemp, Log, TEXT("[SeriesCache] Rewriting %s: torn record at %lld of %lld bytes"), *Path, ValidBytes, NewState.Size);
+			MergeResult(Existing, Result);
+			WriteReplace(Key, Existing, MinTimestamp);
+			return;
+		}
+		State = &FileStates.Add(Key, MoveTemp(NewState));
+	}
+
+	TArray<uint8> Bytes;
+	for (const FPrometheusSeries& Series : Result.Series)
+	{
+		const FString Labels = FPrometheusLabelSetTable::Get().Resolve(Series.LabelSet);
+		uint32 Id;
+		if (const uint32* Existing = State->LabelIds.Find(Labels))
+		{
+			Id = *Existing;
+		}
+		else
+		{
+			Id = State->LabelIds.Num();
+			State->LabelIds.Add(Labels, Id);
+			WriteLabelRecord(Bytes, Id, Labels);
+		}
+		WriteSamplesRecord(Bytes, Id, Series, MinTimestamp);
+	}
+
+	if (State->Size + Bytes.Num() > MaxFileBytes)
+	{
+		// 超過單檔上限: 只保留視窗內的 sample 重寫
+		FPrometheusRangeResult Merged;
+		ReadFile(Path, Key, MinTimestamp, Merged, nullptr);
+		MergeResult(Merged, Result);
+		WriteReplace(Key, Merged, MinTimestamp);
+		return;
+	}
+
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*Path, FILEWRITE_Append));
+	if (!Writer)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[SeriesCache] Failed to append %s"), *Path);
+		FileStates.Remove(Key);
+		return;
+	}
+	Writer->Serialize(Bytes.GetData(), Bytes.Num());
+	if (!Writer->Close())
+	{
+		// 可能只寫入一部分，下次附加時重新讀檔檢查尾端
+		UE_LOG(LogTemp, Warning, TEXT("[SeriesCache] Failed to append %s"), *Path);
+		FileStates.Remove(Key);
+		return;
+	}
+	State->Size += Bytes.Num();
+
+	// 長時間只做增量附加也要維持目錄上限，超過時才重新掃描目錄
+	TotalBytes += Bytes.Num();
+	if (TotalBytes > MaxTotalBytes)
+	{
+		EnforceTotalSize(Path);
+	}
+}
+
+void FPrometheusSeriesCache::EnforceTotalSize(const FString& KeepPath)
+{
+	struct FCacheFile
+	{
+		FString Path;
+		int64 Size;
+		FDateTime Timestamp;
+	};
+
+	TArray<FCacheFile> Files;
+	TotalBytes = 0;
+	IFileManager::Get().IterateDirectoryStat(*Directory, [this, &Files](const TCHAR* Path, const FFileStatData& Stat)
+	{
+		if (!Stat.bIsDirectory && FStringView(Path).EndsWith(PrometheusSeriesCachePrivate::FileExtension))
+		{
+			Files.Add({ Path, Stat.FileSize, Stat.ModificationTime });
+			TotalBytes += Stat.FileSize;
+		}
+		return true;
+	});
+
+	if (TotalBytes <= MaxTotalBytes)
+	{
+		return;
+	}
+
+	// 最久沒有更新的先刪
+	// 檔名是 key 的 hash，比對檔名就不受路徑寫法影響
+	Files.Sort([](const FCacheFile& A, const FCacheFile& B) { return A.Timestamp < B.Timestamp; });
+	const FString KeepName = FPaths::GetCleanFilename(KeepPath);
+	for (const FCacheFile& File : Files)
+	{
+		if (TotalBytes <= MaxTotalBytes)
+		{
+			break;
+		}
+		const FString FileName = FPaths::GetCleanFilename(File.Path);
+		if (FileName == KeepName)
+		{
+			continue;
+		}
+		if (IFileManager::Get().Delete(*File.Path))
+		{
+			TotalBytes -= File.Size;
+
+			// 刪掉的檔案下次要從頭寫 (含 header)，不能沿用記錄的 label id 繼續附加
+			for (auto It = FileStates.CreateIterator(); It; ++It)
+			{
+				if (FPaths::GetCleanFilename(GetFilePath(It.Key())) == FileName)
+				{
+					It.RemoveCurrent();
+				}
+			}
+		}
+	}
+}
+
+bool FPrometheusSeriesCache::ReadFile(const FString& Path, const FString& Key, double MinTimestamp, FPrometheusRangeResult& OutResult, TMap<FString, uint32>* OutLabelIds, int64* OutValidBytes)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (!PlatformFile.FileExists(*Path))
+	{
+		return false;
+	}
+
+	// Region 必須比 Handle 先釋放
+	TUniquePtr<IMappedFileHandle> MappedFile(PlatformFile.OpenMapped(*Path));
+	if (MappedFile && MappedFile->GetFileSize() > 0)
+	{
+		TUniquePtr<IMappedFileRegion> Region(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+		if (Region)
+		{
+			return ParseFile(Region->GetMappedPtr(), Region->GetMappedSize(), Key, MinTimestamp, OutResult, OutLabelIds, OutValidBytes);
+		}
+	}
+
+	// 平台不支援 memory-map 時退回一般讀檔
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Path))
+	{
+		return false;
+	}
+	return ParseFile(Bytes.GetData(), Bytes.Num(), Key, MinTimestamp, OutResult, OutLabelIds, OutValidBytes);
+}
+
+bool FPrometheusSeriesCache::ParseFile(const uint8* Data, int64 Num, const FString& Key, double MinTimestamp, FPrometheusRangeResult& OutResult, TMap<FString, uint32>* OutLabelIds, int64* OutValidBytes)
+{
+	using namespace PrometheusSeriesCachePrivate;
+
+	FReader Reader{ Data, Data + Num };
+
+	uint32 FileMagic = 0;
+	uint32 FileVersion = 0;
+	FString FileKey;
+	if (!Reader.Read(FileMagic) || FileMagic != Magic || !Reader.Read(FileVersion) || FileVersion != Version
+		|| !Reader.ReadString(FileKey) || FileKey != Key)
+	{
+		// 格式不符或 hash 碰撞，當作沒有快取
+		return false;
+	}
+
+	TMap<uint32, int32> SeriesById;
+	const uint8* ValidEnd = Reader.Ptr;
+	while (Reader.Ptr < Reader.End)
+	{
+		uint8 Type = 0;
+		uint32 Id = 0;
+		if (!Reader.Read(Type) || !Reader.Read(Id))
+		{
+			break;
+		}
+
+		if (Type == static_cast<uint8>(ERecordType::Label))
+		{
+			FString Labels;
+			if (!Reader.ReadString(Labels))
+			{
+				break;
+			}
+			if (OutLabelIds)
+			{
+				OutLabelIds->Add(Labels, Id);
+			}
+
+			FPrometheusSeries& Series = OutResult.Series.AddDefaulted_GetRef();
+			Series.LabelSet = FPrometheusLabelSetTable::Get().Intern(Labels);
+			SeriesById.Add(Id, OutResult.Series.Num() - 1);
+			ValidEnd = Reader.Ptr;
+		}
+		else if (Type == static_cast<uint8>(ERecordType::Samples))
+		{
+			uint32 Count = 0;
+			if (!Reader.Read(Count) || Reader.End - Reader.Ptr < static_cast<int64>(Count) * (sizeof(double) + sizeof(float)))
+			{
+				// 最後一筆寫到一半 (例如程式中斷)，前面的資料仍可使用
+				break;
+			}
+
+			const uint8* TimestampData = Reader.Ptr;
+			const uint8* ValueData = Reader.Ptr + Count * sizeof(double);
+			Reader.Ptr += Count * (sizeof(double) + sizeof(float));
+			ValidEnd = Reader.Ptr;
+
+			const int32* SeriesIndex = SeriesById.Find(Id);
+			if (!SeriesIndex)
+			{
+				continue;
+			}
+
+			FPrometheusSeries& Series = OutResult.Series[*SeriesIndex];
+			Series.Reserve(Series.Num() + Count);
+			for (uint32 i = 0; i < Count; ++i)
+			{
+				double Timestamp;
+				float Value;
+				FMemory::Memcpy(&Timestamp, TimestampData + i * sizeof(double), sizeof(double));
+				FMemory::Memcpy(&Value, ValueData + i * sizeof(float), sizeof(float));
+
+				if (Timestamp >= MinTimestamp && (Series.Num() == 0 || Timestamp > Series.Timestamps.Last()))
+				{
+					Series.Add(Timestamp, Value);
+				}
+			}
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	if (OutValidBytes)
+	{
+		*OutValidBytes = ValidEnd - Data;
+	}
+
+	OutResult.Series.RemoveAll([](const FPrometheusSeries& Series) { return Series.Num() == 0; });
+	return true;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PrometheusSeries.h"
+#include "Tasks/Task.h"
+
+/**
+ * 本機的 series 快取，重新啟動時先畫出上次的資料，只補抓之後缺少的部分。
+ * 每個 key (target + 正規化 PromQL + step) 一個 append-only 二進位檔，讀取時 memory-map。
+ * 寫入在背景 task 依序執行；檔案超過上限時只保留視窗內的 sample 重寫，目錄超過上限時刪掉最舊的檔案。
+ */
+class PROMETHEUSVIEWER_API FPrometheusSeriesCache
+{
+public:
+	explicit FPrometheusSeriesCache(const FString& InDirectory, int64 InMaxFileBytes = 4 * 1024 * 1024, int64 InMaxTotalBytes = 64 * 1024 * 1024);
+	~FPrometheusSeriesCache();
+
+	static FString MakeKey(const FString& Target, const FString& PromQL, float StepSeconds);
+
+	// 空白正規化 (引號內不變)，寫法不同但相同的 PromQL 共用同一個檔案
+	static FString NormalizeQuery(const FString& PromQL);
+
+	// 在背景讀出 MinTimestamp 之後的 sample，排在先前的寫入之後；OnLoaded 在 worker 上呼叫，沒有可用的快取時結果為空
+	void LoadAsync(const FString& Key, double MinTimestamp, TUniqueFunction<void(FPrometheusRangeResult&& Result)> OnLoaded);
+
+	// bReplace 為 true 時取代整個檔案 (完整範圍查詢)，否則附加在後面 (增量查詢)
+	void Store(const FString& Key, const FPrometheusRangeResult& Result, bool bReplace, double MinTimestamp);
+
+	// 等待所有背景讀寫完成
+	void Flush();
+
+private:
+	// 每個檔案已寫入的 label set 與大小，只在背景 task 上存取
+	struct FFileState
+	{
+		TMap<FString, uint32> LabelIds;
+		int64 Size = 0;
+	};
+
+	FString GetFilePath(const FString& Key) const;
+
+	void WriteReplace(const FString& Key, const FPrometheusRangeResult& Result, double MinTimestamp);
+	void WriteAppend(const FString& Key, const FPrometheusRangeResult& Result, double MinTimestamp);
+	// 目錄超過 MaxTotalBytes 時刪掉最舊的檔案 (KeepPath 除外)，並重新計算 TotalBytes
+	void EnforceTotalSize(const FString& KeepPath);
+
+	// 讀寫都串接在 PendingIo 上，依序執行
+	void EnqueueIo(TUniqueFunction<void()> Io);
+
+	// OutValidBytes 是最後一筆完整紀錄結束的位置，小於檔案大小表示尾端有寫到一半的紀錄
+	static bool ReadFile(const FString& Path, const FString& Key, double MinTimestamp, FPrometheusRangeResult& OutResult, TMap<FString, uint32>* OutLabelIds, int64* OutValidBytes = nullptr);
+	static bool ParseFile(const uint8* Data, int64 Num, const FString& Key, double MinTimestamp, FPrometheusRangeResult& OutResult, TMap<FString, uint32>* OutLabelIds, int64* OutValidBytes = nullptr);
+
+	FString Directory;
+	int64 MaxFileBytes;
+	int64 MaxTotalBytes;
+
+	TMap<FString, FFileState> FileStates;
+
+	// 上次掃描目錄時的總大小加上之後附加的 bytes，只在背景 task 上存取
+	int64 TotalBytes = 0;
+	UE::Tasks::FTask PendingIo;
+};
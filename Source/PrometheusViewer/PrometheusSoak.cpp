@@ -0,0 +1,567 @@
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "HAL/PlatformMemory.h"
+#include "Containers/Ticker.h"
+#include "Async/Async.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+#include "Dom/JsonObject.h"
+#include "Dom/JsonValue.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "Components/Button.h"
+#include "Components/EditableTextBox.h"
+#include "Components/ListView.h"
+#include "PrometheusManager.h"
+#include "LoginWidget.h"
+#include "DashboardWidget.h"
+#include "MonitoringItemWidget.h"
+#include "MonitoringItemData.h"
+#include "PrometheusMockServer.h"
+
+#if !UE_BUILD_SHIPPING
+
+namespace PrometheusSoak
+{
+	struct FSoakConfig
+	{
+		int32 NumItems = 200;
+		float DurationSeconds = 300.0f;
+
+		// 縮短 scrape/query 間隔，用較短的時間跑完較多輪 refresh
+		float IntervalSeconds = 1.0f;
+		int32 NumSeries = 4;
+		uint32 Port = 19091;
+
+		// 每秒改變選擇或移除/重新加入 item 的次數，0 表示不做；每次都用新的 PromQL，確認依 query 的狀態會被清掉
+		float ChurnPerSecond = 2.0f;
+
+		// NOC 牆面: 所有 item 都當作可見；OnlyVisible 時捲出列表的 item 也暫停更新
+		bool bAllVisible = true;
+		bool bExitWhenDone = false;
+	};
+
+	static FSoakConfig ParseSoakConfig(const TArray<FString>& Args)
+	{
+		FSoakConfig Config;
+		const FString Cmd = FString::Join(Args, TEXT(" "));
+		FParse::Value(*Cmd, TEXT("Items="), Config.NumItems);
+		FParse::Value(*Cmd, TEXT("Seconds="), Config.DurationSeconds);
+		FParse::Value(*Cmd, TEXT("Interval="), Config.IntervalSeconds);
+		FParse::Value(*Cmd, TEXT("Series="), Config.NumSeries);
+		FParse::Value(*Cmd, TEXT("Port="), Config.Port);
+		FParse::Value(*Cmd, TEXT("Churn="), Config.ChurnPerSecond);
+		Config.NumItems = FMath::Max(Config.NumItems, 1);
+		Config.DurationSeconds = FMath::Max(Config.DurationSeconds, 1.0f);
+		Config.IntervalSeconds = FMath::Max(Config.IntervalSeconds, 0.25f);
+		Config.NumSeries = FMath::Max(Config.NumSeries, 1);
+		Config.ChurnPerSecond = FMath::Max(Config.ChurnPerSecond, 0.0f);
+		Config.bAllVisible = !Args.Contains(TEXT("OnlyVisible"));
+		Config.bExitWhenDone = Args.Contains(TEXT("Exit")) || FParse::Param(FCommandLine::Get(), TEXT("SoakExit"));
+		return Config;
+	}
+
+	// 每秒一次的快照
+	struct FSoakSnapshot
+	{
+		double Time = 0.0;
+		uint64 UsedPhysical = 0;
+		TArray<TPair<FString, int32>> Counts;
+	};
+
+	static TSharedRef<FJsonObject> MakePercentileJson(TArray<double> SamplesMs)
+	{
+		SamplesMs.Sort();
+		auto Percentile = [&SamplesMs](double Fraction)
+		{
+			return SamplesMs[FMath::Clamp(FMath::CeilToInt(Fraction * SamplesMs.Num()) - 1, 0, SamplesMs.Num() - 1)];
+		};
+
+		TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+		Json->SetNumberField(TEXT("count"), SamplesMs.Num());
+		if (SamplesMs.Num() > 0)
+		{
+			Json->SetNumberField(TEXT("p50_ms"), Percentile(0.5));
+			Json->SetNumberField(TEXT("p90_ms"), Percentile(0.9));
+			Json->SetNumberField(TEXT("p99_ms"), Percentile(0.99));
+			Json->SetNumberField(TEXT("max_ms"), SamplesMs.Last());
+		}
+		return Json;
+	}
+
+	static double ToMegabytes(uint64 Bytes)
+	{
+		return Bytes / (1024.0 * 1024.0);
+	}
+
+	/**
+	 * 以本機假 Prometheus 跑完整的 dashboard: ULoginWidget 登入 -> UDashboardWidget 新增 NumItems 個 item
+	 * -> 自動 refresh DurationSeconds 秒，期間持續改變 item 的選擇、移除並重新加入 item。
+	 * 記錄 frame time、每次 refresh 的 game thread 時間、記憶體、HTTP 請求率與綁定數量；
+	 * 暖機之後容器或綁定數量仍持續成長時判定失敗。
+	 */
+	class FSoakRun : public TSharedFromThis<FSoakRun>
+	{
+	public:
+		static constexpr double SnapshotIntervalSeconds = 1.0;
+		static constexpr float WarmupFraction = 0.2f;
+
+		FSoakRun(UWorld* InWorld, const FSoakConfig& InConfig)
+			: World(InWorld)
+			, Config(InConfig)
+		{
+		}
+
+		void Start()
+		{
+			UWorld* InWorld = World.Get();
+			for (TActorIterator<APrometheusManager> It(InWorld); It; ++It)
+			{
+				Manager = *It;
+				break;
+			}
+			if (!Manager.IsValid())
+			{
+				Finish(TEXT("no APrometheusManager in the world"));
+				return;
+			}
+
+			FPrometheusMockServer::FOptions Options;
+			Options.Port = Config.Port;
+			Options.NumSeries = Config.NumSeries;
+			Options.NumMetricNames = Config.NumItems;
+			Options.bDynamicRanges = true;
+			if (!Server.Start(Options))
+			{
+				Finish(TEXT("mock server failed to start"));
+				return;
+			}
+
+			ApplyManagerConfig();
+
+			const double SetupStart = FPlatformTime::Seconds();
+			if (!Login() || !AddItems())
+			{
+				return;
+			}
+			SetupSeconds = FPlatformTime::Seconds() - SetupStart;
+
+			UE_LOG(LogTemp, Display, TEXT("[Soak] %d items added in %.1f ms, running for %.0f s (interval %.2f s)"),
+				Config.NumItems, SetupSeconds * 1000.0, Config.DurationSeconds, Config.IntervalSeconds);
+
+			StartSentRequests = Manager->SentHttpRequests;
+			StartGameThreadSeconds = Manager->GameThreadQuerySeconds;
+			StartRefreshes = Manager->NumAutoQueryRefreshes;
+			StartServed = Server.GetNumServed();
+			StartServeSeconds = Server.GetServeSeconds();
+
+			RunStartTime = FPlatformTime::Seconds();
+			TickHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &FSoakRun::Tick));
+		}
+
+	private:
+		void ApplyManagerConfig()
+		{
+			SavedQueryInterval = Manager->QueryInterval;
+			SavedScrapeInterval = Manager->ScrapeIntervalSeconds;
+			SavedRangeStep = Manager->RangeStepSeconds;
+			SavedVisibilityTimeout = Manager->VisibilityTimeoutSeconds;
+			bManagerConfigApplied = true;
+
+			Manager->TargetPort = Server.GetPort();
+			Manager->QueryInterval = Config.IntervalSeconds;
+			Manager->ScrapeIntervalSeconds = Config.IntervalSeconds;
+			Manager->RangeStepSeconds = Config.IntervalSeconds;
+			if (Config.bAllVisible)
+			{
+				Manager->VisibilityTimeoutSeconds = Config.DurationSeconds * 2.0f + 60.0f;
+			}
+		}
+
+		void RestoreManagerConfig()
+		{
+			if (!bManagerConfigApplied || !Manager.IsValid())
+			{
+				return;
+			}
+			Manager->QueryInterval = SavedQueryInterval;
+			Manager->ScrapeIntervalSeconds = SavedScrapeInterval;
+			Manager->RangeStepSeconds = SavedRangeStep;
+			Manager->VisibilityTimeoutSeconds = SavedVisibilityTimeout;
+			if (Dashboard.IsValid())
+			{
+				Dashboard->bRefreshOffscreenItems = bSavedRefreshOffscreenItems;
+			}
+		}
+
+		// 和使用者一樣從登入畫面按下登入，已經在 dashboard 時略過
+		bool Login()
+		{
+			if (ULoginWidget* LoginWidget = Cast<ULoginWidget>(Manager->CurrentWidget))
+			{
+				LoginWidget->IPBox->SetText(FText::FromString(TEXT("127.0.0.1")));
+				LoginWidget->UserBox->SetText(FText::FromString(TEXT("soak")));
+				LoginWidget->PassBox->SetText(FText::FromString(TEXT("soak")));
+				LoginWidget->LoginButton->OnClicked.Broadcast();
+			}
+
+			Dashboard = Cast<UDashboardWidget>(Manager->CurrentWidget);
+			if (!Dashboard.IsValid())
+			{
+				Finish(TEXT("login did not open the dashboard"));
+				return false;
+			}
+
+			bSavedRefreshOffscreenItems = Dashboard->bRefreshOffscreenItems;
+			Dashboard->bRefreshOffscreenItems = Config.bAllVisible;
+			return true;
+		}
+
+		bool AddItems()
+		{
+			for (int32 i = 0; i < Config.NumItems; ++i)
+			{
+				// 每個 item 一個不同的 query，避免 broker 合併請求讓負載變小
+				const FString Metric = FString::Printf(TEXT("mock_metric_%04d"), i);
+				Manager->PromQLMappings.FindOrAdd(Metric).Add(TEXT("Raw"), FString::Printf(TEXT("rate(%s[1m])"), *Metric));
+
+				const int32 NumExisting = Dashboard->GetItems().Num();
+				Dashboard->OnAddMonitorClicked();
+				if (Dashboard->GetItems().Num() != NumExisting + 1)
+				{
+					Finish(TEXT("OnAddMonitorClicked did not add an item (is the MonitorListView entry widget class set?)"));
+					return false;
+				}
+
+				// 大部分 item 不在畫面上，沒有 widget，直接在資料上選擇
+				Dashboard->GetItems().Last()->Select(Metric, TEXT("Raw"));
+			}
+			return true;
+		}
+
+		// 每個 mapping 都是新的 PromQL (mock server 不看 query 內容，series 與 label set 不變)
+		void AddChurnMapping(const FString& Metric)
+		{
+			const FString PromQL = FString::Printf(TEXT("rate(%s[1m]) * %d"), *Metric, ++NumChurnQueries);
+			Manager->PromQLMappings.FindOrAdd(Metric).Add(TEXT("Churn"), PromQL);
+		}
+
+		// 輪流: 改變一個 item 的選擇 / 移除最舊的 item 再加入一個新的
+		void Churn()
+		{
+			const TArray<TObjectPtr<UMonitoringItemData>>& Items = Dashboard->GetItems();
+			if (Items.Num() == 0)
+			{
+				return;
+			}
+
+			const int32 Step = NumChurnSteps++;
+			if (Step % 2 == 0)
+			{
+				UMonitoringItemData* Item = Items[(Step / 2) % Items.Num()];
+				const FString Metric = Item->GetSelectedMetric();
+				AddChurnMapping(Metric);
+				Item->Select(Metric, TEXT("Churn"));
+				return;
+			}
+
+			UMonitoringItemData* Oldest = Items[0];
+			const FString Metric = Oldest->GetSelectedMetric();
+			Dashboard->RemoveItem(Oldest);
+
+			const int32 NumRemaining = Items.Num();
+			Dashboard->OnAddMonitorClicked();
+			if (Items.Num() > NumRemaining)
+			{
+				AddChurnMapping(Metric);
+				Items.Last()->Select(Metric, TEXT("Churn"));
+			}
+		}
+
+		FSoakSnapshot TakeSnapshot(double Elapsed) const
+		{
+			FSoakSnapshot Snapshot;
+			Snapshot.Time = Elapsed;
+			Snapshot.UsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+			Manager->GetDiagnosticCounts(Snapshot.Counts);
+
+			int32 NumItems = 0;
+			int32 NumEntryWidgets = 0;
+			int32 NumItemBindings = 0;
+			if (Dashboard.IsValid())
+			{
+				NumItems = Dashboard->GetItems().Num();
+
+				// 列表回收 widget，數量只跟畫面大小有關
+				for (UUserWidget* Entry : Dashboard->MonitorListView->GetDisplayedEntryWidgets())
+				{
+					if (UMonitoringItemWidget* Item = Cast<UMonitoringItemWidget>(Entry))
+					{
+						++NumEntryWidgets;
+						NumItemBindings += Item->OnPromQueryGenerated.GetAllObjects().Num();
+						if (Item->LineChartResult)
+						{
+							NumItemBindings += Item->LineChartResult->OnTileRequested.GetAllObjects().Num();
+						}
+					}
+				}
+			}
+			Snapshot.Counts.Emplace(TEXT("DashboardItems"), NumItems);
+			Snapshot.Counts.Emplace(TEXT("DashboardEntryWidgets"), NumEntryWidgets);
+			Snapshot.Counts.Emplace(TEXT("ItemBindings"), NumItemBindings);
+			return Snapshot;
+		}
+
+		bool Tick(float DeltaTime)
+		{
+			if (!Manager.IsValid() || !Dashboard.IsValid())
+			{
+				Finish(TEXT("manager or dashboard was destroyed"));
+				return false;
+			}
+
+			const double Elapsed = FPlatformTime::Seconds() - RunStartTime;
+
+			// 第一個 frame 包含新增 item 的時間，不算
+			if (bFirstTick)
+			{
+				bFirstTick = false;
+			}
+			else
+			{
+				FrameMs.Add(DeltaTime * 1000.0);
+			}
+
+			ChurnBudget += DeltaTime * Config.ChurnPerSecond;
+			while (ChurnBudget >= 1.0)
+			{
+				ChurnBudget -= 1.0;
+				Churn();
+			}
+
+			if (Snapshots.Num() == 0 || Elapsed - Snapshots.Last().Time >= SnapshotIntervalSeconds)
+			{
+				Snapshots.Add(TakeSnapshot(Elapsed));
+			}
+
+			if (Elapsed >= Config.DurationSeconds)
+			{
+				Finish();
+				return false;
+			}
+			return true;
+		}
+
+		// 暖機後前半段與最後四分之一的最大值比較，容許少量波動 (進行中的請求數等)
+		void CheckGrowth(TSharedRef<FJsonObject>& CountsJson, TArray<FString>& OutFailures) const
+		{
+			if (Snapshots.Num() < 8)
+			{
+				OutFailures.Add(TEXT("run too short for a growth check"));
+				return;
+			}
+
+			const double Duration = Snapshots.Last().Time;
+			for (int32 CounterIndex = 0; CounterIndex < Snapshots[0].Counts.Num(); ++CounterIndex)
+			{
+				const FString& Name = Snapshots[0].Counts[CounterIndex].Key;
+				int32 EarlyMax = 0;
+				int32 LateMax = 0;
+				for (const FSoakSnapshot& Snapshot : Snapshots)
+				{
+					const int32 Value = Snapshot.Counts[CounterIndex].Value;
+					if (Snapshot.Time >= Duration * WarmupFraction && Snapshot.Time <= Duration * 0.5)
+					{
+						EarlyMax = FMath::Max(EarlyMax, Value);
+					}
+					else if (Snapshot.Time >= Duration * 0.75)
+					{
+						LateMax = FMath::Max(LateMax, Value);
+					}
+				}
+
+				TSharedRef<FJsonObject> CounterJson = MakeShared<FJsonObject>();
+				CounterJson->SetNumberField(TEXT("start"), Snapshots[0].Counts[CounterIndex].Value);
+				CounterJson->SetNumberField(TEXT("end"), Snapshots.Last().Counts[CounterIndex].Value);
+				CounterJson->SetNumberField(TEXT("early_max"), EarlyMax);
+				CounterJson->SetNumberField(TEXT("late_max"), LateMax);
+				CountsJson->SetObjectField(Name, CounterJson);
+
+				if (LateMax > EarlyMax + FMath::Max(2, EarlyMax / 10))
+				{
+					OutFailures.Add(FString::Printf(TEXT("%s grew from %d to %d"), *Name, EarlyMax, LateMax));
+				}
+			}
+		}
+
+		void Finish(const FString& Error = FString());
+
+		TWeakObjectPtr<UWorld> World;
+		FSoakConfig Config;
+		FPrometheusMockServer Server;
+
+		TWeakObjectPtr<APrometheusManager> Manager;
+		TWeakObjectPtr<UDashboardWidget> Dashboard;
+
+		bool bManagerConfigApplied = false;
+		float SavedQueryInterval = 0.0f;
+		float SavedScrapeInterval = 0.0f;
+		float SavedRangeStep = 0.0f;
+		float SavedVisibilityTimeout = 0.0f;
+		bool bSavedRefreshOffscreenItems = true;
+
+		double ChurnBudget = 0.0;
+		int32 NumChurnSteps = 0;
+		int32 NumChurnQueries = 0;
+
+		double SetupSeconds = 0.0;
+		double RunStartTime = 0.0;
+		bool bFirstTick = true;
+		FTSTicker::FDelegateHandle TickHandle;
+
+		int64 StartSentRequests = 0;
+		double StartGameThreadSeconds = 0.0;
+		int32 StartRefreshes = 0;
+		int64 StartServed = 0;
+		double StartServeSeconds = 0.0;
+
+		TArray<double> FrameMs;
+		TArray<FSoakSnapshot> Snapshots;
+	};
+
+	// 同一時間只跑一組
+	static TSharedPtr<FSoakRun> GActiveRun;
+
+	void FSoakRun::Finish(const FString& Error)
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(TickHandle);
+
+		TSharedRef<FJsonObject> Results = MakeShared<FJsonObject>();
+		TArray<FString> Failures;
+		if (!Error.IsEmpty())
+		{
+			Failures.Add(Error);
+		}
+
+		TSharedRef<FJsonObject> ConfigJson = MakeShared<FJsonObject>();
+		ConfigJson->SetNumberField(TEXT("items"), Config.NumItems);
+		ConfigJson->SetNumberField(TEXT("seconds"), Config.DurationSeconds);
+		ConfigJson->SetNumberField(TEXT("interval"), Config.IntervalSeconds);
+		ConfigJson->SetNumberField(TEXT("series_per_query"), Config.NumSeries);
+		ConfigJson->SetBoolField(TEXT("all_visible"), Config.bAllVisible);
+		ConfigJson->SetNumberField(TEXT("churn_per_second"), Config.ChurnPerSecond);
+		Results->SetNumberField(TEXT("version"), 1);
+		Results->SetStringField(TEXT("timestamp"), FDateTime::UtcNow().ToIso8601());
+		Results->SetStringField(TEXT("build"), LexToString(FApp::GetBuildConfiguration()));
+		Results->SetObjectField(TEXT("config"), ConfigJson);
+
+		if (Manager.IsValid() && Snapshots.Num() > 0)
+		{
+			const double Duration = FMath::Max(FPlatformTime::Seconds() - RunStartTime, 1e-3);
+			const int32 NumRefreshes = Manager->NumAutoQueryRefreshes - StartRefreshes;
+			const int64 NumRequests = Manager->SentHttpRequests - StartSentRequests;
+
+			Results->SetNumberField(TEXT("setup_ms"), SetupSeconds * 1000.0);
+			Results->SetNumberField(TEXT("duration_s"), Duration);
+			Results->SetNumberField(TEXT("churn_steps"), NumChurnSteps);
+			Results->SetObjectField(TEXT("frame"), MakePercentileJson(FrameMs));
+
+			TSharedRef<FJsonObject> RefreshJson = MakeShared<FJsonObject>();
+			RefreshJson->SetNumberField(TEXT("count"), NumRefreshes);
+			RefreshJson->SetNumberField(TEXT("game_thread_ms_per_refresh"),
+				(Manager->GameThreadQuerySeconds - StartGameThreadSeconds) * 1000.0 / FMath::Max(NumRefreshes, 1));
+			Results->SetObjectField(TEXT("refresh"), RefreshJson);
+
+			TSharedRef<FJsonObject> HttpJson = MakeShared<FJsonObject>();
+			HttpJson->SetNumberField(TEXT("requests"), NumRequests);
+			HttpJson->SetNumberField(TEXT("requests_per_sec"), NumRequests / Duration);
+			HttpJson->SetNumberField(TEXT("mock_served"), Server.GetNumServed() - StartServed);
+			// 假 server 也跑在 game thread，這段時間包含在 frame time 裡
+			HttpJson->SetNumberField(TEXT("mock_game_thread_ms"), (Server.GetServeSeconds() - StartServeSeconds) * 1000.0);
+			Results->SetObjectField(TEXT("http"), HttpJson);
+
+			// 圖表歷史在 HistorySeconds 內本來就會成長，記憶體只回報不判定
+			TSharedRef<FJsonObject> MemoryJson = MakeShared<FJsonObject>();
+			MemoryJson->SetNumberField(TEXT("start_mb"), ToMegabytes(Snapshots[0].UsedPhysical));
+			MemoryJson->SetNumberField(TEXT("end_mb"), ToMegabytes(Snapshots.Last().UsedPhysical));
+			MemoryJson->SetNumberField(TEXT("peak_mb"), ToMegabytes(FPlatformMemory::GetStats().PeakUsedPhysical));
+			Results->SetObjectField(TEXT("memory"), MemoryJson);
+
+			TSharedRef<FJsonObject> CountsJson = MakeShared<FJsonObject>();
+			if (Error.IsEmpty())
+			{
+				CheckGrowth(CountsJson, Failures);
+			}
+			Results->SetObjectField(TEXT("counts"), CountsJson);
+		}
+
+		RestoreManagerConfig();
+		Server.Stop();
+
+		TArray<TSharedPtr<FJsonValue>> FailureValues;
+		for (const FString& Failure : Failures)
+		{
+			FailureValues.Add(MakeShared<FJsonValueString>(Failure));
+		}
+		Results->SetStringField(TEXT("status"), Failures.Num() == 0 ? TEXT("ok") : TEXT("failed"));
+		Results->SetArrayField(TEXT("failures"), FailureValues);
+
+		FString Json;
+		const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+		FJsonSerializer::Serialize(Results, Writer);
+
+		const FString Path = FPaths::ProjectSavedDir() / TEXT("Benchmarks") /
+			FString::Printf(TEXT("PrometheusSoak-%s.json"), *FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S")));
+		if (FFileHelper::SaveStringToFile(Json, *Path, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+		{
+			UE_LOG(LogTemp, Display, TEXT("[Soak] Results written to %s"), *FPaths::ConvertRelativePathToFull(Path));
+		}
+		for (const FString& Failure : Failures)
+		{
+			UE_LOG(LogTemp, Error, TEXT("[Soak] FAILED: %s"), *Failure);
+		}
+		UE_LOG(LogTemp, Display, TEXT("[Soak] %s"), *Json);
+
+		if (Config.bExitWhenDone)
+		{
+			FPlatformMisc::RequestExitWithStatus(false, Failures.Num() == 0 ? 0 : 1);
+		}
+
+		// 可能還在自己的 ticker 裡，下一個 tick 再釋放
+		AsyncTask(ENamedThreads::GameThread, []()
+		{
+			GActiveRun.Reset();
+		});
+	}
+
+	static void RunSoak(const TArray<FString>& Args, UWorld* World)
+	{
+		if (GActiveRun.IsValid())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[Soak] A soak run is already in progress"));
+			return;
+		}
+		if (!World)
+		{
+			UE_LOG(LogTemp, Error, TEXT("[Soak] Prometheus.Soak.Run needs a world"));
+			return;
+		}
+
+		GActiveRun = MakeShared<FSoakRun>(World, ParseSoakConfig(Args));
+		GActiveRun->Start();
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GPrometheusSoakRunCommand(
+	TEXT("Prometheus.Soak.Run"),
+	TEXT("Log in to a local mock Prometheus, add monitoring items and run the auto refresh loop, then write JSON to Saved/Benchmarks. ")
+	TEXT("Usage: Prometheus.Soak.Run [Items=200] [Seconds=300] [Interval=1] [Series=4] [Port=19091] [Churn=2] [OnlyVisible] [Exit]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&PrometheusSoak::RunSoak));
+
+#endif
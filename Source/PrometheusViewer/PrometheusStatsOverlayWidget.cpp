@@ -0,0 +1,155 @@
+#include "PrometheusStatsOverlayWidget.h"
+#include "PrometheusViewerStats.h"
+#include "Rendering/DrawElements.h"
+#include "Styling/CoreStyle.h"
+#include "HAL/IConsoleManager.h"
+#include "Engine/World.h"
+
+void UPrometheusStatsOverlayWidget::NativeConstruct()
+{
+    Super::NativeConstruct();
+
+    // 只顯示，不擋滑鼠
+    SetVisibility(ESlateVisibility::HitTestInvisible);
+
+    LastSnapshot = TakeSnapshot();
+    UpdateLines(LastSnapshot);
+}
+
+void UPrometheusStatsOverlayWidget::NativeTick(const FGeometry& MyGeometry, float InDeltaTime)
+{
+    Super::NativeTick(MyGeometry, InDeltaTime);
+
+    const FSnapshot Current = TakeSnapshot();
+    if (Current.Time - LastSnapshot.Time < RefreshSeconds)
+    {
+        return;
+    }
+
+    UpdateLines(Current);
+    LastSnapshot = Current;
+}
+
+UPrometheusStatsOverlayWidget::FSnapshot UPrometheusStatsOverlayWidget::TakeSnapshot()
+{
+    const FPrometheusViewerStats& Stats = FPrometheusViewerStats::Get();
+
+    FSnapshot Snapshot;
+    Snapshot.Time = FPlatformTime::Seconds();
+    Snapshot.Requests = Stats.GetRequestsCompleted();
+    Snapshot.RequestSeconds = Stats.RequestLatency.GetSumSeconds();
+    Snapshot.ReceivedBytes = Stats.GetReceivedBytes();
+    Snapshot.Parses = Stats.ParseTime.GetCount();
+    Snapshot.ParseSeconds = Stats.ParseTime.GetSumSeconds();
+    Snapshot.Dispatches = Stats.DispatchTime.GetCount();
+    Snapshot.DispatchSeconds = Stats.DispatchTime.GetSumSeconds();
+    Snapshot.Paints = Stats.ChartPaintTime.GetCount();
+    Snapshot.PaintSeconds = Stats.ChartPaintTime.GetSumSeconds();
+    Snapshot.EndToEnds = Stats.EndToEndLatency.GetCount();
+    Snapshot.EndToEndSeconds = Stats.EndToEndLatency.GetSumSeconds();
+    return Snapshot;
+}
+
+void UPrometheusStatsOverlayWidget::UpdateLines(const FSnapshot& Current)
+{
+    const FPrometheusViewerStats& Stats = FPrometheusViewerStats::Get();
+
+    const double Elapsed = FMath::Max(Current.Time - LastSnapshot.Time, KINDA_SMALL_NUMBER);
+    const int64 Requests = Current.Requests - LastSnapshot.Requests;
+    const uint64 Parses = Current.Parses - LastSnapshot.Parses;
+    const uint64 Dispatches = Current.Dispatches - LastSnapshot.Dispatches;
+    const uint64 Paints = Current.Paints - LastSnapshot.Paints;
+    const uint64 EndToEnds = Current.EndToEnds - LastSnapshot.EndToEnds;
+
+    // 這段時間內的平均 (ms)，沒有樣本時為 0
+    auto AverageMs = [](double Seconds, uint64 Count)
+    {
+        return Count > 0 ? Seconds * 1000.0 / Count : 0.0;
+    };
+
+    Lines.Reset();
+    Lines.Add(FString::Printf(TEXT("Requests: %.1f/s  (in flight %d, queued %d)"),
+        Requests / Elapsed, Stats.GetInFlightRequests(), Stats.GetQueuedRequests()));
+    Lines.Add(FString::Printf(TEXT("Latency:  %.1f ms avg"),
+        AverageMs(Current.RequestSeconds - LastSnapshot.RequestSeconds, Requests)));
+    Lines.Add(FString::Printf(TEXT("Received: %.1f KB/s"),
+        (Current.ReceivedBytes - LastSnapshot.ReceivedBytes) / 1024.0 / Elapsed));
+    Lines.Add(FString::Printf(TEXT("Parse:    %.2f ms avg"),
+        AverageMs(Current.ParseSeconds - LastSnapshot.ParseSeconds, Parses)));
+    Lines.Add(FString::Printf(TEXT("Dispatch: %.2f ms avg"),
+        AverageMs(Current.DispatchSeconds - LastSnapshot.DispatchSeconds, Dispatches)));
+    Lines.Add(FString::Printf(TEXT("Paint:    %.3f ms/chart  (%.0f paints/s)"),
+        AverageMs(Current.PaintSeconds - LastSnapshot.PaintSeconds, Paints), Paints / Elapsed));
+    Lines.Add(FString::Printf(TEXT("End2End:  %.1f ms avg (schedule to paint)"),
+        AverageMs(Current.EndToEndSeconds - LastSnapshot.EndToEndSeconds, EndToEnds)));
+    Lines.Add(FString::Printf(TEXT("Points:   %lld"), Stats.GetChartPoints()));
+
+    const uint32 MetricsPort = Stats.GetMetricsPort();
+    Lines.Add(MetricsPort > 0 ? FString::Printf(TEXT("/metrics on :%u"), MetricsPort) : FString(TEXT("/metrics off")));
+}
+
+int32 UPrometheusStatsOverlayWidget::NativePaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry,
+    const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements,
+    int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+{
+    Super::NativePaint(Args, AllottedGeometry, MyCullingRect, OutDrawElements,
+        LayerId, InWidgetStyle, bParentEnabled);
+
+    FSlateFontInfo FontInfo = FCoreStyle::Get().GetFontStyle("NormalFont");
+    FontInfo.Size = 10;
+
+    const float LineHeight = 15.0f;
+    const FVector2D Origin(12.0f, 12.0f);
+    const FVector2D BoxSize(330.0f, Lines.Num() * LineHeight + 12.0f);
+
+    // 半透明底色
+    FSlateDrawElement::MakeBox(OutDrawElements, LayerId,
+        AllottedGeometry.ToPaintGeometry(Origin, BoxSize),
+        FCoreStyle::Get().GetBrush("WhiteBrush"),
+        ESlateDrawEffect::None,
+        FLinearColor(0.0f, 0.0f, 0.0f, 0.6f));
+
+    for (int32 i = 0; i < Lines.Num(); ++i)
+    {
+        const FVector2D TextPos = Origin + FVector2D(6.0f, 6.0f + i * LineHeight);
+        FSlateDrawElement::MakeText(OutDrawElements, LayerId + 1,
+            AllottedGeometry.ToPaintGeometry(TextPos, FVector2D(BoxSize.X - 12.0f, LineHeight)),
+            Lines[i], FontInfo, ESlateDrawEffect::None, FLinearColor::Green);
+    }
+
+    return LayerId + 2;
+}
+
+namespace PrometheusStatsOverlay
+{
+    static TWeakObjectPtr<UPrometheusStatsOverlayWidget> GOverlay;
+
+    static void Toggle(const TArray<FString>& Args, UWorld* World)
+    {
+        if (UPrometheusStatsOverlayWidget* Overlay = GOverlay.Get())
+        {
+            Overlay->RemoveFromParent();
+            GOverlay.Reset();
+            return;
+        }
+
+        if (!World || !World->IsGameWorld())
+        {
+            UE_LOG(LogTemp, Error, TEXT("[PrometheusViewerStats] Prometheus.StatsOverlay needs a game world"));
+            return;
+        }
+
+        UPrometheusStatsOverlayWidget* Overlay = CreateWidget<UPrometheusStatsOverlayWidget>(World, UPrometheusStatsOverlayWidget::StaticClass());
+        if (Overlay)
+        {
+            // 放在 dashboard 之上
+            Overlay->AddToViewport(1000);
+            GOverlay = Overlay;
+        }
+    }
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GPrometheusStatsOverlayCommand(
+    TEXT("Prometheus.StatsOverlay"),
+    TEXT("Toggle the viewer performance overlay (request rate, latency, parse/dispatch/paint cost, end-to-end latency, points held)."),
+    FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&PrometheusStatsOverlay::Toggle));
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "PrometheusStatsOverlayWidget.generated.h"
+
+/**
+ * 畫在畫面左上角的 viewer 效能摘要 (Prometheus.StatsOverlay 切換)。
+ * 不需要 Blueprint: 每 RefreshSeconds 從 FPrometheusViewerStats 取一次快照，
+ * 用前後兩次的差算出速率與平均，NativePaint 只畫文字。
+ */
+UCLASS()
+class PROMETHEUSVIEWER_API UPrometheusStatsOverlayWidget : public UUserWidget
+{
+    GENERATED_BODY()
+
+public:
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stats", meta = (ClampMin = "0.1"))
+    float RefreshSeconds = 0.5f;
+
+protected:
+    virtual void NativeConstruct() override;
+    virtual void NativeTick(const FGeometry& MyGeometry, float InDeltaTime) override;
+    virtual int32 NativePaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry,
+        const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements,
+        int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+
+private:
+    // 累計值的快照，兩次快照相減得到這段時間的量
+    struct FSnapshot
+    {
+        double Time = 0.0;
+        int64 Requests = 0;
+        double RequestSeconds = 0.0;
+        int64 ReceivedBytes = 0;
+        uint64 Parses = 0;
+        double ParseSeconds = 0.0;
+        uint64 Dispatches = 0;
+        double DispatchSeconds = 0.0;
+        uint64 Paints = 0;
+        double PaintSeconds = 0.0;
+        uint64 EndToEnds = 0;
+        double EndToEndSeconds = 0.0;
+    };
+
+    static FSnapshot TakeSnapshot();
+    void UpdateLines(const FSnapshot& Current);
+
+    FSnapshot LastSnapshot;
+    TArray<FString> Lines;
+};
@@ -10,7 +10,8 @@ public class PrometheusViewer : ModuleRules
 	
 		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "EnhancedInput", "HTTP", "Json", "JsonUtilities", "UMG" ,"Slate", "SlateCore"});
 
-		PrivateDependencyModuleNames.AddRange(new string[] {  });
+		// HTTPServer: /metrics 與 Prometheus.Bench.* 用的本機假 Prometheus
+		PrivateDependencyModuleNames.AddRange(new string[] { "HTTPServer" });
 
 		// Uncomment if you are using Slate UI
 		// PrivateDependencyModuleNames.AddRange(new string[] { "Slate", "SlateCore" });
@@ -0,0 +1,175 @@
+#include "PrometheusViewerStats.h"
+#include "HttpServerModule.h"
+#include "IHttpRouter.h"
+#include "HttpServerRequest.h"
+#include "HttpServerResponse.h"
+#include "Containers/StringConv.h"
+
+DEFINE_STAT(STAT_PrometheusViewer_ParseRange);
+DEFINE_STAT(STAT_PrometheusViewer_ParseInstant);
+DEFINE_STAT(STAT_PrometheusViewer_Dispatch);
+DEFINE_STAT(STAT_PrometheusViewer_Schedule);
+DEFINE_STAT(STAT_PrometheusViewer_ChartPaint);
+DEFINE_STAT(STAT_PrometheusViewer_RequestsCompleted);
+DEFINE_STAT(STAT_PrometheusViewer_BytesReceived);
+DEFINE_STAT(STAT_PrometheusViewer_RequestLatency);
+DEFINE_STAT(STAT_PrometheusViewer_EndToEndLatency);
+DEFINE_STAT(STAT_PrometheusViewer_InFlightRequests);
+DEFINE_STAT(STAT_PrometheusViewer_QueuedRequests);
+DEFINE_STAT(STAT_PrometheusViewer_ChartPoints);
+
+const double FPrometheusViewerHistogram::Bounds[NumBounds] = {
+	0.0001, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 10.0 };
+
+void FPrometheusViewerHistogram::Observe(double Seconds)
+{
+	int32 Index = 0;
+	while (Index < NumBounds && Seconds > Bounds[Index])
+	{
+		++Index;
+	}
+	BucketCounts[Index].fetch_add(1, std::memory_order_relaxed);
+	Count.fetch_add(1, std::memory_order_relaxed);
+	SumMicroseconds.fetch_add(static_cast<uint64>(FMath::Max(Seconds, 0.0) * 1e6), std::memory_order_relaxed);
+}
+
+namespace PrometheusViewerStats
+{
+	static void AppendMetric(FString& Out, const TCHAR* Name, const TCHAR* Type, const TCHAR* Help, double Value)
+	{
+		Out += FString::Printf(TEXT("# HELP %s %s\n# TYPE %s %s\n%s %.17g\n"), Name, Help, Name, Type, Name, Value);
+	}
+
+	static void AppendHistogram(FString& Out, const TCHAR* Name, const TCHAR* Help, const FPrometheusViewerHistogram& Histogram)
+	{
+		Out += FString::Printf(TEXT("# HELP %s %s\n# TYPE %s histogram\n"), Name, Help, Name);
+
+		// bucket 在 exposition format 裡是累計的
+		uint64 Cumulative = 0;
+		for (int32 i = 0; i < FPrometheusViewerHistogram::NumBounds; ++i)
+		{
+			Cumulative += Histogram.GetBucketCount(i);
+			Out += FString::Printf(TEXT("%s_bucket{le=\"%g\"} %llu\n"), Name, FPrometheusViewerHistogram::Bounds[i], Cumulative);
+		}
+		Cumulative += Histogram.GetBucketCount(FPrometheusViewerHistogram::NumBounds);
+		Out += FString::Printf(TEXT("%s_bucket{le=\"+Inf\"} %llu\n"), Name, Cumulative);
+		Out += FString::Printf(TEXT("%s_sum %.17g\n%s_count %llu\n"), Name, Histogram.GetSumSeconds(), Name, Cumulative);
+	}
+}
+
+FPrometheusViewerStats& FPrometheusViewerStats::Get()
+{
+	static FPrometheusViewerStats Instance;
+	return Instance;
+}
+
+void FPrometheusViewerStats::RecordRequestCompleted(double LatencySeconds)
+{
+	RequestsCompleted.fetch_add(1, std::memory_order_relaxed);
+	RequestLatency.Observe(LatencySeconds);
+
+	INC_DWORD_STAT(STAT_PrometheusViewer_RequestsCompleted);
+	SET_FLOAT_STAT(STAT_PrometheusViewer_RequestLatency, LatencySeconds * 1000.0);
+}
+
+void FPrometheusViewerStats::RecordBytesReceived(int64 CompressedBytes, int64 UncompressedBytes)
+{
+	ReceivedBytes.fetch_add(CompressedBytes, std::memory_order_relaxed);
+	ReceivedUncompressedBytes.fetch_add(UncompressedBytes, std::memory_order_relaxed);
+
+	INC_DWORD_STAT_BY(STAT_PrometheusViewer_BytesReceived, CompressedBytes);
+}
+
+void FPrometheusViewerStats::SetRequestGauges(int32 InFlight, int32 Queued)
+{
+	InFlightRequests.store(InFlight, std::memory_order_relaxed);
+	QueuedRequests.store(Queued, std::memory_order_relaxed);
+
+	SET_DWORD_STAT(STAT_PrometheusViewer_InFlightRequests, InFlight);
+	SET_DWORD_STAT(STAT_PrometheusViewer_QueuedRequests, Queued);
+}
+
+void FPrometheusViewerStats::AddChartPoints(int64 Delta)
+{
+	const int64 Points = ChartPoints.fetch_add(Delta, std::memory_order_relaxed) + Delta;
+
+	SET_DWORD_STAT(STAT_PrometheusViewer_ChartPoints, Points);
+}
+
+void FPrometheusViewerStats::RecordEndToEndLatency(double Seconds)
+{
+	EndToEndLatency.Observe(Seconds);
+
+	SET_FLOAT_STAT(STAT_PrometheusViewer_EndToEndLatency, Seconds * 1000.0);
+}
+
+FString FPrometheusViewerStats::ExportText() const
+{
+	using namespace PrometheusViewerStats;
+
+	FString Out;
+	AppendMetric(Out, TEXT("prometheus_viewer_http_requests_total"), TEXT("counter"),
+		TEXT("HTTP requests to Prometheus that completed."), GetRequestsCompleted());
+	AppendMetric(Out, TEXT("prometheus_viewer_received_bytes_total"), TEXT("counter"),
+		TEXT("Response bytes received from Prometheus as transferred."), GetReceivedBytes());
+	AppendMetric(Out, TEXT("prometheus_viewer_received_uncompressed_bytes_total"), TEXT("counter"),
+		TEXT("Response bytes received from Prometheus after decompression."), GetReceivedUncompressedBytes());
+	AppendMetric(Out, TEXT("prometheus_viewer_inflight_requests"), TEXT("gauge"),
+		TEXT("HTTP requests currently in flight."), GetInFlightRequests());
+	AppendMetric(Out, TEXT("prometheus_viewer_queued_requests"), TEXT("gauge"),
+		TEXT("HTTP requests waiting for a free slot."), GetQueuedRequests());
+	AppendMetric(Out, TEXT("prometheus_viewer_chart_points"), TEXT("gauge"),
+		TEXT("Samples held by all charts, live buffers plus compressed history."), GetChartPoints());
+	AppendHistogram(Out, TEXT("prometheus_viewer_request_duration_seconds"),
+		TEXT("Time from sending a request to its response."), RequestLatency);
+	AppendHistogram(Out, TEXT("prometheus_viewer_parse_duration_seconds"),
+		TEXT("Time spent parsing query responses on worker threads."), ParseTime);
+	AppendHistogram(Out, TEXT("prometheus_viewer_dispatch_duration_seconds"),
+		TEXT("Game thread time spent delivering results to widgets."), DispatchTime);
+	AppendHistogram(Out, TEXT("prometheus_viewer_chart_paint_duration_seconds"),
+		TEXT("Time spent painting one line chart."), ChartPaintTime);
+	AppendHistogram(Out, TEXT("prometheus_viewer_query_end_to_end_seconds"),
+		TEXT("Time from scheduling a range query to the first paint that shows its data."), EndToEndLatency);
+	return Out;
+}
+
+bool FPrometheusViewerStats::StartMetricsEndpoint(uint32 Port)
+{
+	StopMetricsEndpoint();
+
+	MetricsRouter = FHttpServerModule::Get().GetHttpRouter(Port, true);
+	if (!MetricsRouter.IsValid())
+	{
+		UE_LOG(LogTemp, Error, TEXT("[PrometheusViewerStats] Could not bind /metrics on port %u"), Port);
+		return false;
+	}
+
+	MetricsRoute = MetricsRouter->BindRoute(FHttpPath(TEXT("/metrics")), EHttpServerRequestVerbs::VERB_GET,
+		FHttpRequestHandler::CreateLambda([this](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			FTCHARToUTF8 Converter(*ExportText());
+
+			TUniquePtr<FHttpServerResponse> Response = MakeUnique<FHttpServerResponse>();
+			Response->Code = EHttpServerResponseCodes::Ok;
+			Response->Headers.Add(TEXT("Content-Type"), { TEXT("text/plain; version=0.0.4") });
+			Response->Body.Append(reinterpret_cast<const uint8*>(Converter.Get()), Converter.Length());
+			OnComplete(MoveTemp(Response));
+			return true;
+		}));
+
+	FHttpServerModule::Get().StartAllListeners();
+	MetricsPort = Port;
+
+	UE_LOG(LogTemp, Display, TEXT("[PrometheusViewerStats] Serving /metrics on port %u"), Port);
+	return true;
+}
+
+void FPrometheusViewerStats::StopMetricsEndpoint()
+{
+	if (MetricsRouter.IsValid())
+	{
+		MetricsRouter->UnbindRoute(MetricsRoute);
+		MetricsRouter.Reset();
+		MetricsRoute.Reset();
+	}
+}
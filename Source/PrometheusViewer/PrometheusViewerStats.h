@@ -0,0 +1,120 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "HttpRouteHandle.h"
+#include <atomic>
+
+class IHttpRouter;
+
+// stat PrometheusViewer
+DECLARE_STATS_GROUP(TEXT("PrometheusViewer"), STATGROUP_PrometheusViewer, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Parse Range Query"), STAT_PrometheusViewer_ParseRange, STATGROUP_PrometheusViewer, PROMETHEUSVIEWER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Parse Instant Query"), STAT_PrometheusViewer_ParseInstant, STATGROUP_PrometheusViewer, PROMETHEUSVIEWER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Dispatch Results"), STAT_PrometheusViewer_Dispatch, STATGROUP_PrometheusViewer, PROMETHEUSVIEWER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Schedule Queries"), STAT_PrometheusViewer_Schedule, STATGROUP_PrometheusViewer, PROMETHEUSVIEWER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Chart Paint"), STAT_PrometheusViewer_ChartPaint, STATGROUP_PrometheusViewer, PROMETHEUSVIEWER_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Requests Completed"), STAT_PrometheusViewer_RequestsCompleted, STATGROUP_PrometheusViewer, PROMETHEUSVIEWER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Bytes Received"), STAT_PrometheusViewer_BytesReceived, STATGROUP_PrometheusViewer, PROMETHEUSVIEWER_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Last Request Latency (ms)"), STAT_PrometheusViewer_RequestLatency, STATGROUP_PrometheusViewer, PROMETHEUSVIEWER_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Last End-to-End Latency (ms)"), STAT_PrometheusViewer_EndToEndLatency, STATGROUP_PrometheusViewer, PROMETHEUSVIEWER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("In-Flight Requests"), STAT_PrometheusViewer_InFlightRequests, STATGROUP_PrometheusViewer, PROMETHEUSVIEWER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Queued Requests"), STAT_PrometheusViewer_QueuedRequests, STATGROUP_PrometheusViewer, PROMETHEUSVIEWER_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Chart Points Held"), STAT_PrometheusViewer_ChartPoints, STATGROUP_PrometheusViewer, PROMETHEUSVIEWER_API);
+
+/**
+ * 固定 bucket 的延遲分佈 (秒)，可以從任何 thread 記錄。
+ * Bucket 與 Prometheus client 的預設值相近，另外補上 1ms 以下給 paint 用。
+ */
+class PROMETHEUSVIEWER_API FPrometheusViewerHistogram
+{
+public:
+	static constexpr int32 NumBounds = 14;
+	static const double Bounds[NumBounds];
+
+	void Observe(double Seconds);
+
+	uint64 GetCount() const { return Count.load(std::memory_order_relaxed); }
+	double GetSumSeconds() const { return SumMicroseconds.load(std::memory_order_relaxed) * 1e-6; }
+
+	// 第 i 個 bucket (不累計)，i == NumBounds 是 +Inf
+	uint64 GetBucketCount(int32 Index) const { return BucketCounts[Index].load(std::memory_order_relaxed); }
+
+private:
+	std::atomic<uint64> BucketCounts[NumBounds + 1] = {};
+	std::atomic<uint64> Count{0};
+	std::atomic<uint64> SumMicroseconds{0};
+};
+
+// 離開 scope 時把經過的時間記到 histogram
+class FPrometheusViewerScopeTimer
+{
+public:
+	explicit FPrometheusViewerScopeTimer(FPrometheusViewerHistogram& InHistogram)
+		: Histogram(InHistogram)
+		, StartTime(FPlatformTime::Seconds())
+	{
+	}
+
+	~FPrometheusViewerScopeTimer()
+	{
+		Histogram.Observe(FPlatformTime::Seconds() - StartTime);
+	}
+
+private:
+	FPrometheusViewerHistogram& Histogram;
+	double StartTime;
+};
+
+/**
+ * Viewer 自己的健康指標。STAT_* 只在有 stats 的 build 存在，這裡的值一直都有，
+ * 給 overlay 顯示，也以 Prometheus text format 從本機 /metrics 提供給 Prometheus 抓取。
+ */
+class PROMETHEUSVIEWER_API FPrometheusViewerStats
+{
+public:
+	static FPrometheusViewerStats& Get();
+
+	void RecordRequestCompleted(double LatencySeconds);
+	void RecordBytesReceived(int64 CompressedBytes, int64 UncompressedBytes);
+	void SetRequestGauges(int32 InFlight, int32 Queued);
+	void AddChartPoints(int64 Delta);
+
+	// range query 從排程到第一次畫出資料 (FPrometheusQueryTrace)
+	void RecordEndToEndLatency(double Seconds);
+
+	FPrometheusViewerHistogram RequestLatency;
+	FPrometheusViewerHistogram ParseTime;
+	FPrometheusViewerHistogram DispatchTime;
+	FPrometheusViewerHistogram ChartPaintTime;
+	FPrometheusViewerHistogram EndToEndLatency;
+
+	int64 GetRequestsCompleted() const { return RequestsCompleted.load(std::memory_order_relaxed); }
+	int64 GetReceivedBytes() const { return ReceivedBytes.load(std::memory_order_relaxed); }
+	int64 GetReceivedUncompressedBytes() const { return ReceivedUncompressedBytes.load(std::memory_order_relaxed); }
+	int32 GetInFlightRequests() const { return InFlightRequests.load(std::memory_order_relaxed); }
+	int32 GetQueuedRequests() const { return QueuedRequests.load(std::memory_order_relaxed); }
+	int64 GetChartPoints() const { return ChartPoints.load(std::memory_order_relaxed); }
+
+	// Prometheus text exposition format (0.0.4)
+	FString ExportText() const;
+
+	// 在本機 Port 提供 GET /metrics，只在 game thread 呼叫
+	bool StartMetricsEndpoint(uint32 Port);
+	void StopMetricsEndpoint();
+	uint32 GetMetricsPort() const { return MetricsRouter.IsValid() ? MetricsPort : 0; }
+
+private:
+	std::atomic<int64> RequestsCompleted{0};
+	std::atomic<int64> ReceivedBytes{0};
+	std::atomic<int64> ReceivedUncompressedBytes{0};
+	std::atomic<int32> InFlightRequests{0};
+	std::atomic<int32> QueuedRequests{0};
+	std::atomic<int64> ChartPoints{0};
+
+	TSharedPtr<IHttpRouter> MetricsRouter;
+	FHttpRouteHandle MetricsRoute;
+	uint32 MetricsPort = 0;
+};